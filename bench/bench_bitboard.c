@@ -0,0 +1,76 @@
+/** @file bench_bitboard.c
+ *
+ * @brief Lookahead benchmark: cost of one bitboard_reach flood fill at each
+ * depth on a partly filled screen, and the pipe steps per second that
+ * leaves (3 lookaheads per step).
+ *
+ */
+
+#include <time.h>
+
+#include "lib_bitboard.h"
+
+#define BENCH_COLS  200
+#define BENCH_ROWS  60
+#define BENCH_CALLS 100000
+#define BENCH_FILL  30 // percent of cells taken
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+run (bitboard_t *board, int32_t steps)
+{
+    int64_t reached = 0;
+
+    srand(1); // the same cells at every depth
+    uint64_t t_start = now_ns();
+    for (int32_t i = 0; i < BENCH_CALLS; ++i)
+    {
+        reached += bitboard_reach(board, rand() % BENCH_COLS,
+                                  rand() % BENCH_ROWS, steps);
+    }
+    double ns = (double)(now_ns() - t_start) / BENCH_CALLS;
+
+    printf("depth %2d  %7.2f us/reach  %6.0f cells/reach  %8.0f steps/s\n",
+           steps, ns / 1000.0, (double)reached / BENCH_CALLS,
+           1e9 / (3.0 * ns));
+}
+
+int
+main (void)
+{
+    bitboard_t *board = bitboard_create(BENCH_COLS, BENCH_ROWS);
+    if (NULL == board)
+    {
+        return 1;
+    }
+
+    srand(7);
+    for (int32_t y = 0; y < BENCH_ROWS; ++y)
+    {
+        for (int32_t x = 0; x < BENCH_COLS; ++x)
+        {
+            if ((rand() % 100) < BENCH_FILL)
+            {
+                bitboard_set(board, x, y);
+            }
+        }
+    }
+
+    printf("%dx%d, %d%% taken\n", BENCH_COLS, BENCH_ROWS, BENCH_FILL);
+    for (int32_t steps = 4; steps <= BITBOARD_MAX_STEPS; steps *= 2)
+    {
+        run(board, steps);
+    }
+
+    bitboard_destroy(&board);
+    return 0;
+}
+
+/*** end of file ***/
@@ -0,0 +1,90 @@
+/** @file bench_fade.c
+ *
+ * @brief Fade benchmark: cost per frame of aging and encoding a full screen
+ * of fading cells with each render backend, vs an idle screen.
+ *
+ */
+
+#include <time.h>
+
+#include "lib_fade.h"
+
+#define BENCH_COLS   400
+#define BENCH_ROWS   120
+#define BENCH_FRAMES 600
+#define BENCH_FADE   60 // frames to fade out
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+run (const char *name, render_kind_t kind, int32_t redraw, int32_t b_emit)
+{
+    grid_t   *grid   = grid_create(BENCH_COLS, BENCH_ROWS);
+    fade_t   *fade   = fade_create(BENCH_COLS, BENCH_ROWS, BENCH_FADE);
+    frame_t  *frame  = frame_create(0);
+    render_t *render = render_create(kind, NULL);
+    int32_t  cells = BENCH_COLS * BENCH_ROWS;
+    int64_t  moved = 0;
+    size_t   bytes = 0;
+    uint64_t spent = 0;
+
+    // REDRAW cells per frame, round robin: a steady screen of all ages
+    for (int32_t f = 0, next = 0; f < BENCH_FRAMES; ++f)
+    {
+        for (int32_t i = 0; i < redraw; ++i, next = (next + 1) % cells)
+        {
+            cell_t cell = { .glyph = 0x2501, .r = 255, .g = (uint8_t)next,
+                            .b = 64, .attr = CELL_BOLD | CELL_RGB };
+            grid_set(grid, next % BENCH_COLS, next / BENCH_COLS, &cell);
+            fade_touch(fade, grid, next % BENCH_COLS, next / BENCH_COLS);
+        }
+
+        size_t len = 0;
+        frame_reset(frame);
+        uint64_t t_start = now_ns();
+        render_begin_frame(render, frame);
+        moved += fade_step(fade, grid, b_emit ? render : NULL);
+        render_end_frame(render);
+        spent += now_ns() - t_start;
+        (void)frame_data(frame, &len);
+        bytes += len;
+    }
+
+    printf("%-9s %dx%d  %7.1f us/frame  %6.0f cells/frame  %7.0f bytes/frame\n",
+           name, BENCH_COLS, BENCH_ROWS,
+           (double)spent / 1000.0 / BENCH_FRAMES, (double)moved / BENCH_FRAMES,
+           (double)bytes / BENCH_FRAMES);
+
+    render_destroy(&render);
+    frame_unref(frame);
+    fade_destroy(&fade);
+    grid_destroy(&grid);
+}
+
+int
+main (void)
+{
+#if defined(__SSE2__)
+    printf("kernel: sse2\n");
+#else
+    printf("kernel: scalar\n");
+#endif
+    int32_t redraw = (BENCH_COLS * BENCH_ROWS) / BENCH_FADE;
+
+    run("truecolor", RENDER_TRUECOLOR, redraw, 1);
+    run("256", RENDER_256, redraw, 1);
+    run("16", RENDER_16, redraw, 1);
+    run("mono", RENDER_MONO, redraw, 1);
+    run("null", RENDER_NULL, redraw, 1);
+    run("grid", RENDER_NULL, redraw, 0); // no render at all
+    run("idle", RENDER_TRUECOLOR, 0, 1);
+    return 0;
+}
+
+/*** end of file ***/
@@ -0,0 +1,644 @@
+/** @file bench_gfx.c
+ *
+ * @brief Graphics backend benchmark and offline check: drive the kitty and
+ * sixel backends with a screen of pipe pieces, one segment a frame plus the
+ * odd burst, and report the one-off sprite upload, bytes per frame against
+ * the budget, and encode time. Every frame is fed to a decoder that stands
+ * in for the terminal; its picture must match the sprites drawn straight
+ * from the grid, and is written out as a PPM to look at.
+ *
+ * Usage: bench_gfx [COLSxROWS [FRAMES [BUDGET]]]
+ *
+ */
+
+#include <stdbool.h>
+#include <time.h>
+
+#include "lib_render.h"
+
+#define BENCH_COLS   200
+#define BENCH_ROWS   60
+#define BENCH_FRAMES 2000
+#define BENCH_BUDGET 16384
+#define BENCH_BURST  250 // every this many frames, a burst of changes
+#define BENCH_CW     RENDER_CELL_W
+#define BENCH_CH     RENDER_CELL_H
+#define BENCH_IMAGES 1024 // kitty image ids the decoder keeps
+
+static const uint32_t g_glyphs[] = { 0x2501, 0x2503, 0x250f, 0x2513,
+                                     0x2517, 0x251b, 0x254b };
+
+/*
+ * Just enough of a kitty / Sixel terminal for what the backends send: CUP,
+ * CUF and ED moves and clears; kitty transmit, place and delete; Sixel
+ * images painted at the cursor.
+ */
+typedef struct gfx_t
+{
+    int32_t   cols;
+    int32_t   rows;
+    int32_t   x;
+    int32_t   y;
+    uint8_t  *fb; // RGB, COLS * CW by ROWS * CH
+    uint8_t  *images[BENCH_IMAGES]; // kitty RGBA by id - RENDER_KITTY_ID
+    int32_t  *placed; // kitty: image shown per placement id (cell), -1 none
+    uint8_t  *upload; // kitty: base64-decoded chunks so far
+    size_t    up_len;
+    int32_t   up_id;
+    uint32_t  regs[256]; // sixel color registers
+    uint64_t  errors; // sequences the decoder did not follow
+} gfx_t;
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static size_t
+gfx_fb_size (const gfx_t *gfx)
+{
+    return (size_t)gfx->cols * BENCH_CW * (size_t)gfx->rows * BENCH_CH * 3;
+}
+
+static int32_t
+gfx_b64 (char c)
+{
+    if (('A' <= c) && ('Z' >= c)) return c - 'A';
+    if (('a' <= c) && ('z' >= c)) return c - 'a' + 26;
+    if (('0' <= c) && ('9' >= c)) return c - '0' + 52;
+    if ('+' == c) return 62;
+    if ('/' == c) return 63;
+    return -1;
+}
+
+/*
+ * "key=value,..." of a kitty command: VALUE of KEY, or DEFAULT.
+ */
+static long
+gfx_key (const char *keys, size_t len, char key, long fallback)
+{
+    for (size_t i = 0; i + 1 < len; ++i)
+    {
+        if ((keys[i] == key) && ('=' == keys[i + 1])
+            && ((0 == i) || (',' == keys[i - 1])))
+        {
+            return ('0' <= keys[i + 2] && '9' >= keys[i + 2])
+                       ? strtol(keys + i + 2, NULL, 10)
+                       : keys[i + 2];
+        }
+    }
+    return fallback;
+}
+
+static void
+gfx_kitty (gfx_t *gfx, const char *cmd, size_t len)
+{
+    const char *semi  = memchr(cmd, ';', len);
+    size_t      k_len = semi ? (size_t)(semi - cmd) : len;
+    long        act   = gfx_key(cmd, k_len, 'a', 't');
+    long        more  = gfx_key(cmd, k_len, 'm', 0);
+    long        id    = gfx_key(cmd, k_len, 'i', -1) - RENDER_KITTY_ID;
+
+    if (('t' == act) && (0 <= gfx->up_id || (0 <= id && BENCH_IMAGES > id)))
+    {
+        // the first chunk names the image; the rest only carry m=
+        if (0 > gfx->up_id)
+        {
+            gfx->up_id  = (int32_t)id;
+            gfx->up_len = 0;
+        }
+        uint32_t bits = 0;
+        int32_t  n    = 0;
+        for (const char *c = semi ? semi + 1 : cmd + len; c < cmd + len; ++c)
+        {
+            int32_t v = gfx_b64(*c);
+            if (0 > v)
+            {
+                continue;
+            }
+            bits = (bits << 6) | (uint32_t)v;
+            if (4 == ++n)
+            {
+                gfx->upload[gfx->up_len++] = (uint8_t)(bits >> 16);
+                gfx->upload[gfx->up_len++] = (uint8_t)(bits >> 8);
+                gfx->upload[gfx->up_len++] = (uint8_t)bits;
+                n = 0;
+                bits = 0;
+            }
+        }
+        // a padded tail: "xx==" is one byte, "xxx=" two
+        for (int32_t k = 1; k < n; ++k)
+        {
+            gfx->upload[gfx->up_len++] = (uint8_t)(bits >> (6 * n - 8 * k));
+        }
+        if (!more)
+        {
+            size_t want = (size_t)BENCH_CW * BENCH_CH * 4;
+            gfx->errors += (gfx->up_len != want);
+            free(gfx->images[gfx->up_id]);
+            gfx->images[gfx->up_id] = malloc(want);
+            memcpy(gfx->images[gfx->up_id], gfx->upload, want);
+            gfx->up_id = -1;
+        }
+    }
+    else if ('p' == act)
+    {
+        long p = gfx_key(cmd, k_len, 'p', 0) - 1;
+        gfx->errors += (p != ((long)gfx->y * gfx->cols) + gfx->x)
+                       || (0 > id) || (BENCH_IMAGES <= id)
+                       || (NULL == gfx->images[id]);
+        if ((0 <= p) && (p < (long)gfx->cols * gfx->rows) && (0 <= id)
+            && (BENCH_IMAGES > id) && (NULL != gfx->images[id]))
+        {
+            gfx->placed[p] = (int32_t)id;
+        }
+    }
+    else if ('d' == act)
+    {
+        long what = gfx_key(cmd, k_len, 'd', 'a');
+        long p    = gfx_key(cmd, k_len, 'p', 0) - 1;
+        if (('a' == what) || ('A' == what))
+        {
+            for (int32_t i = 0; i < gfx->cols * gfx->rows; ++i)
+            {
+                gfx->placed[i] = -1;
+            }
+            // d=A frees the images too; placing one after it is an error
+            for (int32_t i = 0; ('A' == what) && (i < BENCH_IMAGES); ++i)
+            {
+                free(gfx->images[i]);
+                gfx->images[i] = NULL;
+            }
+        }
+        else if (('i' == what) && (0 <= p) && (p < (long)gfx->cols * gfx->rows)
+                 && (gfx->placed[p] == id))
+        {
+            gfx->placed[p] = -1;
+        }
+        else
+        {
+            gfx->errors++;
+        }
+    }
+}
+
+static void
+gfx_sixel (gfx_t *gfx, const char *dcs, size_t len)
+{
+    const char *q = memchr(dcs, 'q', len);
+    if (NULL == q)
+    {
+        gfx->errors++;
+        return;
+    }
+
+    size_t   pitch = (size_t)gfx->cols * BENCH_CW * 3;
+    int32_t  x0    = gfx->x * BENCH_CW;
+    int32_t  y0    = gfx->y * BENCH_CH;
+    int32_t  px    = 0;
+    int32_t  band  = 0;
+    uint32_t color = 0;
+
+    for (const char *c = q + 1; c < dcs + len;)
+    {
+        if ('"' == *c) // raster attributes
+        {
+            for (c++; (c < dcs + len) && (('0' <= *c && '9' >= *c) || (';' == *c));)
+            {
+                c++;
+            }
+            continue;
+        }
+        if ('#' == *c)
+        {
+            char *end = NULL;
+            long  reg = strtol(c + 1, &end, 10);
+            c         = end;
+            if (0 == strncmp(c, ";2;", 3))
+            {
+                long r = strtol(c + 3, &end, 10);
+                long g = strtol(end + 1, &end, 10);
+                long b = strtol(end + 1, &end, 10);
+                c      = end;
+                gfx->regs[reg & 0xFF] = ((uint32_t)((r * 255 + 50) / 100) << 16)
+                                        | ((uint32_t)((g * 255 + 50) / 100) << 8)
+                                        | (uint32_t)((b * 255 + 50) / 100);
+            }
+            color = gfx->regs[reg & 0xFF];
+            continue;
+        }
+
+        long run = 1;
+        if ('!' == *c)
+        {
+            char *end = NULL;
+            run       = strtol(c + 1, &end, 10);
+            c         = end;
+        }
+        if ('$' == *c)
+        {
+            px = 0;
+        }
+        else if ('-' == *c)
+        {
+            px = 0;
+            band++;
+        }
+        else if ((63 <= *c) && (126 >= *c))
+        {
+            int32_t bits = *c - 63;
+            for (long i = 0; i < run; ++i, ++px)
+            {
+                for (int32_t bit = 0; bit < 6; ++bit)
+                {
+                    int32_t fx = x0 + px;
+                    int32_t fy = y0 + (band * 6) + bit;
+                    if (!(bits & (1 << bit)) || (fx >= gfx->cols * BENCH_CW)
+                        || (fy >= gfx->rows * BENCH_CH))
+                    {
+                        continue;
+                    }
+                    uint8_t *dst = gfx->fb + ((size_t)fy * pitch) + ((size_t)fx * 3);
+                    dst[0]       = (uint8_t)(color >> 16);
+                    dst[1]       = (uint8_t)(color >> 8);
+                    dst[2]       = (uint8_t)color;
+                }
+            }
+        }
+        c++;
+    }
+}
+
+/*
+ * Feed LEN bytes of one frame. Escapes never straddle frames.
+ */
+static void
+gfx_feed (gfx_t *gfx, const uint8_t *data, size_t len)
+{
+    const char *text = (const char *)data;
+
+    for (size_t i = 0; i < len;)
+    {
+        if ((0x1b != text[i]) || (i + 1 >= len))
+        {
+            gfx->errors++; // the backends print no text
+            i++;
+            continue;
+        }
+
+        char kind = text[i + 1];
+        if (('_' == kind) || ('P' == kind) || (']' == kind))
+        {
+            // APC / DCS / OSC, up to ST
+            size_t end = i + 2;
+            while ((end + 1 < len)
+                   && !((0x1b == text[end]) && ('\\' == text[end + 1])))
+            {
+                end++;
+            }
+            if ('_' == kind)
+            {
+                gfx_kitty(gfx, text + i + 3, end - (i + 3));
+            }
+            else if ('P' == kind)
+            {
+                gfx_sixel(gfx, text + i + 2, end - (i + 2));
+            }
+            i = end + 2;
+            continue;
+        }
+
+        // CSI
+        long   param[2] = { 0, 0 };
+        int32_t n       = 0;
+        size_t  j       = i + 2;
+        for (; (j < len) && ((text[j] < 0x40) || (text[j] > 0x7e)); ++j)
+        {
+            if (('0' <= text[j]) && ('9' >= text[j]) && (n < 2))
+            {
+                param[n] = (param[n] * 10) + (text[j] - '0');
+            }
+            else if (';' == text[j])
+            {
+                n++;
+            }
+        }
+        if ('H' == text[j])
+        {
+            gfx->y = (param[0] ? (int32_t)param[0] : 1) - 1;
+            gfx->x = (param[1] ? (int32_t)param[1] : 1) - 1;
+        }
+        else if ('C' == text[j])
+        {
+            gfx->x += param[0] ? (int32_t)param[0] : 1;
+        }
+        else if (('J' == text[j]) && (2 == param[0]))
+        {
+            memset(gfx->fb, 0, gfx_fb_size(gfx));
+        }
+        i = j + 1;
+    }
+}
+
+/*
+ * Kitty's picture: every placement's image over the background.
+ */
+static void
+gfx_compose (gfx_t *gfx)
+{
+    size_t pitch = (size_t)gfx->cols * BENCH_CW * 3;
+
+    memset(gfx->fb, 0, gfx_fb_size(gfx));
+    for (int32_t i = 0; i < gfx->cols * gfx->rows; ++i)
+    {
+        if (0 > gfx->placed[i])
+        {
+            continue;
+        }
+        const uint8_t *rgba = gfx->images[gfx->placed[i]];
+        uint8_t       *dst  = gfx->fb
+                       + ((size_t)(i / gfx->cols) * BENCH_CH * pitch)
+                       + ((size_t)(i % gfx->cols) * BENCH_CW * 3);
+        for (int32_t y = 0; y < BENCH_CH; ++y, dst += pitch)
+        {
+            for (int32_t x = 0; x < BENCH_CW; ++x, rgba += 4)
+            {
+                dst[(x * 3) + 0] = (uint8_t)((rgba[0] * rgba[3]) / 255);
+                dst[(x * 3) + 1] = (uint8_t)((rgba[1] * rgba[3]) / 255);
+                dst[(x * 3) + 2] = (uint8_t)((rgba[2] * rgba[3]) / 255);
+            }
+        }
+    }
+}
+
+/*
+ * Largest channel difference between the decoded picture and the grid's
+ * sprites drawn directly. Sixel leaves the bottom row's last partial band
+ * unpainted, so those pixel rows are skipped.
+ */
+static int32_t
+gfx_compare (gfx_t *gfx, grid_t *grid, const sprite_t *sprite, bool b_sixel)
+{
+    size_t  pitch = (size_t)gfx->cols * BENCH_CW * 3;
+    int32_t worst = 0;
+    int32_t whole = (BENCH_CH / 6) * 6;
+
+    for (int32_t cy = 0; cy < gfx->rows; ++cy)
+    {
+        for (int32_t cx = 0; cx < gfx->cols; ++cx)
+        {
+            const uint8_t *rgba = sprite_pixels(
+                sprite, sprite_pick(sprite, grid_get(grid, cx, cy)));
+            int32_t h = (b_sixel && (cy == gfx->rows - 1)) ? whole : BENCH_CH;
+            for (int32_t y = 0; y < h; ++y)
+            {
+                const uint8_t *src = rgba + ((size_t)y * BENCH_CW * 4);
+                const uint8_t *dst = gfx->fb + (((size_t)cy * BENCH_CH + y) * pitch)
+                                     + ((size_t)cx * BENCH_CW * 3);
+                for (int32_t x = 0; x < BENCH_CW; ++x)
+                {
+                    for (int32_t k = 0; k < 3; ++k)
+                    {
+                        int32_t diff = abs((int32_t)src[(x * 4) + k]
+                                           - (int32_t)dst[(x * 3) + k]);
+                        worst        = (diff > worst) ? diff : worst;
+                    }
+                }
+            }
+        }
+    }
+
+    return worst;
+}
+
+static void
+gfx_write_ppm (gfx_t *gfx, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (NULL == file)
+    {
+        perror(path);
+        errno = 0;
+        return;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", gfx->cols * BENCH_CW,
+            gfx->rows * BENCH_CH);
+    fwrite(gfx->fb, 1, gfx_fb_size(gfx), file);
+    fclose(file);
+}
+
+/*
+ * A pipe piece in a rainbow color (about one cell in three), or empty.
+ */
+/*
+ * Whether nothing at all is left on screen.
+ */
+static bool
+gfx_blank (const gfx_t *gfx)
+{
+    size_t size = gfx_fb_size(gfx);
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (0 != gfx->fb[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static cell_t
+random_cell (void)
+{
+    cell_t   cell  = { 0 };
+    uint32_t hue   = (uint32_t)rand() % 768;
+    if (0 != rand() % 3)
+    {
+        return cell;
+    }
+
+    cell.glyph = g_glyphs[rand() % 7];
+    cell.attr  = CELL_BOLD | CELL_RGB;
+    cell.r     = (uint8_t)((hue < 256) ? 255 - hue : (hue >= 512) ? hue - 512 : 0);
+    cell.g     = (uint8_t)((hue < 256) ? hue : (hue < 512) ? 511 - hue : 0);
+    cell.b     = (uint8_t)((hue < 256) ? 0 : (hue < 512) ? hue - 256 : 767 - hue);
+    return cell;
+}
+
+/*
+ * Exit as pipes does, with a burst still held back by the budget: leave,
+ * then the frame is flushed (drawn to and ended) once more. The terminal
+ * must be left blank.
+ */
+static bool
+gfx_leave (gfx_t *gfx, render_t *render, grid_t *grid, frame_t *frame,
+           render_kind_t kind)
+{
+    size_t len = 0;
+
+    frame_reset(frame);
+    render_begin_frame(render, frame);
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        int32_t x    = rand() % gfx->cols;
+        int32_t y    = rand() % gfx->rows;
+        cell_t  cell = random_cell();
+        grid_set(grid, x, y, &cell);
+        render_put_cell(render, x, y, &cell);
+    }
+    render_end_frame(render);
+    render_leave(render, frame);
+    render_put_cell(render, 0, 0, grid_get(grid, 0, 0));
+    render_end_frame(render);
+
+    const uint8_t *data = frame_data(frame, &len);
+    gfx_feed(gfx, data, len);
+    if (RENDER_KITTY == kind)
+    {
+        gfx_compose(gfx);
+    }
+
+    return gfx_blank(gfx);
+}
+
+static bool
+run (render_kind_t kind, int32_t cols, int32_t rows, int32_t frames,
+     size_t budget)
+{
+    const char *name     = (RENDER_KITTY == kind) ? "kitty" : "sixel";
+    render_t   *render   = render_create(kind, NULL);
+    sprite_t   *sprite   = sprite_create(BENCH_CW, BENCH_CH);
+    grid_t     *grid     = grid_create(cols, rows);
+    frame_t    *frame    = frame_create(0);
+    gfx_t       gfx      = { .cols = cols, .rows = rows, .up_id = -1 };
+    gfx.fb               = calloc(1, gfx_fb_size(&gfx));
+    gfx.placed           = malloc((size_t)cols * rows * sizeof(*gfx.placed));
+    gfx.upload           = malloc((size_t)BENCH_CW * BENCH_CH * 4 + 8);
+    bool        b_ok     = false;
+
+    if ((NULL == render) || (NULL == sprite) || (NULL == grid)
+        || (NULL == frame) || (NULL == gfx.fb) || (NULL == gfx.placed)
+        || (NULL == gfx.upload)
+        || (RETVAL_SUCCESS
+            != render_graphics(render, BENCH_CW, BENCH_CH, budget)))
+    {
+        fprintf(stderr, "bench_gfx: set-up failed\n");
+        goto RUN_FREE;
+    }
+    for (int32_t i = 0; i < cols * rows; ++i)
+    {
+        gfx.placed[i] = -1;
+    }
+
+    srand(7);
+    for (int32_t y = 0; y < rows; ++y)
+    {
+        for (int32_t x = 0; x < cols; ++x)
+        {
+            cell_t cell = random_cell();
+            grid_set(grid, x, y, &cell);
+        }
+    }
+
+    // the first frame: sprites (kitty) and whatever of the screen fits
+    render_keyframe(render, grid, frame);
+    size_t         len  = 0;
+    const uint8_t *data = frame_data(frame, &len);
+    size_t         first = len;
+    gfx_feed(&gfx, data, len);
+
+    uint64_t bytes    = 0;
+    uint64_t worst    = 0;
+    uint64_t encode   = 0;
+    int32_t  over     = 0;
+    int32_t  drained  = 0;
+    for (int32_t f = 0; (f < frames) || (0 != len); ++f)
+    {
+        frame_reset(frame);
+        uint64_t t_start = now_ns();
+        render_begin_frame(render, frame);
+        int32_t changes = (f >= frames) ? 0 : (0 == f % BENCH_BURST) ? 2000 : 1;
+        for (int32_t i = 0; i < changes; ++i)
+        {
+            int32_t x    = rand() % cols;
+            int32_t y    = rand() % rows;
+            cell_t  cell = random_cell();
+            grid_set(grid, x, y, &cell);
+            render_put_cell(render, x, y, &cell);
+        }
+        render_end_frame(render);
+        encode += now_ns() - t_start;
+
+        data = frame_data(frame, &len);
+        gfx_feed(&gfx, data, len);
+        bytes += len;
+        worst = (len > worst) ? len : worst;
+        over += (0 < budget) && (len > budget);
+        drained = f + 1; // past FRAMES: what the budget held back
+
+    }
+
+    if (RENDER_KITTY == kind)
+    {
+        gfx_compose(&gfx);
+    }
+    int32_t diff = gfx_compare(&gfx, grid, sprite, RENDER_SIXEL == kind);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/bench_gfx_%s.ppm", name);
+    gfx_write_ppm(&gfx, path);
+    bool b_blank = gfx_leave(&gfx, render, grid, frame, kind);
+
+    // Sixel colors are percentages: off by one or two in 255 at most
+    b_ok = (0 == over) && (0 == gfx.errors) && (diff <= ((RENDER_SIXEL == kind) ? 2 : 0))
+           && b_blank;
+    printf("%-5s %4dx%-4d first %8zu B  %7.1f B/frame  max %6llu B "
+           "(budget %zu, %d over)  %6.2f us/frame  drained +%d  diff %d  "
+           "exit %s  %s  %s\n",
+           name, cols, rows, first, (double)bytes / drained,
+           (unsigned long long)worst, budget, over,
+           (double)encode / 1000.0 / drained, drained - frames, diff,
+           b_blank ? "blank" : "NOT BLANK", path, b_ok ? "ok" : "FAILED");
+
+RUN_FREE:
+    for (int32_t i = 0; i < BENCH_IMAGES; ++i)
+    {
+        free(gfx.images[i]);
+    }
+    free(gfx.fb);
+    free(gfx.placed);
+    free(gfx.upload);
+    frame_unref(frame);
+    grid_destroy(&grid);
+    sprite_destroy(&sprite);
+    render_destroy(&render);
+    return b_ok;
+}
+
+int
+main (int argc, char **argv)
+{
+    int32_t cols   = BENCH_COLS;
+    int32_t rows   = BENCH_ROWS;
+    int32_t frames = BENCH_FRAMES;
+    long    budget = BENCH_BUDGET;
+
+    if ((1 < argc) && (2 != sscanf(argv[1], "%dx%d", &cols, &rows)))
+    {
+        fprintf(stderr, "usage: bench_gfx [COLSxROWS [FRAMES [BUDGET]]]\n");
+        return 1;
+    }
+    frames = (2 < argc) ? (int32_t)strtol(argv[2], NULL, 10) : frames;
+    budget = (3 < argc) ? strtol(argv[3], NULL, 10) : budget;
+
+    bool b_ok = run(RENDER_KITTY, cols, rows, frames, (size_t)budget);
+    b_ok      = run(RENDER_SIXEL, cols, rows, frames, (size_t)budget) && b_ok;
+
+    return b_ok ? 0 : 1;
+}
+
+/*** end of file ***/
@@ -0,0 +1,350 @@
+/** @file bench_llist.c
+ *
+ * @brief Contention benchmark: mutex and spinlock llist_t queues vs lock-free
+ * llmpsc_t.
+ * N producer threads hand items to one consumer thread.
+ *
+ */
+
+#include <stdbool.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "lib_llist.h"
+
+#define BENCH_ITEMS_PER_PRODUCER 200000
+#define BENCH_MAX_PRODUCERS      8
+
+typedef struct bench_item_t
+{
+    llmpsc_node_t link; // first member; node PTR == item PTR
+    uint64_t      seq;
+} bench_item_t;
+
+typedef struct bench_ctx_t
+{
+    llist_t        *llist;
+    llmpsc_t       *queue;
+    bench_item_t   *items;
+    int32_t         num_items;
+    uint64_t        enq_ns;
+    uint64_t        max_enq_ns;
+} bench_ctx_t;
+
+static _Atomic int64_t g_consumed;
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+count_node (void *node)
+{
+    (void)node;
+    atomic_fetch_add_explicit(&g_consumed, 1, memory_order_relaxed);
+}
+
+static void *
+producer_mutex (void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int32_t idx = 0; idx < ctx->num_items; idx++)
+    {
+        uint64_t t_start = now_ns();
+        ll_enq(ctx->llist, &ctx->items[idx]);
+        uint64_t t_op = now_ns() - t_start;
+        ctx->enq_ns += t_op;
+        ctx->max_enq_ns = (t_op > ctx->max_enq_ns) ? t_op : ctx->max_enq_ns;
+    }
+    return NULL;
+}
+
+static void *
+producer_mpsc (void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int32_t idx = 0; idx < ctx->num_items; idx++)
+    {
+        uint64_t t_start = now_ns();
+        ll_mpsc_enq(ctx->queue, &ctx->items[idx].link);
+        uint64_t t_op = now_ns() - t_start;
+        ctx->enq_ns += t_op;
+        ctx->max_enq_ns = (t_op > ctx->max_enq_ns) ? t_op : ctx->max_enq_ns;
+    }
+    return NULL;
+}
+
+static void
+run (const char *name, int32_t producers, ll_lock_t policy, bool b_mpsc)
+{
+    pthread_t   threads[BENCH_MAX_PRODUCERS];
+    bench_ctx_t ctx[BENCH_MAX_PRODUCERS] = { 0 };
+    int64_t     total = (int64_t)producers * BENCH_ITEMS_PER_PRODUCER;
+
+    llist_t  *llist = ll_create_lock(policy);
+    llmpsc_t *queue = ll_mpsc_create();
+    atomic_store(&g_consumed, 0);
+
+    for (int32_t idx = 0; idx < producers; idx++)
+    {
+        ctx[idx].llist     = llist;
+        ctx[idx].queue     = queue;
+        ctx[idx].num_items = BENCH_ITEMS_PER_PRODUCER;
+        ctx[idx].items = calloc(BENCH_ITEMS_PER_PRODUCER, sizeof(bench_item_t));
+    }
+
+    uint64_t t_start = now_ns();
+    for (int32_t idx = 0; idx < producers; idx++)
+    {
+        pthread_create(&threads[idx], NULL,
+                       b_mpsc ? producer_mpsc : producer_mutex, &ctx[idx]);
+    }
+
+    // this thread is the single consumer
+    while (atomic_load(&g_consumed) < total)
+    {
+        if (b_mpsc)
+        {
+            (void)ll_mpsc_take_all(queue, count_node);
+        }
+        else if (NULL != ll_deq(llist))
+        {
+            count_node(NULL);
+        }
+    }
+    uint64_t t_total = now_ns() - t_start;
+
+    uint64_t enq_ns = 0;
+    uint64_t max_ns = 0;
+    for (int32_t idx = 0; idx < producers; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+        enq_ns += ctx[idx].enq_ns;
+        max_ns = (ctx[idx].max_enq_ns > max_ns) ? ctx[idx].max_enq_ns : max_ns;
+        free(ctx[idx].items);
+    }
+
+    printf("%-6s producers=%d  %8.2f Mops/s  enq avg %6.1f ns  max %8.1f us\n",
+           name, producers, (double)total / ((double)t_total / 1e3),
+           (double)enq_ns / (double)total, (double)max_ns / 1e3);
+
+    ll_destroy(&llist, free);
+    ll_mpsc_destroy(&queue, NULL);
+}
+
+static void
+nop_free (void *data)
+{
+    (void)data;
+}
+
+/*
+ * Single-owner churn: fill a list, drain half one node at a time, dump the
+ * rest. Dominated by node allocation and release.
+ */
+static void
+run_churn (void)
+{
+    static bench_item_t item;
+    const int32_t       nodes  = 1000000;
+    const int32_t       cycles = 10;
+
+    uint64_t t_start = now_ns();
+    for (int32_t cycle = 0; cycle < cycles; cycle++)
+    {
+        llist_t *llist = ll_create_lock(LL_LOCK_NONE);
+        for (int32_t idx = 0; idx < nodes; idx++)
+        {
+            ll_enq(llist, &item);
+        }
+        for (int32_t idx = 0; idx < nodes / 2; idx++)
+        {
+            (void)ll_deq(llist);
+        }
+        (void)ll_dump(llist, nop_free);
+        ll_destroy(&llist, nop_free);
+    }
+    uint64_t t_total = now_ns() - t_start;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("churn  %d x %d nodes   %8.2f ns/node  maxrss %ld KiB\n", cycles,
+           nodes, (double)t_total / ((double)cycles * nodes), usage.ru_maxrss);
+}
+
+typedef struct bench_keyed_t
+{
+    char    key[16];
+    int32_t id;
+} bench_keyed_t;
+
+static char *
+keyed_key (void *data)
+{
+    return ((bench_keyed_t *)data)->key;
+}
+
+static int32_t
+keyed_cmp (void *data, char *key)
+{
+    return strcmp(((bench_keyed_t *)data)->key, key);
+}
+
+/*
+ * Lookup throughput vs list length: linear ll_search vs the hash index.
+ */
+static void
+run_search (int32_t length)
+{
+    const int32_t  lookups = 200000;
+    bench_keyed_t *items   = calloc((size_t)length, sizeof(*items));
+    llist_t       *scan    = ll_create_lock(LL_LOCK_NONE);
+    llist_t       *hashed  = ll_create_lock(LL_LOCK_NONE);
+    char           key[16];
+
+    for (int32_t idx = 0; idx < length; idx++)
+    {
+        (void)snprintf(items[idx].key, sizeof(items[idx].key), "k%d", idx);
+        items[idx].id = idx;
+        ll_enq(scan, &items[idx]);
+        ll_enq(hashed, &items[idx]);
+    }
+    ll_index_create(hashed, keyed_key, ll_hash_str);
+
+    double ns[2] = { 0 };
+    for (int32_t pass = 0; pass < 2; pass++)
+    {
+        llist_t *llist = pass ? hashed : scan;
+        int32_t  count = pass ? lookups : (lookups / (1 + (length / 64)));
+        int32_t  found = 0;
+
+        srand(1);
+        uint64_t t_start = now_ns();
+        for (int32_t idx = 0; idx < count; idx++)
+        {
+            (void)snprintf(key, sizeof(key), "k%d", rand() % length);
+            found += (NULL != ll_search(llist, key, keyed_cmp));
+        }
+        ns[pass] = (double)(now_ns() - t_start) / (double)count;
+        if (found != count)
+        {
+            (void)fprintf(stderr, "search miss\n");
+        }
+    }
+
+    printf("search len=%-7d scan %10.1f ns  index %6.1f ns\n", length, ns[0],
+           ns[1]);
+
+    ll_destroy(&scan, nop_free);
+    ll_destroy(&hashed, nop_free);
+    free(items);
+}
+
+static _Atomic bool g_reader_stop;
+
+static void
+slow_visit (void *data)
+{
+    volatile uint32_t spin = 0;
+    for (int32_t idx = 0; idx < 20; idx++)
+    {
+        spin += (uint32_t)(uintptr_t)data;
+    }
+}
+
+static int32_t
+slow_never_match (void *data, char *key)
+{
+    (void)key;
+    slow_visit(data);
+    return 1;
+}
+
+static void *
+reader_locked (void *arg)
+{
+    while (!atomic_load(&g_reader_stop))
+    {
+        // a miss walks the whole list under the lock, like the old ll_iter
+        (void)ll_search(arg, "", slow_never_match);
+    }
+    return NULL;
+}
+
+static void *
+reader_snapshot (void *arg)
+{
+    while (!atomic_load(&g_reader_stop))
+    {
+        (void)ll_iter(arg, slow_visit);
+    }
+    return NULL;
+}
+
+/*
+ * Writer latency (enq + deq pair) while another thread keeps walking a
+ * 100k-node list with a non-trivial callback.
+ */
+static void
+run_reader (const char *name, void *(*reader)(void *))
+{
+    static bench_item_t items[100000];
+    const int32_t       ops    = 2000;
+    llist_t            *llist  = ll_create();
+    uint64_t            total  = 0;
+    uint64_t            max_ns = 0;
+    pthread_t           thread;
+
+    for (int32_t idx = 0; idx < 100000; idx++)
+    {
+        ll_enq(llist, &items[idx]);
+    }
+
+    atomic_store(&g_reader_stop, false);
+    pthread_create(&thread, NULL, reader, llist);
+
+    for (int32_t idx = 0; idx < ops; idx++)
+    {
+        usleep(200); // a paced producer; gives the reader the CPU as well
+        uint64_t t_start = now_ns();
+        ll_enq(llist, ll_deq(llist));
+        uint64_t t_op = now_ns() - t_start;
+        total += t_op;
+        max_ns = (t_op > max_ns) ? t_op : max_ns;
+    }
+
+    atomic_store(&g_reader_stop, true);
+    pthread_join(thread, NULL);
+
+    printf("reader %-8s writer enq+deq avg %9.1f ns  max %8.1f us\n", name,
+           (double)total / ops, (double)max_ns / 1e3);
+
+    ll_destroy(&llist, nop_free);
+}
+
+int
+main (void)
+{
+    run_reader("locked", reader_locked);
+    run_reader("snapshot", reader_snapshot);
+    run_churn();
+    for (int32_t length = 16; length <= 65536; length *= 16)
+    {
+        run_search(length);
+    }
+
+    for (int32_t producers = 1; producers <= BENCH_MAX_PRODUCERS; producers *= 2)
+    {
+        run("mutex", producers, LL_LOCK_MUTEX, false);
+        run("spin", producers, LL_LOCK_SPIN, false);
+        run("mpsc", producers, LL_LOCK_NONE, true);
+    }
+    return 0;
+}
+
+/*** end of file ***/
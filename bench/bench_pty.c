@@ -0,0 +1,420 @@
+/** @file bench_pty.c
+ *
+ * @brief End-to-end benchmark: run bin/pipes on a pseudo-terminal of a fixed
+ * size, drain everything it writes and feed it to a minimal VT parser that
+ * stands in for the terminal. Reports wall-clock throughput and the work a
+ * terminal has to do per frame (bytes, escape sequences, cursor moves, SGR
+ * changes, cells printed), then checks the parser's final screen against
+ * --dump-grid for the same seed.
+ *
+ * Usage: bench_pty [COLSxROWS [STEPS [SEED]]]
+ *
+ */
+
+#define _XOPEN_SOURCE 700 // posix_openpt and friends
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+
+#include "lib_llist.h"
+
+#define BENCH_BIN   "./bin/pipes"
+#define BENCH_COLS  200
+#define BENCH_ROWS  60
+#define BENCH_STEPS 4000
+#define BENCH_PARAMS 8 // CSI parameters kept; the rest are counted, not read
+
+typedef enum vt_state_t
+{
+    VT_GROUND,
+    VT_ESC,
+    VT_CSI,
+} vt_state_t;
+
+/*
+ * Just enough of a terminal for what pipes sends: UTF-8 text, CUP/CUF
+ * moves, SGR, ED, and private modes (ignored). SNAP is the screen as it was
+ * before the last erase, since pipes clears the screen on its way out.
+ */
+typedef struct vt_t
+{
+    vt_state_t state;
+    int32_t    cols;
+    int32_t    rows;
+    int32_t    x;
+    int32_t    y;
+    bool       b_wrap; // the last column was printed; the next glyph wraps
+    uint32_t   glyph; // UTF-8 sequence being decoded
+    int32_t    need; // continuation bytes still expected
+    int32_t    params[BENCH_PARAMS];
+    int32_t    n_params;
+    bool       b_private;
+    uint32_t  *screen;
+    uint32_t  *snap;
+    uint64_t   bytes;
+    uint64_t   escapes;
+    uint64_t   moves;
+    uint64_t   sgrs;
+    uint64_t   cells;
+    uint64_t   erases;
+} vt_t;
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+vt_print (vt_t *vt, uint32_t glyph)
+{
+    if (vt->b_wrap)
+    {
+        vt->b_wrap = false;
+        vt->x      = 0;
+        vt->y      = (vt->y + 1 < vt->rows) ? vt->y + 1 : vt->y; // no scroll
+    }
+
+    vt->screen[(vt->y * vt->cols) + vt->x] = (' ' == glyph) ? 0 : glyph;
+    vt->cells++;
+
+    if (vt->x + 1 < vt->cols)
+    {
+        vt->x++;
+    }
+    else
+    {
+        vt->b_wrap = true;
+    }
+}
+
+static int32_t
+vt_param (const vt_t *vt, int32_t idx, int32_t fallback)
+{
+    return ((idx < vt->n_params) && (0 < vt->params[idx])) ? vt->params[idx]
+                                                           : fallback;
+}
+
+static void
+vt_csi (vt_t *vt, uint8_t final)
+{
+    if (vt->b_private)
+    {
+        return; // ?25l / ?25h: the cursor is not drawn here
+    }
+
+    switch (final)
+    {
+        case 'H':
+        case 'f':
+            vt->y      = vt_param(vt, 0, 1) - 1;
+            vt->x      = vt_param(vt, 1, 1) - 1;
+            vt->y      = (vt->y < vt->rows) ? vt->y : vt->rows - 1;
+            vt->x      = (vt->x < vt->cols) ? vt->x : vt->cols - 1;
+            vt->b_wrap = false;
+            vt->moves++;
+            break;
+
+        case 'C':
+            vt->x += vt_param(vt, 0, 1);
+            vt->x      = (vt->x < vt->cols) ? vt->x : vt->cols - 1;
+            vt->b_wrap = false;
+            vt->moves++;
+            break;
+
+        case 'm':
+            vt->sgrs++;
+            break;
+
+        case 'J':
+            if (2 == vt_param(vt, 0, 0))
+            {
+                size_t size = (size_t)vt->cols * (size_t)vt->rows;
+                memcpy(vt->snap, vt->screen, size * sizeof(*vt->screen));
+                memset(vt->screen, 0, size * sizeof(*vt->screen));
+                vt->erases++;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void
+vt_feed (vt_t *vt, const uint8_t *data, size_t len)
+{
+    vt->bytes += len;
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        uint8_t byte = data[i];
+
+        switch (vt->state)
+        {
+            case VT_GROUND:
+                if (0x1b == byte)
+                {
+                    vt->state = VT_ESC;
+                    vt->need  = 0;
+                }
+                else if (0 < vt->need)
+                {
+                    vt->glyph = (vt->glyph << 6) | (byte & 0x3f);
+                    if (0 == --vt->need)
+                    {
+                        vt_print(vt, vt->glyph);
+                    }
+                }
+                else if (0xc0 <= byte)
+                {
+                    vt->need  = (0xf0 <= byte) ? 3 : (0xe0 <= byte) ? 2 : 1;
+                    vt->glyph = byte & (0x3f >> vt->need);
+                }
+                else if (0x20 <= byte && byte < 0x7f)
+                {
+                    vt_print(vt, byte);
+                }
+                break;
+
+            case VT_ESC:
+                vt->escapes++;
+                vt->state = VT_GROUND;
+                if ('[' == byte)
+                {
+                    vt->state     = VT_CSI;
+                    vt->n_params  = 1;
+                    vt->params[0] = 0;
+                    vt->b_private = false;
+                }
+                break;
+
+            case VT_CSI:
+                if (('0' <= byte) && (byte <= '9'))
+                {
+                    if (vt->n_params <= BENCH_PARAMS)
+                    {
+                        int32_t *param = &vt->params[vt->n_params - 1];
+                        *param         = (*param * 10) + (byte - '0');
+                    }
+                }
+                else if (';' == byte)
+                {
+                    if (vt->n_params < BENCH_PARAMS)
+                    {
+                        vt->params[vt->n_params] = 0;
+                    }
+                    vt->n_params++;
+                }
+                else if ('?' == byte)
+                {
+                    vt->b_private = true;
+                }
+                else if ((0x40 <= byte) && (byte <= 0x7e))
+                {
+                    vt_csi(vt, byte);
+                    vt->state = VT_GROUND;
+                }
+                break;
+        }
+    }
+}
+
+/*
+ * The grid pipes itself reports after STEPS steps of SEED (--dump-grid), one
+ * glyph per cell with 0 for blanks, read with the same parser. Returns the
+ * number of rows read.
+ */
+static int32_t
+expected_grid (uint32_t *grid, int32_t cols, int32_t rows, int64_t steps,
+               const char *seed)
+{
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd),
+             "%s --seed %s -G %dx%d --warm %lld --dump-grid", BENCH_BIN,
+             seed, cols, rows, (long long)steps);
+
+    FILE *dump = popen(cmd, "r");
+    if (NULL == dump)
+    {
+        perror("popen");
+        errno = 0;
+        return 0;
+    }
+
+    vt_t    vt   = { .cols = cols, .rows = rows, .screen = grid };
+    char   *line = NULL;
+    size_t  cap  = 0;
+    ssize_t len  = 0;
+    int32_t row  = 0;
+    while ((row < rows) && (0 < (len = getline(&line, &cap, dump))))
+    {
+        vt.x      = 0;
+        vt.y      = row++;
+        vt.b_wrap = false;
+        len -= ('\n' == line[len - 1]);
+        vt_feed(&vt, (const uint8_t *)line, (size_t)len);
+    }
+    free(line);
+    pclose(dump);
+
+    return row;
+}
+
+static int32_t
+run (const char *backend, int32_t cols, int32_t rows, int64_t steps,
+     const char *seed, const uint32_t *expect)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    size_t  size    = (size_t)cols * (size_t)rows;
+    vt_t    vt      = { .cols   = cols,
+                        .rows   = rows,
+                        .screen = calloc(size, sizeof(uint32_t)),
+                        .snap   = calloc(size, sizeof(uint32_t)) };
+    char    steps_arg[32];
+    snprintf(steps_arg, sizeof(steps_arg), "%lld", (long long)steps);
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((NULL == vt.screen) || (NULL == vt.snap) || (master < 0)
+        || (0 != grantpt(master)) || (0 != unlockpt(master)))
+    {
+        perror("pty");
+        errno = 0;
+        goto RUN_RET;
+    }
+
+    // a raw terminal of a fixed size: the bytes arrive exactly as written
+    struct winsize ws    = { .ws_col = cols, .ws_row = rows };
+    const char    *name  = ptsname(master);
+    int            slave = (NULL == name) ? -1 : open(name, O_RDWR | O_NOCTTY);
+    struct termios tio   = { 0 };
+    if ((slave < 0) || (0 != ioctl(master, TIOCSWINSZ, &ws))
+        || (0 != tcgetattr(slave, &tio)))
+    {
+        perror("pty slave");
+        errno = 0;
+        if (0 <= slave)
+        {
+            close(slave);
+        }
+        goto RUN_RET;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    uint64_t t_start = now_ns();
+    pid_t    child   = fork();
+    if (0 == child)
+    {
+        setsid();
+        ioctl(slave, TIOCSCTTY, 0);
+        dup2(slave, STDIN_FILENO);
+        dup2(slave, STDOUT_FILENO);
+        dup2(slave, STDERR_FILENO);
+        close(master);
+        close(slave);
+        execl(BENCH_BIN, BENCH_BIN, "-c", "--backend", backend, "--seed", seed,
+              "--steps", steps_arg, (char *)NULL);
+        _exit(127);
+    }
+    close(slave);
+    if (child < 0)
+    {
+        perror("fork");
+        errno = 0;
+        goto RUN_RET;
+    }
+
+    // EIO once pipes has exited and the slave side is closed
+    uint8_t buf[65536];
+    ssize_t got = 0;
+    while ((0 < (got = read(master, buf, sizeof(buf))))
+           || ((got < 0) && (EINTR == errno)))
+    {
+        if (0 < got)
+        {
+            vt_feed(&vt, buf, (size_t)got);
+        }
+    }
+    errno = 0;
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    double secs = (double)(now_ns() - t_start) / 1e9;
+
+    size_t wrong = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        wrong += (vt.snap[i] != expect[i]);
+    }
+
+    double frames = (double)steps;
+    printf("%-9s %7.0f steps/s %7.1f MB/s | per frame: %6.1f bytes %5.1f esc "
+           "%5.1f moves %5.1f sgr %5.1f cells | %s",
+           backend, frames / secs, (double)vt.bytes / secs / 1e6,
+           (double)vt.bytes / frames, (double)vt.escapes / frames,
+           (double)vt.moves / frames, (double)vt.sgrs / frames,
+           (double)vt.cells / frames, (0 == wrong) ? "screen ok\n" : "");
+    if (0 != wrong)
+    {
+        printf("MISMATCH %zu cells\n", wrong);
+        goto RUN_RET;
+    }
+    ret_val = (WIFEXITED(status) && (0 == WEXITSTATUS(status)))
+                  ? RETVAL_SUCCESS
+                  : RETVAL_FAILURE;
+
+RUN_RET:
+    if (0 <= master)
+    {
+        close(master);
+    }
+    free(vt.screen);
+    free(vt.snap);
+    return ret_val;
+}
+
+int
+main (int argc, char **argv)
+{
+    int32_t     cols  = BENCH_COLS;
+    int32_t     rows  = BENCH_ROWS;
+    int64_t     steps = BENCH_STEPS;
+    const char *seed  = "1";
+
+    if ((1 < argc) && (2 != sscanf(argv[1], "%dx%d", &cols, &rows)))
+    {
+        fprintf(stderr, "Usage: %s [COLSxROWS [STEPS [SEED]]]\n", argv[0]);
+        return 1;
+    }
+    steps = (2 < argc) ? strtoll(argv[2], NULL, 10) : steps;
+    seed  = (3 < argc) ? argv[3] : seed;
+
+    uint32_t *expect = calloc((size_t)cols * (size_t)rows, sizeof(*expect));
+    if ((NULL == expect) || (cols < 3) || (rows < 3) || (steps < 1)
+        || (rows != expected_grid(expect, cols, rows, steps, seed)))
+    {
+        fprintf(stderr, "no expected grid from %s --dump-grid\n", BENCH_BIN);
+        free(expect);
+        return 1;
+    }
+
+    printf("pty %dx%d, %lld steps, seed %s\n", cols, rows, (long long)steps,
+           seed);
+    int32_t ret_val = RETVAL_SUCCESS;
+    ret_val |= run("truecolor", cols, rows, steps, seed, expect);
+    ret_val |= run("256", cols, rows, steps, seed, expect);
+    ret_val |= run("16", cols, rows, steps, seed, expect);
+    ret_val |= run("mono", cols, rows, steps, seed, expect);
+
+    free(expect);
+    return (RETVAL_SUCCESS == ret_val) ? 0 : 1;
+}
+
+/*** end of file ***/
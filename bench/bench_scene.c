@@ -0,0 +1,206 @@
+/** @file bench_scene.c
+ *
+ * @brief 3D scene benchmark and offline check: grow one cycle of lattice
+ * pipes on a COLSxROWS screen, drawing and encoding a step a frame as --3d
+ * does, then redraw the finished cycle from scratch with 1, 2, 4 and every
+ * online CPU's worth of threads. Reports the cost and bytes of a step, and
+ * full frames per second against the 30 fps target. The picture built a
+ * step at a time must match the one drawn in one go, and is written out as
+ * a PPM to look at.
+ *
+ * Usage: bench_scene [COLSxROWS [FULL_FRAMES]]
+ *
+ */
+
+#include <stdbool.h>
+#include <time.h>
+
+#include "lib_scene.h"
+
+#define BENCH_COLS   200
+#define BENCH_ROWS   60
+#define BENCH_FULL   300 // full redraws timed per thread count
+#define BENCH_YAW    0.45f
+#define BENCH_PITCH  0.35f
+#define BENCH_TARGET 30.0 // fps
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+write_ppm (const uint32_t *pixels, int32_t width, int32_t height,
+           const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (NULL == file)
+    {
+        perror(path);
+        errno = 0;
+        return;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (size_t i = 0; i < (size_t)width * (size_t)height; ++i)
+    {
+        uint8_t rgb[3] = { (uint8_t)(pixels[i] >> 16),
+                           (uint8_t)(pixels[i] >> 8), (uint8_t)pixels[i] };
+        fwrite(rgb, 1, 3, file);
+    }
+    fclose(file);
+}
+
+/*
+ * Redraw every piece FRAMES times; returns ns per frame.
+ */
+static double
+full (scene_t *scene, lattice_t *lattice, int32_t frames)
+{
+    float lo[3];
+    float hi[3];
+    lattice_bounds(lattice, lo, hi);
+
+    size_t                 count  = 0;
+    const lattice_piece_t *pieces = lattice_pieces(lattice, &count);
+    uint64_t               spent  = 0;
+
+    for (int32_t f = 0; f < frames; ++f)
+    {
+        scene_camera(scene, BENCH_YAW, BENCH_PITCH, lo, hi); // all dirty
+        uint64_t t_start = now_ns();
+        scene_draw(scene, pieces, count, 0);
+        spent += now_ns() - t_start;
+    }
+
+    return (double)spent / frames;
+}
+
+int
+main (int argc, char **argv)
+{
+    int32_t cols   = BENCH_COLS;
+    int32_t rows   = BENCH_ROWS;
+    int32_t frames = BENCH_FULL;
+    int32_t ret    = 1;
+
+    if ((1 < argc) && ((2 != sscanf(argv[1], "%dx%d", &cols, &rows))
+                       || (cols < 1) || (rows < 1)))
+    {
+        fprintf(stderr, "Usage: bench_scene [COLSxROWS [FULL_FRAMES]]\n");
+        return 1;
+    }
+    if (2 < argc)
+    {
+        frames = (int32_t)strtol(argv[2], NULL, 10);
+        frames = (frames < 1) ? 1 : frames;
+    }
+
+#if defined(__SSE2__)
+    printf("kernel: sse2, %ld cpus online\n", sysconf(_SC_NPROCESSORS_ONLN));
+#else
+    printf("kernel: scalar, %ld cpus online\n", sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+
+    lattice_t *lattice = lattice_create(2, 2, 2);
+    scene_t   *grown   = scene_create(1);
+    frame_t   *frame   = frame_create(0);
+    if ((NULL == lattice) || (NULL == grown) || (NULL == frame))
+    {
+        goto BENCH_FREE;
+    }
+
+    // one cycle, a step a frame, as --3d draws it
+    float lo[3];
+    float hi[3];
+    srand(1);
+    lattice_fit(lattice, cols, rows * 2);
+    lattice_bounds(lattice, lo, hi);
+    scene_resize(grown, cols, rows);
+    scene_camera(grown, BENCH_YAW, BENCH_PITCH, lo, hi);
+
+    int64_t  steps = 0;
+    size_t   bytes = 0;
+    int64_t  cells = 0;
+    uint64_t spent = 0;
+    uint64_t worst = 0;
+    size_t   first = 0;
+
+    while (RETVAL_SUCCESS == lattice_step(lattice, &first))
+    {
+        size_t                 count  = 0;
+        const lattice_piece_t *pieces = lattice_pieces(lattice, &count);
+        size_t                 len    = 0;
+
+        frame_reset(frame);
+        uint64_t t_start = now_ns();
+        scene_draw(grown, pieces, count, first);
+        cells += scene_encode(grown, frame);
+        uint64_t took = now_ns() - t_start;
+
+        spent += took;
+        worst  = (took > worst) ? took : worst;
+        (void)frame_data(frame, &len);
+        bytes += (steps > 0) ? len : 0; // the first is the clear screen
+        steps++;
+    }
+
+    size_t count = 0;
+    (void)lattice_pieces(lattice, &count);
+    printf("cycle     %dx%d cells  %lld steps  %zu pieces\n", cols, rows,
+           (long long)steps, count);
+    printf("step      %7.1f us avg  %7.1f us worst  %5.1f cells  %6.0f bytes"
+           "/step\n",
+           (double)spent / 1000.0 / (double)steps, (double)worst / 1000.0,
+           (double)cells / (double)steps,
+           (double)bytes / (double)(steps - 1));
+
+    int32_t         width  = 0;
+    int32_t         height = 0;
+    const uint32_t *step_px = scene_pixels(grown, &width, &height);
+    write_ppm(step_px, width, height, "/tmp/bench_scene.ppm");
+
+    int32_t counts[] = { 1, 2, 4, (int32_t)sysconf(_SC_NPROCESSORS_ONLN) };
+    bool    b_same   = true;
+    for (size_t i = 0; i < (sizeof(counts) / sizeof(counts[0])); ++i)
+    {
+        if ((3 == i) && (counts[i] <= 4))
+        {
+            break; // already run
+        }
+
+        scene_t *scene = scene_create(counts[i]);
+        if ((NULL == scene) || (RETVAL_SUCCESS != scene_resize(scene, cols, rows)))
+        {
+            scene_destroy(&scene);
+            goto BENCH_FREE;
+        }
+
+        double ns = full(scene, lattice, frames);
+        printf("full      %2d threads  %7.1f us/frame  %7.1f fps  %s\n",
+               counts[i], ns / 1000.0, 1e9 / ns,
+               (1e9 / ns >= BENCH_TARGET) ? "ok" : "BELOW 30 fps");
+
+        // drawn whole, the picture is the one built a step at a time
+        const uint32_t *full_px = scene_pixels(scene, &width, &height);
+        b_same = b_same
+                 && (0 == memcmp(full_px, step_px,
+                                 (size_t)width * (size_t)height
+                                     * sizeof(*full_px)));
+        scene_destroy(&scene);
+    }
+    printf("check     stepwise == full: %s  (/tmp/bench_scene.ppm)\n",
+           b_same ? "ok" : "MISMATCH");
+    ret = b_same ? 0 : 1;
+
+BENCH_FREE:
+    frame_unref(frame);
+    scene_destroy(&grown);
+    lattice_destroy(&lattice);
+    return ret;
+}
+
+/*** end of file ***/
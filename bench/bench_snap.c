@@ -0,0 +1,77 @@
+/** @file bench_snap.c
+ *
+ * @brief Snapshot benchmark: cost of restoring a full screen from a
+ * snapshot (open, map, verify, copy into the grid, unmap) and of saving one,
+ * at terminal and kiosk sizes.
+ *
+ */
+
+#include <time.h>
+
+#include "lib_snap.h"
+
+#define BENCH_PATH  "/tmp/bench_snap.snap"
+#define BENCH_LOADS 2000
+#define BENCH_SAVES 20
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+run (int32_t cols, int32_t rows)
+{
+    grid_t      *grid  = grid_create(cols, rows);
+    snap_state_t state = { .idx = 1234 };
+
+    srand(1);
+    for (int32_t y = 0; y < rows; ++y)
+    {
+        for (int32_t x = 0; x < cols; ++x)
+        {
+            cell_t cell = { .glyph = (rand() % 2) ? 0x2501 : 0,
+                            .r     = (uint8_t)rand(),
+                            .attr  = CELL_BOLD | CELL_RGB };
+            grid_set(grid, x, y, &cell);
+        }
+    }
+
+    uint64_t t_start = now_ns();
+    for (int32_t i = 0; i < BENCH_SAVES; ++i)
+    {
+        snap_save(BENCH_PATH, grid, &state);
+    }
+    double save_us = (double)(now_ns() - t_start) / 1000.0 / BENCH_SAVES;
+
+    int32_t restored = 0;
+    t_start          = now_ns();
+    for (int32_t i = 0; i < BENCH_LOADS; ++i)
+    {
+        snap_t *snap = snap_open(BENCH_PATH);
+        restored += (RETVAL_SUCCESS == snap_restore(snap, grid, &state));
+        snap_close(&snap);
+    }
+    double load_us = (double)(now_ns() - t_start) / 1000.0 / BENCH_LOADS;
+
+    printf("%4dx%-4d %8zu bytes  restore %7.1f us  save (fsync) %8.1f us  %s\n",
+           cols, rows, sizeof(snap_hdr_t) + ((size_t)cols * rows * sizeof(cell_t)),
+           load_us, save_us, (BENCH_LOADS == restored) ? "ok" : "FAILED");
+
+    unlink(BENCH_PATH);
+    grid_destroy(&grid);
+}
+
+int
+main (void)
+{
+    run(80, 24);
+    run(240, 67);
+    run(480, 135);
+    return 0;
+}
+
+/*** end of file ***/
@@ -0,0 +1,140 @@
+/** @file bench_typed.c
+ *
+ * @brief Small-element benchmark: heap vertices behind void * in llist_t vs
+ * vertices stored by value in a LL_DECLARE_TYPED list.
+ *
+ */
+
+#include <malloc.h>
+#include <time.h>
+
+#include "lib_llist_typed.h"
+
+#define BENCH_PASSES 20
+
+typedef struct bench_vert_t
+{
+    int32_t c;
+    int32_t x;
+    int32_t y;
+    int32_t dir_x;
+    int32_t dir_y;
+} bench_vert_t;
+
+static inline int32_t
+vert_cmp_x (const bench_vert_t *vert, int32_t x)
+{
+    return vert->x != x;
+}
+
+static int32_t
+vert_cmp_x_void (void *data, char *key)
+{
+    return ((bench_vert_t *)data)->x != *(int32_t *)key;
+}
+
+LL_DECLARE_TYPED(vert_list, bench_vert_t)
+LL_DEFINE_TYPED_SEARCH(vert_list, bench_vert_t, int32_t, vert_cmp_x)
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+run (int32_t length)
+{
+    int64_t sums[2]  = { 0 };
+    double  fill[2]  = { 0 };
+    double  iter[2]  = { 0 };
+    double  srch[2]  = { 0 };
+    size_t  bytes[2] = { 0 };
+    int32_t key      = length - 1;
+
+    // void * llist: one calloc per vertex on top of the node slabs
+    size_t   base    = mallinfo2().uordblks;
+    uint64_t t_start = now_ns();
+    llist_t *llist   = ll_create_lock(LL_LOCK_NONE);
+    for (int32_t idx = 0; idx < length; idx++)
+    {
+        bench_vert_t *vert = calloc(1, sizeof(*vert));
+        vert->x            = idx;
+        ll_enq(llist, vert);
+    }
+    fill[0]  = (double)(now_ns() - t_start) / length;
+    bytes[0] = mallinfo2().uordblks - base;
+
+    t_start = now_ns();
+    for (int32_t pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        ll_iter_t     it;
+        bench_vert_t *vert = NULL;
+        ll_iter_init(llist, &it);
+        while (NULL != (vert = ll_iter_step(&it)))
+        {
+            sums[0] += vert->x;
+        }
+    }
+    iter[0] = (double)(now_ns() - t_start) / ((double)length * BENCH_PASSES);
+
+    t_start = now_ns();
+    for (int32_t pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        sums[0] += ((bench_vert_t *)ll_search(llist, (char *)&key,
+                                              vert_cmp_x_void))->x;
+    }
+    srch[0] = (double)(now_ns() - t_start) / ((double)length * BENCH_PASSES);
+
+    // typed list: values live in the nodes
+    base              = mallinfo2().uordblks;
+    t_start           = now_ns();
+    vert_list_t typed = { 0 };
+    for (int32_t idx = 0; idx < length; idx++)
+    {
+        vert_list_enq(&typed, (bench_vert_t){ .x = idx });
+    }
+    fill[1]  = (double)(now_ns() - t_start) / length;
+    bytes[1] = mallinfo2().uordblks - base;
+
+    t_start = now_ns();
+    for (int32_t pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        bench_vert_t *vert = NULL;
+        LL_TYPED_FOREACH(vert_list, &typed, vert)
+        {
+            sums[1] += vert->x;
+        }
+    }
+    iter[1] = (double)(now_ns() - t_start) / ((double)length * BENCH_PASSES);
+
+    t_start = now_ns();
+    for (int32_t pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        sums[1] += vert_list_search(&typed, key)->x;
+    }
+    srch[1] = (double)(now_ns() - t_start) / ((double)length * BENCH_PASSES);
+
+    printf("len=%-8d bytes/elem void* %5.1f typed %5.1f | fill %5.1f / %5.1f "
+           "| iter %5.2f / %5.2f | search %5.2f / %5.2f ns/elem%s\n",
+           length, (double)bytes[0] / length, (double)bytes[1] / length,
+           fill[0], fill[1], iter[0], iter[1], srch[0], srch[1],
+           (sums[0] == sums[1]) ? "" : "  MISMATCH");
+
+    ll_destroy(&llist, free);
+    vert_list_destroy(&typed);
+}
+
+int
+main (void)
+{
+    for (int32_t length = 1024; length <= 1048576; length *= 32)
+    {
+        run(length);
+    }
+    return 0;
+}
+
+/*** end of file ***/
@@ -0,0 +1,106 @@
+/** @file bench_vector.c
+ *
+ * @brief Path iteration benchmark: heap vertices in a llist_t vs vertices
+ * stored inline in a vec_t.
+ *
+ */
+
+#include <time.h>
+
+#include "lib_vector.h"
+
+#define BENCH_PASSES 20
+
+typedef struct bench_vert_t
+{
+    int32_t c;
+    int32_t x;
+    int32_t y;
+    int32_t dir_x;
+    int32_t dir_y;
+} bench_vert_t;
+
+static uint64_t
+now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+run (int32_t length)
+{
+    llist_t *llist = ll_create_lock(LL_LOCK_NONE);
+    vec_t   *vec   = vec_create(sizeof(bench_vert_t), LL_LOCK_NONE);
+    int64_t  sums[2] = { 0 };
+    double   ns[2]   = { 0 };
+
+    uint64_t t_start = now_ns();
+    for (int32_t idx = 0; idx < length; idx++)
+    {
+        bench_vert_t *vert = calloc(1, sizeof(*vert));
+        vert->x            = idx;
+        vert->y            = idx / 3;
+        ll_enq(llist, vert);
+    }
+    double ll_fill = (double)(now_ns() - t_start) / length;
+
+    t_start = now_ns();
+    for (int32_t idx = 0; idx < length; idx++)
+    {
+        bench_vert_t vert = { .x = idx, .y = idx / 3 };
+        vec_append(vec, &vert);
+    }
+    double vec_fill = (double)(now_ns() - t_start) / length;
+
+    t_start = now_ns();
+    for (int32_t pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        ll_iter_t     iter;
+        bench_vert_t *vert = NULL;
+        ll_iter_init(llist, &iter);
+        while (NULL != (vert = ll_iter_step(&iter)))
+        {
+            sums[0] += vert->x + vert->y;
+        }
+    }
+    ns[0] = (double)(now_ns() - t_start) / ((double)length * BENCH_PASSES);
+
+    t_start = now_ns();
+    for (int32_t pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        vec_iter_t    iter;
+        bench_vert_t *span  = NULL;
+        size_t        count = 0;
+        vec_iter_init(vec, &iter);
+        while (NULL != (span = vec_iter_span(vec, &iter, 0, &count)))
+        {
+            for (size_t idx = 0; idx < count; idx++)
+            {
+                sums[1] += span[idx].x + span[idx].y;
+            }
+        }
+    }
+    ns[1] = (double)(now_ns() - t_start) / ((double)length * BENCH_PASSES);
+
+    printf("len=%-8d fill ll %6.1f vec %5.1f ns/elem   iter ll %6.2f vec %5.2f "
+           "ns/elem (%.1fx)%s\n",
+           length, ll_fill, vec_fill, ns[0], ns[1], ns[0] / ns[1],
+           (sums[0] == sums[1]) ? "" : "  MISMATCH");
+
+    ll_destroy(&llist, free);
+    vec_destroy(&vec, NULL);
+}
+
+int
+main (void)
+{
+    for (int32_t length = 1024; length <= 4194304; length *= 8)
+    {
+        run(length);
+    }
+    return 0;
+}
+
+/*** end of file ***/
@@ -0,0 +1,80 @@
+/** @file lib_alias.h
+ *
+ * @brief Alias Library: Walker alias tables, so a choice among weighted
+ * outcomes costs one random number and one lookup however the weights are
+ * spread. Holds many small tables of the same size side by side, e.g. one
+ * per situation, built once up front.
+ *
+ */
+
+#ifndef LIB_ALIAS_H
+#define LIB_ALIAS_H
+
+#include "lib_llist.h"
+
+#define ALIAS_MAX_OUTCOMES 16
+#define ALIAS_ROLL_BITS    31 // bits of the roll alias_draw uses (rand())
+
+/**
+ * @brief struct alias_t - struct for containing all alias table metadata
+ * @param   int32_t             tables;
+ * @param   int32_t             outcomes;   (per table)
+ * @param   uint32_t            *keep;      (odds, out of 2^31, that a
+ *                                          column keeps its own outcome)
+ * @param   uint8_t             *alias;     (the outcome a column gives
+ *                                          otherwise)
+ */
+typedef struct alias_t alias_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize TABLES alias tables of OUTCOMES outcomes each, all
+ * uniform until built
+ *
+ * @param   tables      (int32_t)           Number of tables
+ * @param   outcomes    (int32_t)           Outcomes per table (1 to
+ *                                          ALIAS_MAX_OUTCOMES)
+ *
+ * @returns alias       (alias_t *)         PTR to alias tables, NULL if Failed.
+ */
+alias_t *alias_create(int32_t tables, int32_t outcomes);
+
+/**
+ * @brief Build table TABLE from WEIGHTS (Vose's method): outcome N is drawn
+ * with probability WEIGHTS[N] / sum(WEIGHTS)
+ *
+ * @param   alias       (alias_t *)         PTR to the alias tables
+ * @param   table       (int32_t)           Table to build
+ * @param   weights     (const double *)    One weight >= 0 per outcome
+ *
+ * @returns 0 on Success, -1 if Failed (bad table, or no weight at all; the
+ * table is left as it was).
+ */
+int32_t alias_build(alias_t *alias, int32_t table, const double *weights);
+
+/**
+ * @brief Draw an outcome from table TABLE. The top bits of ROLL pick a column,
+ * the rest decide between the column's outcome and its alias.
+ *
+ * @param   alias       (const alias_t *)   PTR to the alias tables
+ * @param   table       (int32_t)           Table to draw from
+ * @param   roll        (uint32_t)          Uniform in [0, 2^ALIAS_ROLL_BITS)
+ *
+ * @returns outcome     (int32_t)           0 to OUTCOMES - 1.
+ */
+int32_t alias_draw(const alias_t *alias, int32_t table, uint32_t roll);
+
+/**
+ * @brief Free the alias tables and set their PTR to NULL
+ *
+ * @param   alias       (alias_t **)        PTR to alias tables PTR
+ *
+ * @returns N/A         (void)
+ */
+void alias_destroy(alias_t **alias);
+
+#endif /* LIB_ALIAS_H */
+
+/*** end of file ***/
@@ -0,0 +1,96 @@
+/** @file lib_bcast.h
+ *
+ * @brief Broadcast Library: fan encoded frames out to any number of viewers
+ * connected over a Unix domain socket. Every viewer is sent the same
+ * refcounted frame, so output is encoded once for N clients. A viewer that
+ * falls behind has its backlog dropped and is resynced with a keyframe
+ * instead of stalling the others.
+ *
+ */
+
+#ifndef LIB_BCAST_H
+#define LIB_BCAST_H
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "lib_frame.h"
+
+#define BCAST_BACKLOG_DEFAULT (256 * 1024) // queued bytes before resync
+
+/**
+ * @brief struct bcast_t - struct for containing all broadcast metadata
+ * @param   int                 fd;         (listening socket)
+ * @param   char                *path;
+ * @param   size_t              backlog;    (per-client queued byte limit)
+ * @param   llist_t             *clients;   (bcast_client_t, round robin)
+ */
+typedef struct bcast_t bcast_t;
+
+/**
+ * @brief typedef bcast_key_f - Append a keyframe (the full current picture)
+ * to FRAME. CTX is passed through from bcast_publish.
+ */
+typedef int32_t (*bcast_key_f)(frame_t *frame, void *ctx);
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Listen on a Unix domain socket at PATH. A stale socket left at PATH
+ * by a previous run is replaced; any other kind of file is not touched.
+ *
+ * @param   path        (const char *)      Filesystem path of the socket
+ * @param   backlog     (size_t)            Queued bytes per client before it
+ *                                          is resynced; 0 for the default
+ *
+ * @returns bcast       (bcast_t *)         PTR to bcast, NULL if Failed.
+ */
+bcast_t *bcast_create(const char *path, size_t backlog);
+
+/**
+ * @brief Accept new viewers, queue FRAME to every viewer that is in sync, and
+ * write as much of each queue as the sockets take without blocking. Viewers
+ * that are new or have overflowed their backlog get a keyframe from KEYFRAME
+ * instead (encoded at most once per call) once their queue has drained.
+ *
+ * @param   bcast       (bcast_t *)         PTR to the bcast
+ * @param   frame       (frame_t *)         Frame to send; NULL to only service
+ *                                          the sockets. A ref is taken per
+ *                                          viewer; the caller keeps its own.
+ * @param   keyframe    (bcast_key_f)       Keyframe encoder
+ * @param   ctx         (void *)            Passed to KEYFRAME
+ *
+ * @returns count       (int32_t)           Connected viewers, -1 if Failed.
+ */
+int32_t bcast_publish(bcast_t *bcast, frame_t *frame, bcast_key_f keyframe,
+                      void *ctx);
+
+/**
+ * @brief Disconnect every viewer, close and unlink the socket, and set the
+ * caller's PTR to NULL
+ *
+ * @param   bcast       (bcast_t **)        PTR to the bcast PTR
+ *
+ * @returns N/A         (void)
+ */
+void bcast_destroy(bcast_t **bcast);
+
+/**
+ * @brief Viewer side: connect to the socket at PATH and copy everything it
+ * sends to stdout until the server goes away or *RUNNING drops to 0.
+ *
+ * @param   path        (const char *)              Socket path
+ * @param   running     (volatile sig_atomic_t *)   Cleared to stop (SIGINT)
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t bcast_attach(const char *path, volatile sig_atomic_t *running);
+
+#endif /* LIB_BCAST_H */
+
+/*** end of file ***/
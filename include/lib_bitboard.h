@@ -0,0 +1,102 @@
+/** @file lib_bitboard.h
+ *
+ * @brief Bitboard Library: which cells of the screen are taken, one bit per
+ * cell, so a pipe can look ahead before it turns. Reachable area is found by
+ * flood filling a whole row of words at a time with shifts and masks.
+ *
+ */
+
+#ifndef LIB_BITBOARD_H
+#define LIB_BITBOARD_H
+
+#include "lib_llist.h"
+
+#define BITBOARD_MAX_STEPS 64 // deepest lookahead bitboard_reach will do
+
+/**
+ * @brief struct bitboard_t - struct for containing all bitboard metadata
+ * @param   int32_t             cols;
+ * @param   int32_t             rows;
+ * @param   int32_t             words;  (per row; bit N of a row is column N)
+ * @param   uint64_t            *free;  (1 = open; columns past COLS are 0)
+ * @param   uint64_t            *reach; (flood fill scratch: 2 boards with
+ *                                      a zero word on every side)
+ */
+typedef struct bitboard_t bitboard_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize an empty bitboard for a COLS x ROWS grid
+ *
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns board       (bitboard_t *)      PTR to bitboard, NULL if Failed.
+ */
+bitboard_t *bitboard_create(int32_t cols, int32_t rows);
+
+/**
+ * @brief Match the grid dimensions. Every cell becomes open.
+ *
+ * @param   board       (bitboard_t *)      PTR to the bitboard
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns 0 on Success, -1 if Failed (board is left unchanged).
+ */
+int32_t bitboard_resize(bitboard_t *board, int32_t cols, int32_t rows);
+
+/**
+ * @brief Mark the cell at column X, row Y (0-based) as taken
+ *
+ * @param   board       (bitboard_t *)      PTR to the bitboard
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ *
+ * @returns N/A         (void)
+ */
+void bitboard_set(bitboard_t *board, int32_t x, int32_t y);
+
+/**
+ * @brief Check whether the cell at column X, row Y (0-based) is open
+ *
+ * @param   board       (bitboard_t *)      PTR to the bitboard
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ *
+ * @returns b_open      (int32_t)           1 if open, 0 if taken or off the
+ * grid.
+ */
+int32_t bitboard_open(bitboard_t *board, int32_t x, int32_t y);
+
+/**
+ * @brief Count the open cells reachable from column X, row Y in at most
+ * STEPS moves up, down, left or right through open cells. Only the words
+ * within STEPS of X, Y are touched, and the fill stops early once nothing
+ * new is reached.
+ *
+ * @param   board       (bitboard_t *)      PTR to the bitboard
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ * @param   steps       (int32_t)           Depth, 0 to BITBOARD_MAX_STEPS
+ *
+ * @returns count       (int32_t)           Cells reached (0 if X, Y is
+ * taken), -1 if Failed.
+ */
+int32_t bitboard_reach(bitboard_t *board, int32_t x, int32_t y,
+                       int32_t steps);
+
+/**
+ * @brief Free the bitboard and set the caller's PTR to NULL
+ *
+ * @param   board       (bitboard_t **)     PTR to the bitboard PTR
+ *
+ * @returns N/A         (void)
+ */
+void bitboard_destroy(bitboard_t **board);
+
+#endif /* LIB_BITBOARD_H */
+
+/*** end of file ***/
@@ -0,0 +1,113 @@
+/** @file lib_density.h
+ *
+ * @brief Density Library: a coarse map of how full each region of the screen
+ * is, so a pipe can turn toward empty space. Cells are counted per tile as
+ * they are drawn, along with the sum of each tile's 3x3 neighbourhood and
+ * running totals per tile column and row, so looking ahead in a direction,
+ * near or as far as the edge, is a read or two. Nothing is ever rebuilt.
+ *
+ */
+
+#ifndef LIB_DENSITY_H
+#define LIB_DENSITY_H
+
+#include "lib_llist.h"
+
+#define DENSITY_TILE_W 8 // tile size in cells; cells are about twice as tall
+#define DENSITY_TILE_H 4
+
+/**
+ * @brief struct density_t - struct for containing all density metadata
+ * @param   int32_t             cols;   (in cells)
+ * @param   int32_t             rows;
+ * @param   int32_t             tcols;  (in tiles, rounded up)
+ * @param   int32_t             trows;
+ * @param   uint16_t            *count; (cells covered per tile, row-major)
+ * @param   uint16_t            *block; (sum of COUNT over the 3x3 tiles
+ *                                      around each; off-grid tiles are full)
+ * @param   uint32_t            *col_upto; (cells covered left of each tile
+ *                                      column; TCOLS + 1 entries)
+ * @param   uint32_t            *row_upto; (cells covered above each tile row)
+ */
+typedef struct density_t density_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize an empty density map for a COLS x ROWS grid
+ *
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns density     (density_t *)       PTR to density, NULL if Failed.
+ */
+density_t *density_create(int32_t cols, int32_t rows);
+
+/**
+ * @brief Match the grid dimensions. Every tile becomes empty.
+ *
+ * @param   density     (density_t *)       PTR to the density map
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns 0 on Success, -1 if Failed (density is left unchanged).
+ */
+int32_t density_resize(density_t *density, int32_t cols, int32_t rows);
+
+/**
+ * @brief Count a cell newly covered at column X, row Y (0-based): its tile,
+ * the nine neighbourhood sums and the column and row totals it belongs to
+ *
+ * @param   density     (density_t *)       PTR to the density map
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ *
+ * @returns N/A         (void)
+ */
+void density_add(density_t *density, int32_t x, int32_t y);
+
+/**
+ * @brief Free space ahead of column X, row Y when heading DIR_X, DIR_Y: the
+ * empty cells of the 3x3 tiles centered two tiles that way. Tiles off the
+ * grid count as full, and a center past the edge is moved back onto the grid
+ * and its room discounted, so walls repel without fencing off the edges.
+ *
+ * @param   density     (density_t *)       PTR to the density map
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ * @param   dir_x       (int32_t)           -1, 0 or 1
+ * @param   dir_y       (int32_t)           -1, 0 or 1
+ *
+ * @returns free        (int32_t)           Empty cells, 0 if Failed.
+ */
+int32_t density_free(density_t *density, int32_t x, int32_t y, int32_t dir_x,
+                     int32_t dir_y);
+
+/**
+ * @brief Free space on the far side of the tile holding column X, row Y when
+ * heading DIR_X, DIR_Y: every empty cell between that tile and the edge.
+ *
+ * @param   density     (density_t *)       PTR to the density map
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ * @param   dir_x       (int32_t)           -1, 0 or 1
+ * @param   dir_y       (int32_t)           -1, 0 or 1
+ *
+ * @returns free        (int32_t)           Empty cells, 0 if Failed.
+ */
+int32_t density_side(density_t *density, int32_t x, int32_t y, int32_t dir_x,
+                     int32_t dir_y);
+
+/**
+ * @brief Free the density map and set the caller's PTR to NULL
+ *
+ * @param   density     (density_t **)      PTR to the density map PTR
+ *
+ * @returns N/A         (void)
+ */
+void density_destroy(density_t **density);
+
+#endif /* LIB_DENSITY_H */
+
+/*** end of file ***/
@@ -0,0 +1,93 @@
+/** @file lib_fade.h
+ *
+ * @brief Fade Library: dims cells of a grid_t a little each frame until they
+ * disappear. Every cell keeps an age byte; the whole age plane is advanced
+ * at once with a SIMD kernel and only cells whose quantized brightness
+ * changed are rewritten in the grid and emitted.
+ *
+ */
+
+#ifndef LIB_FADE_H
+#define LIB_FADE_H
+
+#include "lib_grid.h"
+#include "lib_render.h"
+
+#define FADE_LEVELS 16 // brightness steps; the last one clears the cell
+#define FADE_INERT  255 // age of a cell that is empty or not fading
+
+/**
+ * @brief struct fade_t - struct for containing all fade metadata
+ * @param   int32_t             cols;
+ * @param   int32_t             rows;
+ * @param   uint8_t             step;   (age added per frame)
+ * @param   uint8_t             *age;   (per cell; FADE_INERT when idle)
+ * @param   cell_t              *base;  (cell as drawn, at full brightness)
+ * @param   uint16_t            lut[];  (brightness per level, 0..256)
+ */
+typedef struct fade_t fade_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize a fade for a COLS x ROWS grid where a cell takes about
+ * FRAMES frames to fade out
+ *
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ * @param   frames      (int32_t)           Fade-out length in frames
+ *
+ * @returns fade        (fade_t *)          PTR to fade, NULL if Failed.
+ */
+fade_t *fade_create(int32_t cols, int32_t rows, int32_t frames);
+
+/**
+ * @brief Match the grid dimensions. Every cell becomes idle.
+ *
+ * @param   fade        (fade_t *)          PTR to the fade
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns 0 on Success, -1 if Failed (fade is left unchanged).
+ */
+int32_t fade_resize(fade_t *fade, int32_t cols, int32_t rows);
+
+/**
+ * @brief Start fading the cell just drawn at column X, row Y (0-based) from
+ * its current contents in GRID
+ *
+ * @param   fade        (fade_t *)          PTR to the fade
+ * @param   grid        (grid_t *)          PTR to the grid holding the cell
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t fade_touch(fade_t *fade, grid_t *grid, int32_t x, int32_t y);
+
+/**
+ * @brief Age every fading cell by one frame. Cells that reach a new
+ * brightness level are updated in GRID and, if RENDER is not NULL, drawn
+ * into its current frame.
+ *
+ * @param   fade        (fade_t *)          PTR to the fade
+ * @param   grid        (grid_t *)          PTR to the grid to update
+ * @param   render      (render_t *)        Render to draw with, or NULL
+ *
+ * @returns count       (int32_t)           Cells changed, -1 if Failed.
+ */
+int32_t fade_step(fade_t *fade, grid_t *grid, render_t *render);
+
+/**
+ * @brief Free the fade and set the caller's PTR to NULL
+ *
+ * @param   fade        (fade_t **)         PTR to the fade PTR
+ *
+ * @returns N/A         (void)
+ */
+void fade_destroy(fade_t **fade);
+
+#endif /* LIB_FADE_H */
+
+/*** end of file ***/
@@ -0,0 +1,147 @@
+/** @file lib_frame.h
+ *
+ * @brief Frame Library: growable byte buffers holding encoded terminal output
+ * (escape sequences + UTF-8 glyphs). Frames are refcounted so one encoding
+ * can be queued to several outputs at once.
+ *
+ */
+
+#ifndef LIB_FRAME_H
+#define LIB_FRAME_H
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#include "lib_llist.h"
+
+/**
+ * @brief struct frame_t - refcounted byte buffer
+ * @param   uint8_t             *data;
+ * @param   size_t              len;
+ * @param   size_t              cap;
+ * @param   _Atomic int32_t     refs;
+ */
+typedef struct frame_t frame_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize an empty frame holding one reference
+ *
+ * @param   cap         (size_t)            Initial capacity in bytes
+ *
+ * @returns frame       (frame_t *)         PTR to frame, NULL if Failed.
+ */
+frame_t *frame_create(size_t cap);
+
+/**
+ * @brief Append LEN raw BYTES to the frame
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ * @param   bytes       (const void *)      PTR to the bytes to copy in
+ * @param   len         (size_t)            Number of bytes
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t frame_put(frame_t *frame, const void *bytes, size_t len);
+
+/**
+ * @brief Append printf-formatted text (escape sequences) to the frame
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ * @param   fmt         (const char *)      printf format string
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t frame_printf(frame_t *frame, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Append VALUE in decimal. Cheaper than frame_printf for the numbers
+ * inside escape sequences written once per cell.
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ * @param   value       (uint32_t)          Number to append
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t frame_putnum(frame_t *frame, uint32_t value);
+
+/**
+ * @brief Append one glyph, UTF-8 encoded (independent of the C locale)
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ * @param   glyph       (uint32_t)          Unicode code point
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t frame_putwc(frame_t *frame, uint32_t glyph);
+
+/**
+ * @brief Empty the frame, keeping its capacity
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ *
+ * @returns N/A         (void)
+ */
+void frame_reset(frame_t *frame);
+
+/**
+ * @brief Return the frame's bytes. Valid until the next append or reset.
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ * @param   len         (size_t *)          OUT: number of bytes
+ *
+ * @returns data        (const uint8_t *)   PTR to bytes, NULL if Failed.
+ */
+const uint8_t *frame_data(frame_t *frame, size_t *len);
+
+/**
+ * @brief Take another reference to the frame
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ *
+ * @returns frame       (frame_t *)         FRAME, for chaining.
+ */
+frame_t *frame_ref(frame_t *frame);
+
+/**
+ * @brief Is anyone besides the caller still holding this frame?
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ *
+ * @returns b_shared    (int32_t)           1 if shared, 0 if not.
+ */
+int32_t frame_shared(frame_t *frame);
+
+/**
+ * @brief Drop a reference; the last one frees the frame. Matches lliter_f so
+ * frames can be queued in a llist_t and released with ll_dump/ll_destroy.
+ *
+ * @param   frame       (void *)            PTR to the frame
+ *
+ * @returns N/A         (void)
+ */
+void frame_unref(void *frame);
+
+/**
+ * @brief write() every byte of the frame to FD, retrying on EINTR/short writes
+ *
+ * @param   frame       (frame_t *)         PTR to the frame
+ * @param   fd          (int)               File descriptor
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t frame_write(frame_t *frame, int fd);
+
+#endif /* LIB_FRAME_H */
+
+/*** end of file ***/
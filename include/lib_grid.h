@@ -0,0 +1,175 @@
+/** @file lib_grid.h
+ *
+ * @brief Grid Library: the terminal screen as a 2D array of cells, so the
+ * current picture can be re-encoded from scratch (keyframes) at any time.
+ *
+ */
+
+#ifndef LIB_GRID_H
+#define LIB_GRID_H
+
+#include "lib_frame.h"
+
+#define CELL_BOLD 0x01 // SGR 1
+#define CELL_RGB  0x02 // R/G/B hold a truecolor foreground
+#define CELL_PAL  0x04 // R holds a 256-color palette index (G/B unused)
+
+/**
+ * @brief struct cell_t - one terminal cell. GLYPH 0 is an empty (cleared) cell.
+ * @param   uint32_t            glyph;  (Unicode code point)
+ * @param   uint8_t             r;
+ * @param   uint8_t             g;
+ * @param   uint8_t             b;
+ * @param   uint8_t             attr;   (CELL_* flags)
+ */
+typedef struct cell_t
+{
+    uint32_t glyph;
+    uint8_t  r;
+    uint8_t  g;
+    uint8_t  b;
+    uint8_t  attr;
+} cell_t;
+
+/**
+ * @brief struct grid_t - struct for containing all grid metadata
+ * @param   int32_t             cols;
+ * @param   int32_t             rows;
+ * @param   cell_t              *cells; (row-major, COLS * ROWS)
+ * @param   uint64_t            *dirty; (one bit per row changed since reset)
+ */
+typedef struct grid_t grid_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize a cleared grid of COLS x ROWS cells
+ *
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns grid        (grid_t *)          PTR to grid, NULL if Failed.
+ */
+grid_t *grid_create(int32_t cols, int32_t rows);
+
+/**
+ * @brief Change the grid dimensions. Contents are cleared.
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns 0 on Success, -1 if Failed (grid is left unchanged).
+ */
+int32_t grid_resize(grid_t *grid, int32_t cols, int32_t rows);
+
+/**
+ * @brief Empty every cell, as "\033[2J" does to the terminal
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ *
+ * @returns N/A         (void)
+ */
+void grid_clear(grid_t *grid);
+
+/**
+ * @brief Store CELL at column X, row Y (0-based). Out-of-range is ignored.
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ * @param   cell        (const cell_t *)    PTR to the cell to copy in
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t grid_set(grid_t *grid, int32_t x, int32_t y, const cell_t *cell);
+
+/**
+ * @brief Replace every cell with CELLS (row-major, COLS * ROWS, as laid out
+ * in the grid) and mark every row dirty
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ * @param   cells       (const cell_t *)    PTR to COLS * ROWS cells
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t grid_load(grid_t *grid, const cell_t *cells);
+
+/**
+ * @brief Return the cell at column X, row Y (0-based)
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ *
+ * @returns cell        (const cell_t *)    PTR to cell, NULL if out of range.
+ */
+const cell_t *grid_get(grid_t *grid, int32_t x, int32_t y);
+
+/**
+ * @brief Return the grid dimensions
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ * @param   cols        (int32_t *)         OUT: width in cells
+ * @param   rows        (int32_t *)         OUT: height in cells
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t grid_size(grid_t *grid, int32_t *cols, int32_t *rows);
+
+/**
+ * @brief Return the bitmap of rows changed (set, cleared or resized) since the
+ * last grid_dirty_reset. Bit (Y % 64) of word (Y / 64) is row Y.
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ * @param   words       (size_t *)          OUT: number of 64-bit words
+ *
+ * @returns dirty       (const uint64_t *)  PTR to bitmap, NULL if Failed.
+ */
+const uint64_t *grid_dirty(grid_t *grid, size_t *words);
+
+/**
+ * @brief Count the rows changed since the last grid_dirty_reset
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ *
+ * @returns count       (int32_t)           Dirty rows, -1 if Failed.
+ */
+int32_t grid_dirty_rows(grid_t *grid);
+
+/**
+ * @brief Mark every row clean. Call once every consumer of the bitmap has
+ * seen the current frame.
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ *
+ * @returns N/A         (void)
+ */
+void grid_dirty_reset(grid_t *grid);
+
+/**
+ * @brief Append the grid as plain lines of text to FRAME: one line per row,
+ * empty cells as spaces, no cursor movement. With B_STYLE each cell's bold
+ * and color are kept as SGR.
+ *
+ * @param   grid        (grid_t *)          PTR to the grid
+ * @param   frame       (frame_t *)         PTR to the frame to append to
+ * @param   b_style     (int32_t)           Nonzero to include SGR
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t grid_encode_lines(grid_t *grid, frame_t *frame, int32_t b_style);
+
+/**
+ * @brief Free the grid and set the caller's PTR to NULL
+ *
+ * @param   grid        (grid_t **)         PTR to the grid PTR
+ *
+ * @returns N/A         (void)
+ */
+void grid_destroy(grid_t **grid);
+
+#endif /* LIB_GRID_H */
+
+/*** end of file ***/
@@ -0,0 +1,148 @@
+/** @file lib_lattice.h
+ *
+ * @brief Lattice Library: pipes growing through a 3D lattice of cells, one
+ * cell a step, in any of six directions and never through a taken cell. The
+ * pipes are kept as pieces to draw: a tube per straight run, grown in place
+ * while the run goes on, and a joint sphere at every turn.
+ *
+ */
+
+#ifndef LIB_LATTICE_H
+#define LIB_LATTICE_H
+
+#include "lib_vector.h"
+
+#define LATTICE_DIRS    6 // +x -x +y -y +z -z; opposite directions pair up
+#define LATTICE_TUBE    0.30f // radius of a tube, in cells
+#define LATTICE_JOINT   0.42f // radius of a joint sphere
+#define LATTICE_PIPES   8 // pipes per cycle
+#define LATTICE_FILL    30 // or this percent of the cells taken
+#define LATTICE_CELL_PX 12 // screen pixels per cell, for lattice_fit
+#define LATTICE_MIN     4 // cells along an axis, at the least
+
+/**
+ * @brief struct lattice_piece_t - one piece to draw: a tube from A to B with
+ * round ends, or a sphere when A and B are the same point
+ * @param   float               a[];        (one end, in cells; y up)
+ * @param   float               b[];        (the other end)
+ * @param   float               radius;     (in cells)
+ * @param   uint32_t            rgb;        (0xRRGGBB)
+ */
+typedef struct lattice_piece_t
+{
+    float    a[3];
+    float    b[3];
+    float    radius;
+    uint32_t rgb;
+} lattice_piece_t;
+
+/**
+ * @brief struct lattice_t - struct for containing all lattice metadata
+ * @param   int32_t             size[];     (cells along x, y, z)
+ * @param   uint8_t             *taken;     (per cell, x fastest)
+ * @param   vec_t               *pieces;    (lattice_piece_t, in drawing order)
+ * @param   int32_t             head[];     (cell the current pipe is in)
+ * @param   int32_t             dir;        (its heading; -1 when no pipe runs)
+ * @param   int32_t             left;       (steps before it ends on its own)
+ * @param   int32_t             pipes;      (started this cycle)
+ * @param   int64_t             filled;     (cells taken)
+ * @param   uint32_t            rgb;        (color of the current pipe)
+ * @param   bool                b_run;      (last piece is its straight run)
+ */
+typedef struct lattice_t lattice_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize an empty lattice of NX x NY x NZ cells
+ *
+ * @param   nx          (int32_t)           Cells along x
+ * @param   ny          (int32_t)           Cells along y (up)
+ * @param   nz          (int32_t)           Cells along z
+ *
+ * @returns lattice     (lattice_t *)       PTR to lattice, NULL if Failed.
+ */
+lattice_t *lattice_create(int32_t nx, int32_t ny, int32_t nz);
+
+/**
+ * @brief Change the lattice size; the lattice is emptied either way
+ *
+ * @param   lattice     (lattice_t *)       PTR to the lattice
+ * @param   nx          (int32_t)           Cells along x
+ * @param   ny          (int32_t)           Cells along y (up)
+ * @param   nz          (int32_t)           Cells along z
+ *
+ * @returns 0 on Success, -1 if Failed (the old size is kept).
+ */
+int32_t lattice_resize(lattice_t *lattice, int32_t nx, int32_t ny, int32_t nz);
+
+/**
+ * @brief Size the lattice for a screen of WIDTH x HEIGHT square pixels: about
+ * LATTICE_CELL_PX pixels a cell, and as deep as it is tall. The lattice is
+ * emptied either way.
+ *
+ * @param   lattice     (lattice_t *)       PTR to the lattice
+ * @param   width       (int32_t)           Screen width in pixels
+ * @param   height      (int32_t)           Screen height in pixels
+ *
+ * @returns 0 on Success, -1 if Failed (the old size is kept).
+ */
+int32_t lattice_fit(lattice_t *lattice, int32_t width, int32_t height);
+
+/**
+ * @brief Empty the lattice for a new cycle
+ *
+ * @param   lattice     (lattice_t *)       PTR to the lattice
+ *
+ * @returns N/A         (void)
+ */
+void lattice_reset(lattice_t *lattice);
+
+/**
+ * @brief Grow the current pipe one cell, or end it when it is boxed in or
+ * has run its length, or start the next one. Turns are random (rand()), so
+ * srand() repeats a run. Pieces from FIRST on were added or changed.
+ *
+ * @param   lattice     (lattice_t *)       PTR to the lattice
+ * @param   first       (size_t *)          OUT: first piece that changed
+ *
+ * @returns 0 on Success, -1 once the cycle is over (enough pipes, or the
+ *          lattice filled up) or if Failed.
+ */
+int32_t lattice_step(lattice_t *lattice, size_t *first);
+
+/**
+ * @brief Return the pieces drawn so far
+ *
+ * @param   lattice     (lattice_t *)       PTR to the lattice
+ * @param   count       (size_t *)          OUT: number of pieces
+ *
+ * @returns pieces      (const lattice_piece_t *) PTR to the first piece, NULL
+ *          if there are none or Failed.
+ */
+const lattice_piece_t *lattice_pieces(lattice_t *lattice, size_t *count);
+
+/**
+ * @brief Return the box every piece fits in, joints included
+ *
+ * @param   lattice     (const lattice_t *) PTR to the lattice
+ * @param   lo          (float *)           OUT: least x, y, z
+ * @param   hi          (float *)           OUT: greatest x, y, z
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t lattice_bounds(const lattice_t *lattice, float *lo, float *hi);
+
+/**
+ * @brief Free the lattice and set the caller's PTR to NULL
+ *
+ * @param   lattice     (lattice_t **)      PTR to the lattice PTR
+ *
+ * @returns N/A         (void)
+ */
+void lattice_destroy(lattice_t **lattice);
+
+#endif /* LIB_LATTICE_H */
+
+/*** end of file ***/
@@ -10,6 +10,7 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <strings.h>
 #include <stdio.h>
@@ -30,12 +31,73 @@ typedef struct ll_node_t ll_node_t;
 /**
  * @brief struct llist_t - struct for containing all linkedlist metadata
  * @param   uint64_t            count;
+ * @param   ll_lock_t           policy;
  * @param   ll_node_t           *head;
  * @param   ll_node_t           *tail;
- * @param   pthread_mutex_t     lock;
+ * @param   ll_pool_t           *pool;   (node slabs; shared after split)
+ * @param   ll_index_t          *index;  (optional key index)
+ * @param   int32_t             readers; (open snapshots)
+ * @param   ll_limbo_t          *limbo;  (nodes removed under a snapshot)
+ * @param   union               lock;   (sized to POLICY; absent for NONE)
  */
 typedef struct llist_t llist_t;
 
+/**
+ * @brief struct ll_iter_t - caller-owned (stack) cursor into a llist. Takes no
+ * lock and holds no heap memory; the llist must not be shrunk while in use.
+ * @param   ll_node_t           *next;
+ */
+typedef struct ll_iter_t
+{
+    ll_node_t *next;
+} ll_iter_t;
+
+/**
+ * @brief struct ll_snap_t - caller-owned consistent view of a llist as it was
+ * at ll_snap_begin(). Held without the list lock; writers keep going.
+ * @param   llist_t             *llist;
+ * @param   ll_node_t           *next;
+ * @param   int32_t             remaining;
+ */
+typedef struct ll_snap_t
+{
+    llist_t   *llist;
+    ll_node_t *next;
+    int32_t    remaining;
+} ll_snap_t;
+
+/**
+ * @brief ll_lock_t - synchronization policy of a llist, fixed at creation.
+ *
+ * LL_LOCK_NONE     single-owner list; no lock is stored or taken
+ * LL_LOCK_MUTEX    pthread mutex (default; shared lists)
+ * LL_LOCK_SPIN     pthread spinlock, for very short critical sections
+ */
+typedef enum ll_lock_t
+{
+    LL_LOCK_NONE = 0,
+    LL_LOCK_MUTEX,
+    LL_LOCK_SPIN,
+} ll_lock_t;
+
+/**
+ * @brief struct llmpsc_node_t - intrusive link for the lock-free MPSC queue.
+ * Embed one in the caller's own struct; the queue never allocates.
+ * @param   struct llmpsc_node_t *_Atomic next;
+ */
+typedef struct llmpsc_node_t
+{
+    struct llmpsc_node_t *_Atomic next;
+} llmpsc_node_t;
+
+/**
+ * @brief struct llmpsc_t - multi-producer/single-consumer lock-free queue
+ * @param   llmpsc_node_t *_Atomic  tail;   (producers)
+ * @param   llmpsc_node_t           stub;
+ * @param   llmpsc_node_t           *cache; (consumer)
+ */
+typedef struct llmpsc_t llmpsc_t;
+
 // =============================================================================
 //                               FUNCTION POINTERS
 // =============================================================================
@@ -53,16 +115,41 @@ typedef void (*lliter_f)(void *);
  */
 typedef int32_t (*llcmp_f)(void *, char *);
 
+/**
+ * @brief Function pointer that returns the search KEY stored in DATA.
+ *
+ * Used for ll_index_create.
+ */
+typedef char *(*llkey_f)(void *);
+
+/**
+ * @brief Function pointer that hashes a search KEY. Equal keys (per the
+ * llcmp_f later given to ll_search) must hash equal.
+ *
+ * Used for ll_index_create.
+ */
+typedef uint64_t (*llhash_f)(char *);
+
 // =============================================================================
 //                              LIBRARY FUNCTIONS
 // =============================================================================
 /**
- * @brief Initialize a linked llist
+ * @brief Initialize a linked llist (LL_LOCK_MUTEX policy)
  *
  * @returns llist       (llist *)           PTR to llist, NULL if Failed.
  */
 llist_t *ll_create(void);
 
+/**
+ * @brief Initialize a linked llist with the given lock POLICY. Lists created
+ * with LL_LOCK_NONE must only be used from one thread at a time.
+ *
+ * @param   policy      (ll_lock_t)         Synchronization policy
+ *
+ * @returns llist       (llist *)           PTR to llist, NULL if Failed.
+ */
+llist_t *ll_create_lock(ll_lock_t policy);
+
 /**
  * @brief Put DATA at end of llist (enqueue) (queue behavior)
  *
@@ -113,6 +200,29 @@ void *ll_pop(llist_t *llist);
  */
 void *ll_search(llist_t *llist, char *key, llcmp_f cmpnode);
 
+/**
+ * @brief Attach a hash index over the KEY of every DATA in llist, current and
+ * future. While indexed, ll_search is O(1) average instead of a linear scan
+ * and still returns the first occurance in list order. DATA must not change
+ * its KEY while in the llist.
+ *
+ * @param   llist       (llist_t *)         PTR to the linked llist
+ * @param   getkey      (llkey_f)           Func PTR to extract KEY from DATA
+ * @param   hashkey     (llhash_f)          Func PTR to hash a KEY
+ *
+ * @returns 0 on Success, -1 if Failed or already indexed.
+ */
+int32_t ll_index_create(llist_t *llist, llkey_f getkey, llhash_f hashkey);
+
+/**
+ * @brief FNV-1a hash of a NUL-terminated KEY; a ready-made llhash_f.
+ *
+ * @param   key         (char *)            PTR to the search key
+ *
+ * @returns hash        (uint64_t)          Hash of KEY.
+ */
+uint64_t ll_hash_str(char *key);
+
 /**
  * @brief delete up to n nodes, starting at front/top of llist
  *
@@ -146,6 +256,40 @@ int64_t ll_dump(llist_t *llist, lliter_f freenode);
  */
 void ll_destroy(llist_t **llist, lliter_f freenode);
 
+/**
+ * @brief Append every node of SRC to the end of DST, leaving SRC empty. Pure
+ * pointer surgery under both locks (taken in address order); O(1) unless DST
+ * is indexed or SRC shares its node pool with a third list.
+ *
+ * @param   dst         (llist_t *)         PTR to the receiving llist
+ * @param   src         (llist_t *)         PTR to the llist to drain
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t ll_splice(llist_t *dst, llist_t *src);
+
+/**
+ * @brief Keep the first INDEX nodes in llist and move the rest, in order, to a
+ * new llist with the same lock policy. O(INDEX); nodes are not copied.
+ *
+ * @param   llist       (llist_t *)         PTR to the linked llist
+ * @param   index       (int32_t)           Number of nodes to keep
+ *
+ * @returns rest        (llist_t *)         PTR to new llist (possibly empty),
+ * NULL if Failed.
+ */
+llist_t *ll_split_at(llist_t *llist, int32_t index);
+
+/**
+ * @brief Move every node of llist to a new llist in O(1), leaving llist
+ * empty. Hand the result to another thread as one batch.
+ *
+ * @param   llist       (llist_t *)         PTR to the linked llist
+ *
+ * @returns batch       (llist_t *)         PTR to new llist, NULL if Failed.
+ */
+llist_t *ll_take_all(llist_t *llist);
+
 /**
  * @brief printf the link llist
  *
@@ -184,7 +328,8 @@ void *ll_head(llist_t *llist);
 void *ll_tail(llist_t *llist);
 
 /**
- * @brief for each item in llist, do iter()
+ * @brief for each item in llist, do iter(). Runs on a snapshot (see
+ * ll_snap_begin), so writers are not blocked by ITER.
  *
  * @param   llist       (llist_t *)         PTR to the linked llist
  * @param   iter        (lliter_f)            FUNC PTR to execute on found data
@@ -194,9 +339,74 @@ void *ll_tail(llist_t *llist);
  */
 int32_t ll_iter(llist_t *llist, lliter_f iter);
 
+/**
+ * @brief Open a snapshot of llist: the nodes from HEAD to TAIL as of now. The
+ * walk takes no lock. ll_enq/ll_push carry on concurrently; nodes removed by
+ * ll_deq/ll_delete/ll_dump are parked (their DATA freed late) until the last
+ * snapshot closes. ll_destroy, ll_splice and ll_split_at wait for snapshots
+ * to close. Every ll_snap_begin() needs a matching ll_snap_end().
+ *
+ * @param   llist       (llist_t *)         PTR to the linked llist
+ * @param   snap        (ll_snap_t *)       PTR to the snapshot to open
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t ll_snap_begin(llist_t *llist, ll_snap_t *snap);
+
+/**
+ * @brief continues SNAP to the next item of the snapshot
+ *
+ * @param   snap        (ll_snap_t *)       PTR to snapshot from ll_snap_begin()
+ *
+ * @returns data        (void *)            PTR to data, NULL at the end or if
+ * Failed.
+ */
+void *ll_snap_next(ll_snap_t *snap);
+
+/**
+ * @brief Close SNAP; the last one out recycles parked nodes.
+ *
+ * @param   snap        (ll_snap_t *)       PTR to snapshot from ll_snap_begin()
+ *
+ * @returns N/A         (void)
+ */
+void ll_snap_end(ll_snap_t *snap);
+
+/**
+ * @brief Point a caller-owned ITER at HEAD of llist. Does not allocate.
+ *
+ * @param   llist       (llist_t *)         PTR to the linked llist
+ * @param   iter        (ll_iter_t *)       PTR to the iterator to initialize
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t ll_iter_init(llist_t *llist, ll_iter_t *iter);
+
+/**
+ * @brief continues ITER to the next item in llist
+ *
+ * @param   iter        (ll_iter_t *)       PTR to iterator from ll_iter_init()
+ *
+ * @returns data        (void *)            PTR to data of the next node, NULL
+ * at the end or if Failed.
+ */
+void *ll_iter_step(ll_iter_t *iter);
+
+/**
+ * @brief Copy up to MAX_OUT data PTRs from ITER into OUT and advance past them.
+ *
+ * @param   iter        (ll_iter_t *)       PTR to iterator from ll_iter_init()
+ * @param   out         (void **)           Caller array of at least MAX_OUT
+ * @param   max_out     (int32_t)           Capacity of OUT
+ *
+ * @returns num_out     (int32_t)           NUM of PTRs copied, 0 at the end,
+ * -1 if Failed.
+ */
+int32_t ll_iter_batch(ll_iter_t *iter, void **out, int32_t max_out);
+
 /**
  * @brief create a linked llist iterable, starting at HEAD. Nondestructive read
- * from llist.
+ * from llist. Heap-allocating wrapper around ll_iter_init().
  *
  * @param   llist       (llist_t *)         PTR to the linked llist
  *
@@ -235,6 +445,65 @@ int32_t ll_iter_size(ll_node_t *node);
  */
 void ll_iter_destroy(ll_node_t **node);
 
+// =============================================================================
+//                        LOCK-FREE MPSC QUEUE FUNCTIONS
+// =============================================================================
+/*
+ * Vyukov-style intrusive queue. Any number of threads may call ll_mpsc_enq()
+ * concurrently; only ONE thread may call ll_mpsc_deq() / ll_mpsc_take_all().
+ * Producers pay a single atomic exchange and never block each other or the
+ * consumer.
+ */
+
+/**
+ * @brief Initialize a lock-free MPSC queue
+ *
+ * @returns queue       (llmpsc_t *)        PTR to queue, NULL if Failed.
+ */
+llmpsc_t *ll_mpsc_create(void);
+
+/**
+ * @brief Put NODE at end of queue. Safe from any number of threads.
+ *
+ * @param   queue       (llmpsc_t *)        PTR to the queue
+ * @param   node        (llmpsc_node_t *)   Caller-owned link to enqueue
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t ll_mpsc_enq(llmpsc_t *queue, llmpsc_node_t *node);
+
+/**
+ * @brief Returns NODE from front of queue. Consumer thread only.
+ *
+ * @param   queue       (llmpsc_t *)        PTR to the queue
+ *
+ * @returns node        (llmpsc_node_t *)   PTR to the oldest link, NULL if
+ * empty or Failed.
+ */
+llmpsc_node_t *ll_mpsc_deq(llmpsc_t *queue);
+
+/**
+ * @brief Take everything enqueued since the last call in one atomic exchange
+ * and hand each NODE, oldest first, to iter(). Consumer thread only.
+ *
+ * @param   queue       (llmpsc_t *)        PTR to the queue
+ * @param   iter        (lliter_f)          FUNC PTR called with each node;
+ * may free the node.
+ *
+ * @returns ll_res      (int64_t)           NUM of nodes taken, -1 if Failed.
+ */
+int64_t ll_mpsc_take_all(llmpsc_t *queue, lliter_f iter);
+
+/**
+ * @brief destroy the queue. Nodes still queued are handed to freenode().
+ *
+ * @param   queue       (llmpsc_t **)       PTR to the PTR of the queue
+ * @param   freenode    (lliter_f)          Func PTR to free NODES with
+ *
+ * @returns N/A         (void)
+ */
+void ll_mpsc_destroy(llmpsc_t **queue, lliter_f freenode);
+
 #endif /* LIB_LLIST_H */
 
 /*** end of file ***/
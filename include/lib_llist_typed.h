@@ -0,0 +1,220 @@
+/** @file lib_llist_typed.h
+ *
+ * @brief Macro-generated, type-specialized LinkedLists. Same queue/stack
+ * semantics as lib_llist, but each element is stored by value inside its
+ * node, comparators and visitors are inlined at the call site, and nothing
+ * is cast through void *.
+ *
+ * LL_DECLARE_TYPED(vert_list, vertex_t) generates:
+ *
+ *      vert_list_t                     the list (zero-initialize to use)
+ *      vert_list_node_t                node holding one vertex_t by value
+ *      vert_list_enq / _deq            queue behavior
+ *      vert_list_push / _pop           stack behavior
+ *      vert_list_head / _tail / _len   nondestructive reads
+ *      vert_list_clear / _destroy      release every node, slab by slab
+ *
+ * LL_DEFINE_TYPED_SEARCH(vert_list, vertex_t, key_t, cmp) adds
+ * vert_list_search(list, key), where cmp is int32_t (*)(const vertex_t *,
+ * key_t) and is inlined into the scan. LL_TYPED_FOREACH walks values in
+ * order with no call per node.
+ *
+ * Nodes come from per-list slabs of LL_TYPED_SLAB nodes, so a list of N
+ * elements costs about N / LL_TYPED_SLAB allocations in total. Typed lists
+ * carry no lock: they are for single-owner data (cf. LL_LOCK_NONE).
+ *
+ */
+
+#ifndef LIB_LLIST_TYPED_H
+#define LIB_LLIST_TYPED_H
+
+#include "lib_llist.h"
+
+#define LL_TYPED_SLAB 64
+
+#define LL_DECLARE_TYPED(NAME, TYPE)                                          \
+    typedef struct NAME##_node_t                                              \
+    {                                                                         \
+        struct NAME##_node_t *next;                                           \
+        TYPE                  value;                                          \
+    } NAME##_node_t;                                                          \
+                                                                              \
+    typedef struct NAME##_slab_t                                              \
+    {                                                                         \
+        struct NAME##_slab_t *next;                                           \
+        int32_t               used;                                           \
+        NAME##_node_t         nodes[LL_TYPED_SLAB];                           \
+    } NAME##_slab_t;                                                          \
+                                                                              \
+    typedef struct NAME##_t                                                   \
+    {                                                                         \
+        int32_t        count;                                                 \
+        NAME##_node_t *head;                                                  \
+        NAME##_node_t *tail;                                                  \
+        NAME##_slab_t *slabs;                                                 \
+        NAME##_node_t *free_nodes;                                            \
+    } NAME##_t;                                                               \
+                                                                              \
+    static inline NAME##_node_t *NAME##_node_alloc(NAME##_t *list)            \
+    {                                                                         \
+        NAME##_node_t *node = list->free_nodes;                               \
+        if (NULL != node)                                                     \
+        {                                                                     \
+            list->free_nodes = node->next;                                    \
+            return node;                                                      \
+        }                                                                     \
+        if ((NULL == list->slabs) || (LL_TYPED_SLAB == list->slabs->used))    \
+        {                                                                     \
+            NAME##_slab_t *slab = malloc(sizeof(*slab));                      \
+            if (NULL == slab)                                                 \
+            {                                                                 \
+                perror(#NAME " allocation");                                  \
+                errno = 0;                                                    \
+                return NULL;                                                  \
+            }                                                                 \
+            slab->used  = 0;                                                  \
+            slab->next  = list->slabs;                                        \
+            list->slabs = slab;                                               \
+        }                                                                     \
+        return &list->slabs->nodes[list->slabs->used++];                      \
+    }                                                                         \
+                                                                              \
+    static inline void NAME##_node_free(NAME##_t *list, NAME##_node_t *node)  \
+    {                                                                         \
+        node->next       = list->free_nodes;                                  \
+        list->free_nodes = node;                                              \
+    }                                                                         \
+                                                                              \
+    static inline int32_t NAME##_enq(NAME##_t *list, TYPE value)              \
+    {                                                                         \
+        NAME##_node_t *node = NAME##_node_alloc(list);                        \
+        if (NULL == node)                                                     \
+        {                                                                     \
+            return RETVAL_FAILURE;                                            \
+        }                                                                     \
+        node->next  = NULL;                                                   \
+        node->value = value;                                                  \
+        if (NULL == list->head)                                               \
+        {                                                                     \
+            list->head = node;                                                \
+        }                                                                     \
+        else                                                                  \
+        {                                                                     \
+            list->tail->next = node;                                          \
+        }                                                                     \
+        list->tail = node;                                                    \
+        ++list->count;                                                        \
+        return RETVAL_SUCCESS;                                                \
+    }                                                                         \
+                                                                              \
+    static inline int32_t NAME##_push(NAME##_t *list, TYPE value)             \
+    {                                                                         \
+        NAME##_node_t *node = NAME##_node_alloc(list);                        \
+        if (NULL == node)                                                     \
+        {                                                                     \
+            return RETVAL_FAILURE;                                            \
+        }                                                                     \
+        node->value = value;                                                  \
+        node->next  = list->head;                                             \
+        list->head  = node;                                                   \
+        if (NULL == node->next)                                               \
+        {                                                                     \
+            list->tail = node;                                                \
+        }                                                                     \
+        ++list->count;                                                        \
+        return RETVAL_SUCCESS;                                                \
+    }                                                                         \
+                                                                              \
+    static inline int32_t NAME##_deq(NAME##_t *list, TYPE *out)               \
+    {                                                                         \
+        NAME##_node_t *node = list->head;                                     \
+        if (NULL == node)                                                     \
+        {                                                                     \
+            return RETVAL_FAILURE;                                            \
+        }                                                                     \
+        if (NULL != out)                                                      \
+        {                                                                     \
+            *out = node->value;                                               \
+        }                                                                     \
+        list->head = node->next;                                              \
+        if (NULL == list->head)                                               \
+        {                                                                     \
+            list->tail = NULL;                                                \
+        }                                                                     \
+        NAME##_node_free(list, node);                                         \
+        --list->count;                                                        \
+        return RETVAL_SUCCESS;                                                \
+    }                                                                         \
+                                                                              \
+    static inline int32_t NAME##_pop(NAME##_t *list, TYPE *out)               \
+    {                                                                         \
+        return NAME##_deq(list, out);                                         \
+    }                                                                         \
+                                                                              \
+    static inline TYPE *NAME##_head(NAME##_t *list)                           \
+    {                                                                         \
+        return list->head ? &list->head->value : NULL;                        \
+    }                                                                         \
+                                                                              \
+    static inline TYPE *NAME##_tail(NAME##_t *list)                           \
+    {                                                                         \
+        return list->tail ? &list->tail->value : NULL;                        \
+    }                                                                         \
+                                                                              \
+    static inline int32_t NAME##_len(NAME##_t *list)                          \
+    {                                                                         \
+        return list->count;                                                   \
+    }                                                                         \
+                                                                              \
+    static inline void NAME##_clear(NAME##_t *list)                           \
+    {                                                                         \
+        NAME##_slab_t *slab = list->slabs;                                    \
+        while (slab)                                                          \
+        {                                                                     \
+            NAME##_slab_t *temp = slab;                                       \
+            slab                = slab->next;                                 \
+            free(temp);                                                       \
+        }                                                                     \
+        list->slabs      = NULL;                                              \
+        list->free_nodes = NULL;                                              \
+        list->head       = NULL;                                              \
+        list->tail       = NULL;                                              \
+        list->count      = 0;                                                 \
+    }                                                                         \
+                                                                              \
+    static inline void NAME##_destroy(NAME##_t *list)                         \
+    {                                                                         \
+        NAME##_clear(list);                                                   \
+    }
+
+/**
+ * @brief Generate NAME##_search(list, key): first value for which
+ * CMP(&value, key) == 0, or NULL. CMP is called directly, so it inlines.
+ */
+#define LL_DEFINE_TYPED_SEARCH(NAME, TYPE, KEYTYPE, CMP)                      \
+    static inline TYPE *NAME##_search(NAME##_t *list, KEYTYPE key)            \
+    {                                                                         \
+        for (NAME##_node_t *node = list->head; node; node = node->next)       \
+        {                                                                     \
+            if (0 == CMP(&node->value, key))                                  \
+            {                                                                 \
+                return &node->value;                                          \
+            }                                                                 \
+        }                                                                     \
+        return NULL;                                                          \
+    }
+
+/**
+ * @brief Walk LIST head to tail with VAR (TYPE *) pointing at each value.
+ *
+ *      vertex_t *vert = NULL;
+ *      LL_TYPED_FOREACH(vert_list, &path, vert) { ... }
+ */
+#define LL_TYPED_FOREACH(NAME, LIST, VAR)                                     \
+    for (NAME##_node_t *VAR##_node = (LIST)->head;                            \
+         (NULL != VAR##_node) && ((VAR = &VAR##_node->value), 1);             \
+         VAR##_node = VAR##_node->next)
+
+#endif /* LIB_LLIST_TYPED_H */
+
+/*** end of file ***/
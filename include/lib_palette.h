@@ -0,0 +1,89 @@
+/** @file lib_palette.h
+ *
+ * @brief Palette Library: redefine a band of the terminal's 256-color palette
+ * with OSC 4, so everything drawn in those indices changes color at once
+ * without redrawing a cell. The band's original colors are asked for first;
+ * a terminal that doesn't answer doesn't get its palette touched, and one
+ * that does gets those colors back on exit.
+ *
+ */
+
+#ifndef LIB_PALETTE_H
+#define LIB_PALETTE_H
+
+#include <poll.h>
+#include <termios.h>
+
+#include "lib_frame.h"
+
+#define PALETTE_SIZE 256
+
+/**
+ * @brief struct palette_t - struct for containing all palette metadata
+ * @param   int32_t             first;      (first index of the band)
+ * @param   int32_t             count;      (indices in the band)
+ * @param   uint32_t            *saved;     (0xRRGGBB the terminal had)
+ * @param   bool                b_saved;    (every SAVED entry was answered)
+ */
+typedef struct palette_t palette_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize a palette band of COUNT indices from FIRST
+ *
+ * @param   first       (int32_t)           First palette index
+ * @param   count       (int32_t)           Indices in the band
+ *
+ * @returns palette     (palette_t *)       PTR to palette, NULL if Failed.
+ */
+palette_t *palette_create(int32_t first, int32_t count);
+
+/**
+ * @brief Ask the controlling terminal for the band's colors (OSC 4 queries,
+ * then Device Attributes, which every terminal answers, as the end marker)
+ * and keep them to restore. Input is neither echoed nor left queued.
+ *
+ * @param   palette     (palette_t *)       PTR to the palette
+ * @param   timeout_ms  (int32_t)           How long to wait for the answer
+ *
+ * @returns 0 if every color was answered, -1 if not (no OSC 4 support, no
+ *          terminal, or too slow).
+ */
+int32_t palette_probe(palette_t *palette, int32_t timeout_ms);
+
+/**
+ * @brief Append one OSC 4 to FRAME that sets the whole band
+ *
+ * @param   palette     (palette_t *)       PTR to the palette
+ * @param   frame       (frame_t *)         PTR to the frame to append to
+ * @param   rgb         (const uint32_t *)  COUNT colors as 0xRRGGBB
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t palette_set(palette_t *palette, frame_t *frame, const uint32_t *rgb);
+
+/**
+ * @brief Append the band's original colors to FRAME: those probed, else an
+ * OSC 104 reset of the band to the terminal's defaults
+ *
+ * @param   palette     (palette_t *)       PTR to the palette
+ * @param   frame       (frame_t *)         PTR to the frame to append to
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t palette_restore(palette_t *palette, frame_t *frame);
+
+/**
+ * @brief Free the palette and set the caller's PTR to NULL
+ *
+ * @param   palette     (palette_t **)      PTR to the palette PTR
+ *
+ * @returns N/A         (void)
+ */
+void palette_destroy(palette_t **palette);
+
+#endif /* LIB_PALETTE_H */
+
+/*** end of file ***/
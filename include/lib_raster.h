@@ -0,0 +1,107 @@
+/** @file lib_raster.h
+ *
+ * @brief Raster Library: draw a grid_t into an RGB framebuffer for offline
+ * rendering (PPM / raw RGB frames). Box-drawing glyphs come from an atlas
+ * baked once at the chosen cell size; rows are split into bands drawn in
+ * parallel, and only rows marked dirty in the grid are redrawn.
+ *
+ */
+
+#ifndef LIB_RASTER_H
+#define LIB_RASTER_H
+
+#include <pthread.h>
+
+#include "lib_grid.h"
+
+#define RASTER_MAX_THREADS 64
+
+/**
+ * @brief raster_fmt_t - frame encoding written by raster_write
+ *
+ * RASTER_PPM       binary PPM (P6) per frame; a stream of them for encoders
+ * RASTER_RAW       bare RGB24, WIDTH * HEIGHT * 3 bytes per frame
+ */
+typedef enum raster_fmt_t
+{
+    RASTER_PPM = 0,
+    RASTER_RAW,
+} raster_fmt_t;
+
+/**
+ * @brief struct raster_t - struct for containing all raster metadata
+ * @param   int32_t             cell_w;
+ * @param   int32_t             cell_h;
+ * @param   int32_t             cols;
+ * @param   int32_t             rows;
+ * @param   uint8_t             *pixels;    (RGB24, row-major)
+ * @param   uint8_t             *atlas;     (glyph masks, CELL_W * CELL_H each)
+ * @param   int32_t             threads;    (workers + the caller)
+ * @param   pthread_mutex_t     mutex;
+ * @param   pthread_cond_t      start;      (new job generation)
+ * @param   pthread_cond_t      done;       (pending reached 0)
+ */
+typedef struct raster_t raster_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize a raster for cells of CELL_W x CELL_H pixels and bake the
+ * glyph atlas. THREADS <= 0 uses one thread per online CPU.
+ *
+ * @param   cell_w      (int32_t)           Cell width in pixels
+ * @param   cell_h      (int32_t)           Cell height in pixels
+ * @param   threads     (int32_t)           Drawing threads, incl. the caller
+ *
+ * @returns raster      (raster_t *)        PTR to raster, NULL if Failed.
+ */
+raster_t *raster_create(int32_t cell_w, int32_t cell_h, int32_t threads);
+
+/**
+ * @brief Redraw the rows of GRID marked dirty (all rows when the grid size
+ * changed). The dirty bitmap is left for the caller to reset.
+ *
+ * @param   raster      (raster_t *)        PTR to the raster
+ * @param   grid        (grid_t *)          PTR to the grid to draw
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t raster_draw(raster_t *raster, grid_t *grid);
+
+/**
+ * @brief Return the framebuffer
+ *
+ * @param   raster      (raster_t *)        PTR to the raster
+ * @param   width       (int32_t *)         OUT: width in pixels
+ * @param   height      (int32_t *)         OUT: height in pixels
+ *
+ * @returns pixels      (const uint8_t *)   RGB24 pixels, NULL if Failed.
+ */
+const uint8_t *raster_pixels(raster_t *raster, int32_t *width,
+                             int32_t *height);
+
+/**
+ * @brief write() the framebuffer to FD as one frame in format FMT
+ *
+ * @param   raster      (raster_t *)        PTR to the raster
+ * @param   fd          (int)               File descriptor
+ * @param   fmt         (raster_fmt_t)      Frame encoding
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t raster_write(raster_t *raster, int fd, raster_fmt_t fmt);
+
+/**
+ * @brief Stop the drawing threads, free the raster and set the caller's PTR
+ * to NULL
+ *
+ * @param   raster      (raster_t **)       PTR to the raster PTR
+ *
+ * @returns N/A         (void)
+ */
+void raster_destroy(raster_t **raster);
+
+#endif /* LIB_RASTER_H */
+
+/*** end of file ***/
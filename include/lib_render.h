@@ -0,0 +1,233 @@
+/** @file lib_render.h
+ *
+ * @brief Render Library: turns grid cells into terminal output. A backend is
+ * a vtable (begin_frame / put_cell / end_frame / resize / leave) picked once
+ * at startup, so the per-cell path never checks what mode it is in.
+ *
+ * truecolor    24-bit SGR color
+ * 256          xterm 256-color palette
+ * 16           ANSI 8 + bright colors
+ * mono         bold only, no color
+ * null         discards everything (benchmarks, headless runs)
+ * record       writes every cell put to a file as render_rec_t records
+ * kitty        shaded pipe sprites, uploaded once and placed per cell with
+ *              the kitty graphics protocol
+ * sixel        the same sprites as cached Sixel images
+ *
+ * The graphics backends keep the sprite wanted and the sprite shown per cell,
+ * and send only the difference, up to a byte budget per frame; whatever is
+ * over the budget is carried to the next frame.
+ *
+ * truecolor and 256 send CELL_PAL cells as their palette index.
+ *
+ */
+
+#ifndef LIB_RENDER_H
+#define LIB_RENDER_H
+
+#include "lib_grid.h"
+#include "lib_sprite.h"
+#include "lib_vector.h"
+
+#define RENDER_CELL_W   8 // sprite size until render_graphics sets it
+#define RENDER_CELL_H   16
+#define RENDER_KITTY_ID 0x5000 // kitty image id of sprite 0
+
+/**
+ * @brief render_kind_t - available backends
+ */
+typedef enum render_kind_t
+{
+    RENDER_TRUECOLOR = 0,
+    RENDER_256,
+    RENDER_16,
+    RENDER_MONO,
+    RENDER_NULL,
+    RENDER_RECORD,
+    RENDER_KITTY,
+    RENDER_SIXEL,
+} render_kind_t;
+
+/**
+ * @brief struct render_rec_t - one record of the record backend. A resize is
+ * recorded with X and Y of -1 and the new size in CELL.GLYPH as
+ * (COLS << 16) | ROWS.
+ * @param   uint32_t            frame;  (frames ended before this one)
+ * @param   int16_t             x;
+ * @param   int16_t             y;
+ * @param   cell_t              cell;
+ */
+typedef struct render_rec_t
+{
+    uint32_t frame;
+    int16_t  x;
+    int16_t  y;
+    cell_t   cell;
+} render_rec_t;
+
+/**
+ * @brief struct render_t - struct for containing all render metadata
+ * @param   const render_ops_t  *ops;
+ * @param   frame_t             *frame;     (target of the current frame)
+ * @param   int32_t             x;          (cursor; -1 if unknown)
+ * @param   int32_t             y;
+ * @param   int32_t             attr;       (SGR in effect; -1 if unknown)
+ * @param   int32_t             color;      (backend's color value; -1 none)
+ * @param   int32_t             cols;       (last column wraps the cursor)
+ * @param   uint32_t            frames;
+ * @param   int                 fd;         (record)
+ * @param   vec_t               *log;       (record: this frame's cells)
+ * @param   sprite_t            *sprite;    (graphics: the sprites)
+ * @param   int32_t             rows;
+ * @param   uint16_t            *want;      (graphics: sprite per cell)
+ * @param   uint16_t            *shown;     (graphics: sprite on screen)
+ * @param   uint64_t            *pending;   (graphics: rows WANT != SHOWN)
+ * @param   size_t              budget;     (graphics: bytes per frame; 0 any)
+ * @param   bool                b_sent;     (kitty: sprites uploaded)
+ * @param   bool                b_left;     (render_leave ran: no more output)
+ */
+typedef struct render_t render_t;
+
+/**
+ * @brief struct render_ops_t - a backend. Output goes to the frame given to
+ * BEGIN_FRAME; RESIZE clears the screen for the new size; LEAVE restores the
+ * terminal on exit.
+ */
+typedef struct render_ops_t
+{
+    const char *name;
+    void (*begin_frame)(render_t *render, frame_t *frame);
+    void (*put_cell)(render_t *render, int32_t x, int32_t y,
+                     const cell_t *cell);
+    void (*end_frame)(render_t *render);
+    void (*resize)(render_t *render, int32_t cols, int32_t rows);
+    void (*leave)(render_t *render);
+} render_ops_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Pick the best terminal backend from COLORTERM and TERM
+ *
+ * @returns kind        (render_kind_t)     truecolor, 256, 16 or mono.
+ */
+render_kind_t render_detect(void);
+
+/**
+ * @brief Look up a backend by the name in the list above
+ *
+ * @param   name        (const char *)      Backend name
+ * @param   kind        (render_kind_t *)   OUT: the backend
+ *
+ * @returns 0 on Success, -1 if there is no such backend.
+ */
+int32_t render_parse(const char *name, render_kind_t *kind);
+
+/**
+ * @brief Initialize a renderer
+ *
+ * @param   kind        (render_kind_t)     Backend
+ * @param   path        (const char *)      Output file for RENDER_RECORD;
+ *                                          ignored otherwise
+ *
+ * @returns render      (render_t *)        PTR to render, NULL if Failed.
+ */
+render_t *render_create(render_kind_t kind, const char *path);
+
+/**
+ * @brief Bake the graphics backends' sprites at CELL_W x CELL_H pixels (the
+ * terminal's cell size; kitty scales them to the cell, Sixel can't) and
+ * limit each frame to BUDGET bytes (0 for no limit). Other backends ignore
+ * it. Call before the first frame.
+ *
+ * @param   render      (render_t *)        PTR to the render
+ * @param   cell_w      (int32_t)           Sprite width in pixels
+ * @param   cell_h      (int32_t)           Sprite height in pixels
+ * @param   budget      (size_t)            Bytes per frame; 0 for no limit
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t render_graphics(render_t *render, int32_t cell_w, int32_t cell_h,
+                        size_t budget);
+
+/**
+ * @brief Start a frame; output is appended to FRAME until render_end_frame
+ *
+ * @param   render      (render_t *)        PTR to the render
+ * @param   frame       (frame_t *)         PTR to the frame to append to
+ *
+ * @returns N/A         (void)
+ */
+void render_begin_frame(render_t *render, frame_t *frame);
+
+/**
+ * @brief Draw CELL at column X, row Y (0-based); an empty cell is erased
+ *
+ * @param   render      (render_t *)        PTR to the render
+ * @param   x           (int32_t)           Column
+ * @param   y           (int32_t)           Row
+ * @param   cell        (const cell_t *)    PTR to the cell
+ *
+ * @returns N/A         (void)
+ */
+void render_put_cell(render_t *render, int32_t x, int32_t y,
+                     const cell_t *cell);
+
+/**
+ * @brief Finish the frame (reset SGR; the record backend writes it out)
+ *
+ * @param   render      (render_t *)        PTR to the render
+ *
+ * @returns N/A         (void)
+ */
+void render_end_frame(render_t *render);
+
+/**
+ * @brief Clear the screen for a COLS x ROWS grid (hides the cursor)
+ *
+ * @param   render      (render_t *)        PTR to the render
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns N/A         (void)
+ */
+void render_resize(render_t *render, int32_t cols, int32_t rows);
+
+/**
+ * @brief Clear the screen and show the cursor again, into FRAME. Cells still
+ * pending are dropped, and from then on drawing, ending a frame and resizing
+ * send nothing.
+ *
+ * @param   render      (render_t *)        PTR to the render
+ * @param   frame       (frame_t *)         PTR to the frame to append to
+ *
+ * @returns N/A         (void)
+ */
+void render_leave(render_t *render, frame_t *frame);
+
+/**
+ * @brief Append a whole frame to FRAME that clears the screen and draws every
+ * non-empty cell of GRID: what a newly attached viewer needs.
+ *
+ * @param   render      (render_t *)        PTR to the render
+ * @param   grid        (grid_t *)          PTR to the grid to draw
+ * @param   frame       (frame_t *)         PTR to the frame to append to
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t render_keyframe(render_t *render, grid_t *grid, frame_t *frame);
+
+/**
+ * @brief Free the render (closing the record file) and set the caller's PTR
+ * to NULL
+ *
+ * @param   render      (render_t **)       PTR to the render PTR
+ *
+ * @returns N/A         (void)
+ */
+void render_destroy(render_t **render);
+
+#endif /* LIB_RENDER_H */
+
+/*** end of file ***/
@@ -0,0 +1,139 @@
+/** @file lib_scene.h
+ *
+ * @brief Scene Library: a software rasterizer for the pipes of a lattice_t,
+ * drawn into terminal cells as half blocks in truecolor ('▀': the foreground
+ * is the upper pixel, the background the lower one). Every piece is drawn
+ * as a round tube or sphere into a z-buffer, keeping the depth and normal of
+ * the nearest surface per pixel; the pixels are lit once all pieces are in.
+ * The screen is cut into tiles and only the tiles a changed piece covers are
+ * redrawn, split across threads, four pixels at a time with SSE2. Only cells
+ * whose pixels changed are sent.
+ *
+ */
+
+#ifndef LIB_SCENE_H
+#define LIB_SCENE_H
+
+#include <pthread.h>
+
+#include "lib_frame.h"
+#include "lib_lattice.h"
+
+#define SCENE_MAX_THREADS 64
+#define SCENE_TILE_W      32 // pixels
+#define SCENE_TILE_H      16
+
+/**
+ * @brief struct scene_t - struct for containing all scene metadata
+ * @param   int32_t             cols;
+ * @param   int32_t             rows;
+ * @param   int32_t             width;      (pixels: COLS)
+ * @param   int32_t             height;     (pixels: ROWS * 2)
+ * @param   float               *depth;     (view depth per pixel)
+ * @param   float               *norm_x;    (normal per pixel; x right,)
+ * @param   float               *norm_y;    (y down,)
+ * @param   float               *norm_z;    (z toward the viewer)
+ * @param   uint32_t            *base;      (unlit 0xRRGGBB per pixel)
+ * @param   uint32_t            *pixels;    (lit 0xRRGGBB per pixel)
+ * @param   uint64_t            *shown;     (per cell: upper and lower pixel
+ *                                          as last encoded)
+ * @param   uint8_t             *dirty;     (per tile)
+ * @param   scene_prim_t        *prims;     (the pieces, projected)
+ * @param   float               view[];     (rotation, then a push back)
+ * @param   float               focal;      (pixels per unit at depth 1)
+ * @param   int32_t             threads;    (workers + the caller)
+ * @param   pthread_mutex_t     mutex;
+ * @param   pthread_cond_t      start;      (new job generation)
+ * @param   pthread_cond_t      done;       (pending reached 0)
+ */
+typedef struct scene_t scene_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize an empty scene. THREADS <= 0 uses one thread per online
+ * CPU.
+ *
+ * @param   threads     (int32_t)           Drawing threads, incl. the caller
+ *
+ * @returns scene       (scene_t *)         PTR to scene, NULL if Failed.
+ */
+scene_t *scene_create(int32_t threads);
+
+/**
+ * @brief Size the scene to COLS x ROWS cells; the next scene_encode clears
+ * the terminal and sends every cell
+ *
+ * @param   scene       (scene_t *)         PTR to the scene
+ * @param   cols        (int32_t)           Width in cells
+ * @param   rows        (int32_t)           Height in cells
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t scene_resize(scene_t *scene, int32_t cols, int32_t rows);
+
+/**
+ * @brief Look at the box from LO to HI, turned YAW radians about the vertical
+ * and tipped PITCH radians toward the viewer, as large as the screen allows
+ *
+ * @param   scene       (scene_t *)         PTR to the scene
+ * @param   yaw         (float)             Turn about y, radians
+ * @param   pitch       (float)             Tilt about x, radians
+ * @param   lo          (const float *)     Least x, y, z of the box
+ * @param   hi          (const float *)     Greatest x, y, z of the box
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t scene_camera(scene_t *scene, float yaw, float pitch, const float *lo,
+                     const float *hi);
+
+/**
+ * @brief Bring the picture up to date with PIECES. Pieces before FIRST are
+ * taken to be as last drawn; all are redrawn after a resize, a camera move,
+ * or when there are fewer than before (the lattice was reset).
+ *
+ * @param   scene       (scene_t *)         PTR to the scene
+ * @param   pieces      (const lattice_piece_t *) PTR to the pieces
+ * @param   count       (size_t)            Number of pieces
+ * @param   first       (size_t)            First piece new or changed
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t scene_draw(scene_t *scene, const lattice_piece_t *pieces, size_t count,
+                   size_t first);
+
+/**
+ * @brief Append the cells that changed since the last call to FRAME
+ *
+ * @param   scene       (scene_t *)         PTR to the scene
+ * @param   frame       (frame_t *)         PTR to the frame to append to
+ *
+ * @returns cells       (int64_t)           Cells sent, -1 if Failed.
+ */
+int64_t scene_encode(scene_t *scene, frame_t *frame);
+
+/**
+ * @brief Return the picture
+ *
+ * @param   scene       (scene_t *)         PTR to the scene
+ * @param   width       (int32_t *)         OUT: width in pixels
+ * @param   height      (int32_t *)         OUT: height in pixels
+ *
+ * @returns pixels      (const uint32_t *)  0xRRGGBB pixels, NULL if Failed.
+ */
+const uint32_t *scene_pixels(scene_t *scene, int32_t *width, int32_t *height);
+
+/**
+ * @brief Stop the drawing threads, free the scene and set the caller's PTR
+ * to NULL
+ *
+ * @param   scene       (scene_t **)        PTR to the scene PTR
+ *
+ * @returns N/A         (void)
+ */
+void scene_destroy(scene_t **scene);
+
+#endif /* LIB_SCENE_H */
+
+/*** end of file ***/
@@ -0,0 +1,158 @@
+/** @file lib_shmgrid.h
+ *
+ * @brief Shared Grid Library: publish a grid_t into a memory-mapped file so
+ * other processes can read the cells in place. Frames are guarded by a
+ * seqlock: readers never lock or copy, they re-read if a write overlapped.
+ * On Linux a path under /dev/shm gives a POSIX shm segment.
+ *
+ */
+
+#ifndef LIB_SHMGRID_H
+#define LIB_SHMGRID_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lib_grid.h"
+
+#define SHMGRID_MAGIC    0x45504950u // "PIPE", little-endian
+#define SHMGRID_VERSION  1u
+#define SHMGRID_MAX_ROWS 1024
+#define SHMGRID_WORDS    (SHMGRID_MAX_ROWS / 64)
+
+/**
+ * @brief struct shmgrid_hdr_t - start of the mapping. Layout is fixed per
+ * SHMGRID_VERSION; cells follow at CELLS_OFF, row-major, COLS per row.
+ *
+ * SEQ is odd while the writer is updating. A reader records an even SEQ,
+ * reads, then re-checks SEQ; if it moved the read is discarded. DIRTY holds
+ * the rows changed by the generation ending at SEQ. A reader that skipped a
+ * generation (SEQ advanced by more than 2) must treat every row as dirty.
+ * If BYTES grows past the reader's mapping the reader has to remap.
+ *
+ * @param   uint32_t            magic;
+ * @param   uint32_t            version;
+ * @param   _Atomic uint64_t    seq;
+ * @param   uint64_t            bytes;      (mapping size)
+ * @param   uint32_t            cells_off;
+ * @param   uint32_t            cell_size;  (sizeof(cell_t))
+ * @param   uint32_t            cols;
+ * @param   uint32_t            rows;
+ * @param   uint32_t            b_live;     (0 once the writer has exited)
+ * @param   uint64_t            dirty[];
+ */
+typedef struct shmgrid_hdr_t
+{
+    uint32_t         magic;
+    uint32_t         version;
+    _Atomic uint64_t seq;
+    uint64_t         bytes;
+    uint32_t         cells_off;
+    uint32_t         cell_size;
+    uint32_t         cols;
+    uint32_t         rows;
+    uint32_t         b_live;
+    uint32_t         reserved;
+    uint64_t         dirty[SHMGRID_WORDS];
+} shmgrid_hdr_t;
+
+/**
+ * @brief struct shmgrid_t - writer-side handle
+ * @param   int                 fd;
+ * @param   char                *path;
+ * @param   shmgrid_hdr_t       *hdr;       (the mapping)
+ * @param   size_t              mapped;
+ */
+typedef struct shmgrid_t shmgrid_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Create (or truncate) the file at PATH and map it for publishing
+ *
+ * @param   path        (const char *)      Filesystem path of the mapping
+ *
+ * @returns shm         (shmgrid_t *)       PTR to shm, NULL if Failed.
+ */
+shmgrid_t *shmgrid_create(const char *path);
+
+/**
+ * @brief Copy the dirty rows of GRID into the mapping as one generation. A
+ * change of dimensions republishes every row, growing the mapping if needed.
+ * The dirty bitmap is left for the caller to reset.
+ *
+ * @param   shm         (shmgrid_t *)       PTR to the shm
+ * @param   grid        (grid_t *)          PTR to the grid to publish
+ *
+ * @returns 0 on Success, -1 if Failed (more than SHMGRID_MAX_ROWS rows, or
+ *          the mapping could not grow).
+ */
+int32_t shmgrid_publish(shmgrid_t *shm, grid_t *grid);
+
+/**
+ * @brief Mark the mapping dead, unmap and unlink it, and set the caller's PTR
+ * to NULL. Readers keep their mapping until they drop it.
+ *
+ * @param   shm         (shmgrid_t **)      PTR to the shm PTR
+ *
+ * @returns N/A         (void)
+ */
+void shmgrid_destroy(shmgrid_t **shm);
+
+// =============================================================================
+//                              READER HELPERS
+// =============================================================================
+/**
+ * @brief Start a read: wait out an in-progress write and return its SEQ
+ *
+ * @param   hdr         (const shmgrid_hdr_t *) PTR to the mapped header
+ *
+ * @returns seq         (uint64_t)              Even generation to pass on.
+ */
+static inline uint64_t
+shmgrid_read_begin (shmgrid_hdr_t *hdr)
+{
+    uint64_t seq = 0;
+    while ((seq = atomic_load_explicit(&hdr->seq, memory_order_acquire)) & 1)
+    {
+        ; // a generation is only a few row copies
+    }
+    return seq;
+}
+
+/**
+ * @brief Finish a read begun at SEQ
+ *
+ * @param   hdr         (const shmgrid_hdr_t *) PTR to the mapped header
+ * @param   seq         (uint64_t)              From shmgrid_read_begin
+ *
+ * @returns b_retry     (int32_t)               1 if the read overlapped a
+ *                                              write and must be repeated.
+ */
+static inline int32_t
+shmgrid_read_retry (shmgrid_hdr_t *hdr, uint64_t seq)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return seq != atomic_load_explicit(&hdr->seq, memory_order_relaxed);
+}
+
+/**
+ * @brief Return row Y of the mapped cells (valid inside a read)
+ *
+ * @param   hdr         (const shmgrid_hdr_t *) PTR to the mapped header
+ * @param   y           (uint32_t)              Row, below HDR->rows
+ *
+ * @returns cells       (const cell_t *)        PTR to HDR->cols cells.
+ */
+static inline const cell_t *
+shmgrid_row (shmgrid_hdr_t *hdr, uint32_t y)
+{
+    return (const cell_t *)((const uint8_t *)hdr + hdr->cells_off)
+           + ((size_t)y * hdr->cols);
+}
+
+#endif /* LIB_SHMGRID_H */
+
+/*** end of file ***/
@@ -0,0 +1,135 @@
+/** @file lib_snap.h
+ *
+ * @brief Snapshot Library: save the grid and the simulation state to a
+ * compact binary file, and restore them by mapping the file and copying the
+ * cells straight in. Files are written aside and renamed into place, so a
+ * reader only ever sees a whole snapshot; anything truncated, corrupt or
+ * from another version is refused.
+ *
+ */
+
+#ifndef LIB_SNAP_H
+#define LIB_SNAP_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lib_grid.h"
+
+#define SNAP_MAGIC     0x504e5350u // "PSNP", little-endian
+#define SNAP_VERSION   1u
+#define SNAP_RNG_BYTES 256 // initstate() buffer; the largest random() state
+
+/**
+ * @brief struct snap_state_t - what resumes the simulation, besides the grid
+ * @param   uint32_t            idx;        (color step of the next segment)
+ * @param   int32_t             persona;    (personality of the pipe)
+ * @param   int32_t             head[5];    (glyph, x, y, dir_x, dir_y of the
+ *                                          last segment drawn)
+ * @param   uint32_t            reserved;
+ * @param   uint8_t             rng[SNAP_RNG_BYTES]; (random() state)
+ */
+typedef struct snap_state_t
+{
+    uint32_t idx;
+    int32_t  persona;
+    int32_t  head[5];
+    uint32_t reserved;
+    uint8_t  rng[SNAP_RNG_BYTES];
+} snap_state_t;
+
+/**
+ * @brief struct snap_hdr_t - start of the file, in native byte order. The
+ * cells follow, row-major, COLS per row. SUM covers everything after it.
+ *
+ * @param   uint32_t            magic;
+ * @param   uint32_t            version;
+ * @param   uint32_t            cell_size;  (sizeof(cell_t))
+ * @param   uint32_t            state_size; (sizeof(snap_state_t))
+ * @param   uint32_t            cols;
+ * @param   uint32_t            rows;
+ * @param   uint64_t            bytes;      (file size)
+ * @param   uint64_t            sum;
+ * @param   snap_state_t        state;
+ */
+typedef struct snap_hdr_t
+{
+    uint32_t     magic;
+    uint32_t     version;
+    uint32_t     cell_size;
+    uint32_t     state_size;
+    uint32_t     cols;
+    uint32_t     rows;
+    uint64_t     bytes;
+    uint64_t     sum;
+    snap_state_t state;
+} snap_hdr_t;
+
+/**
+ * @brief struct snap_t - an open snapshot
+ * @param   snap_hdr_t          *hdr;       (the mapping)
+ * @param   size_t              mapped;
+ */
+typedef struct snap_t snap_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Write GRID and STATE to PATH: to PATH.tmp, synced, then renamed
+ * over PATH
+ *
+ * @param   path        (const char *)      Filesystem path of the snapshot
+ * @param   grid        (grid_t *)          PTR to the grid to save
+ * @param   state       (const snap_state_t *) PTR to the state to save
+ *
+ * @returns 0 on Success, -1 if Failed (PATH is left as it was).
+ */
+int32_t snap_save(const char *path, grid_t *grid, const snap_state_t *state);
+
+/**
+ * @brief Map the snapshot at PATH and check it: size, magic, version,
+ * layout and checksum. A missing file is not an error worth a message.
+ *
+ * @param   path        (const char *)      Filesystem path of the snapshot
+ *
+ * @returns snap        (snap_t *)          PTR to snap, NULL if missing or
+ *                                          refused.
+ */
+snap_t *snap_open(const char *path);
+
+/**
+ * @brief Return the saved state, to vet it before restoring
+ *
+ * @param   snap        (const snap_t *)    PTR to the snap
+ *
+ * @returns state       (const snap_state_t *) PTR into the mapping, NULL if
+ *                                          Failed.
+ */
+const snap_state_t *snap_state(const snap_t *snap);
+
+/**
+ * @brief Copy the snapshot into GRID (every row becomes dirty) and STATE
+ *
+ * @param   snap        (snap_t *)          PTR to the snap
+ * @param   grid        (grid_t *)          PTR to the grid; must be the size
+ *                                          the snapshot was taken at
+ * @param   state       (snap_state_t *)    OUT: the saved state
+ *
+ * @returns 0 on Success, -1 if Failed (sizes differ; nothing is changed).
+ */
+int32_t snap_restore(snap_t *snap, grid_t *grid, snap_state_t *state);
+
+/**
+ * @brief Unmap the snapshot and set its PTR to NULL
+ *
+ * @param   snap        (snap_t **)         PTR to snap PTR
+ *
+ * @returns N/A         (void)
+ */
+void snap_close(snap_t **snap);
+
+#endif /* LIB_SNAP_H */
+
+/*** end of file ***/
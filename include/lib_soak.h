@@ -0,0 +1,102 @@
+/** @file lib_soak.h
+ *
+ * @brief Soak Library: watch RSS, heap in use and the allocation rate over a
+ * long run, and judge whether any of them grows or crosses a ceiling.
+ *
+ * Allocations are counted by the __wrap_* hooks below, which 'make soak'
+ * links in front of malloc, calloc, realloc, aligned_alloc and free
+ * (-Wl,--wrap); other builds leave them out. Only calls from this program's
+ * objects are wrapped: what libc allocates for itself (strdup, getline,
+ * fopen, ...) is not counted. Heap in use comes from mallinfo2(), RSS from
+ * /proc.
+ *
+ */
+
+#ifndef LIB_SOAK_H
+#define LIB_SOAK_H
+
+#include "lib_llist.h"
+
+#define SOAK_BUCKETS   64 // the run is judged in this many slices of time
+#define SOAK_PERIOD_NS 100000000ULL // at most one sample per 0.1s
+#define SOAK_SLACK     (256 * 1024) // growth in bytes that is not a trend
+
+/**
+ * @brief struct soak_t - struct for containing all soak metadata
+ * @param   uint64_t            start;      (ns, CLOCK_MONOTONIC)
+ * @param   uint64_t            end;        (ns; the run is over after)
+ * @param   uint64_t            last;       (ns of the last sample)
+ * @param   size_t              max_bytes;  (ceiling on RSS and heap)
+ * @param   uint64_t            max_rate;   (ceiling on allocs per 1000 steps)
+ * @param   uint64_t            steps;      (since the last sample)
+ * @param   uint64_t            allocs;     (count at the last sample)
+ * @param   uint64_t            cycles;
+ * @param   int32_t             used;       (buckets reached so far)
+ * @param   const char          *breach;    (ceiling crossed; NULL if none)
+ * @param   soak_bucket_t       buckets[SOAK_BUCKETS]; (peak RSS and heap,
+ *                                          allocs and steps per slice)
+ */
+typedef struct soak_t soak_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize a soak run of SECS seconds, starting now
+ *
+ * @param   secs        (int64_t)           Length of the run
+ * @param   max_bytes   (size_t)            Ceiling on RSS and on heap in use
+ * @param   max_rate    (uint64_t)          Ceiling on allocations per 1000
+ *                                          steps, once warmed up
+ *
+ * @returns soak        (soak_t *)          PTR to soak, NULL if Failed.
+ */
+soak_t *soak_create(int64_t secs, size_t max_bytes, uint64_t max_rate);
+
+/**
+ * @brief Account for a finished cycle of STEPS steps, sampling memory and
+ * allocations if a period has gone by
+ *
+ * @param   soak        (soak_t *)          PTR to the soak
+ * @param   steps       (size_t)            Steps taken in the cycle
+ *
+ * @returns 0 to keep going, -1 once the time is up or a ceiling is crossed.
+ */
+int32_t soak_cycle(soak_t *soak, size_t steps);
+
+/**
+ * @brief Write what the run used, start to end, and the verdict: it fails
+ * if a ceiling was crossed, or if RSS, heap or the allocation rate rose
+ * through every quarter of the run after the first.
+ *
+ * @param   soak        (soak_t *)          PTR to the soak
+ * @param   file        (FILE *)            Where the report goes
+ *
+ * @returns 0 if the run passed, -1 if it Failed.
+ */
+int32_t soak_report(soak_t *soak, FILE *file);
+
+/**
+ * @brief Free the soak and set its PTR to NULL
+ *
+ * @param   soak        (soak_t **)         PTR to soak PTR
+ *
+ * @returns N/A         (void)
+ */
+void soak_destroy(soak_t **soak);
+
+#ifdef SOAK
+/**
+ * @brief Counting hooks; -Wl,--wrap=malloc etc. send the calls here, and
+ * they pass them on to the real allocator.
+ */
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void *__wrap_aligned_alloc(size_t align, size_t size);
+void  __wrap_free(void *ptr);
+#endif
+
+#endif /* LIB_SOAK_H */
+
+/*** end of file ***/
@@ -0,0 +1,111 @@
+/** @file lib_sprite.h
+ *
+ * @brief Sprite Library: shaded, tube-like pipe sprites for the graphics
+ * backends, baked once at the cell size: every pipe glyph shape in every
+ * color step of the rainbow, plus the gray of the border. Each sprite's
+ * Sixel encoding is built along with it, so drawing one is a copy.
+ *
+ */
+
+#ifndef LIB_SPRITE_H
+#define LIB_SPRITE_H
+
+#include <math.h>
+
+#include "lib_grid.h"
+
+#define SPRITE_SHAPES 7 // ━ ┃ ┏ ┓ ┗ ┛ ╋
+#define SPRITE_STEPS  32 // rainbow colors
+#define SPRITE_COLORS (SPRITE_STEPS + 1) // and the default foreground
+#define SPRITE_COUNT  (SPRITE_SHAPES * SPRITE_COLORS)
+#define SPRITE_BLANK  SPRITE_COUNT // an empty cell: all background
+#define SPRITE_SHADES 6 // lit levels per color, highlight included
+#define SPRITE_MAX_PX 64 // largest cell side
+
+/**
+ * @brief struct sprite_t - struct for containing all sprite metadata
+ * @param   int32_t             cell_w;
+ * @param   int32_t             cell_h;
+ * @param   uint8_t             *pixels;    (RGBA, CELL_W * CELL_H per sprite,
+ *                                          SPRITE_COUNT + 1 sprites)
+ * @param   frame_t             *sixel;     (every sprite's Sixel, back to back)
+ * @param   size_t              offs[];     (start of each sprite in SIXEL;
+ *                                          the clipped ones follow)
+ * @param   uint32_t            ramp[];     (0xRRGGBB of each color)
+ */
+typedef struct sprite_t sprite_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Bake every sprite at CELL_W x CELL_H pixels
+ *
+ * @param   cell_w      (int32_t)           Cell width in pixels
+ * @param   cell_h      (int32_t)           Cell height in pixels
+ *
+ * @returns sprite      (sprite_t *)        PTR to sprites, NULL if Failed.
+ */
+sprite_t *sprite_create(int32_t cell_w, int32_t cell_h);
+
+/**
+ * @brief Return the sprite that draws CELL: its glyph's shape in the color
+ * step nearest its hue (dimmed colors keep their hue). Empty cells and
+ * glyphs that aren't pipe pieces are SPRITE_BLANK.
+ *
+ * @param   sprite      (const sprite_t *)  PTR to the sprites
+ * @param   cell        (const cell_t *)    PTR to the cell
+ *
+ * @returns index       (int32_t)           0 to SPRITE_BLANK.
+ */
+int32_t sprite_pick(const sprite_t *sprite, const cell_t *cell);
+
+/**
+ * @brief Return the RGBA pixels of sprite INDEX (background transparent)
+ *
+ * @param   sprite      (const sprite_t *)  PTR to the sprites
+ * @param   index       (int32_t)           0 to SPRITE_BLANK
+ *
+ * @returns pixels      (const uint8_t *)   CELL_W * CELL_H * 4, NULL if Failed.
+ */
+const uint8_t *sprite_pixels(const sprite_t *sprite, int32_t index);
+
+/**
+ * @brief Return the Sixel of sprite INDEX: a whole DCS that paints the cell
+ * at the cursor, background included. Sixel paints 6 rows at a time, so
+ * with B_CLIP the rows past the last whole band are dropped instead (for
+ * the bottom row, where anything taller scrolls the screen).
+ *
+ * @param   sprite      (const sprite_t *)  PTR to the sprites
+ * @param   index       (int32_t)           0 to SPRITE_BLANK
+ * @param   b_clip      (int32_t)           Nonzero for whole bands only
+ * @param   len         (size_t *)          OUT: bytes
+ *
+ * @returns bytes       (const uint8_t *)   PTR to the DCS, NULL if Failed.
+ */
+const uint8_t *sprite_sixel(const sprite_t *sprite, int32_t index,
+                            int32_t b_clip, size_t *len);
+
+/**
+ * @brief Return the sprite size
+ *
+ * @param   sprite      (const sprite_t *)  PTR to the sprites
+ * @param   cell_w      (int32_t *)         OUT: width in pixels
+ * @param   cell_h      (int32_t *)         OUT: height in pixels
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t sprite_size(const sprite_t *sprite, int32_t *cell_w, int32_t *cell_h);
+
+/**
+ * @brief Free the sprites and set the caller's PTR to NULL
+ *
+ * @param   sprite      (sprite_t **)       PTR to the sprite PTR
+ *
+ * @returns N/A         (void)
+ */
+void sprite_destroy(sprite_t **sprite);
+
+#endif /* LIB_SPRITE_H */
+
+/*** end of file ***/
@@ -0,0 +1,64 @@
+/** @file lib_trace.h
+ *
+ * @brief Trace Library: timestamped begin/end events per thread, written out
+ * as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev) to see how
+ * each frame's time splits across phases.
+ *
+ * Record with the TRACE_* macros; they only exist in builds with -DTRACE
+ * (make trace) and compile to nothing otherwise. Each thread appends to its
+ * own buffer without locks; trace_close() writes every buffer out.
+ *
+ */
+
+#ifndef LIB_TRACE_H
+#define LIB_TRACE_H
+
+#include "lib_llist.h"
+
+#define TRACE_EVENTS 262144 // per thread; later events are counted, not kept
+
+#ifdef TRACE
+#define TRACE_BEGIN(name) trace_event((name), 'B')
+#define TRACE_END(name)   trace_event((name), 'E')
+#define TRACE_MARK(name)  trace_event((name), 'i')
+#else
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name)   ((void)0)
+#define TRACE_MARK(name)  ((void)0)
+#endif
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Start recording; events are dropped until this is called
+ *
+ * @param   path        (const char *)      File the JSON is written to
+ *
+ * @returns 0 on Success, -1 if Failed (already open).
+ */
+int32_t trace_open(const char *path);
+
+/**
+ * @brief Record an event on the calling thread's buffer. Use the TRACE_*
+ * macros rather than calling this directly.
+ *
+ * @param   name        (const char *)      Event name; must outlive the
+ *                                          trace (a string literal)
+ * @param   phase       (char)              'B' begin, 'E' end, 'i' instant
+ *
+ * @returns N/A         (void)
+ */
+void trace_event(const char *name, char phase);
+
+/**
+ * @brief Stop recording, write every thread's events and free them. Call
+ * once the other threads that recorded have been joined.
+ *
+ * @returns 0 on Success, -1 if Failed (or never opened).
+ */
+int32_t trace_close(void);
+
+#endif /* LIB_TRACE_H */
+
+/*** end of file ***/
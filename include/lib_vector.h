@@ -0,0 +1,167 @@
+/** @file lib_vector.h
+ *
+ * @brief Vector Library for contiguous, append-mostly storage of fixed-size
+ * elements stored inline. Companion to lib_llist; analogous to a C++
+ * std::vector.
+ *
+ */
+
+#ifndef LIB_VECTOR_H
+#define LIB_VECTOR_H
+
+#include "lib_llist.h"
+
+/**
+ * @brief struct vec_t - struct for containing all vector metadata
+ * @param   size_t              stride;     (bytes per element)
+ * @param   size_t              count;
+ * @param   size_t              capacity;
+ * @param   uint8_t             *data;
+ * @param   ll_lock_t           policy;
+ * @param   union               lock;       (sized to POLICY; absent for NONE)
+ */
+typedef struct vec_t vec_t;
+
+/**
+ * @brief struct vec_iter_t - caller-owned (stack) cursor into a vector.
+ * @param   size_t              pos;
+ */
+typedef struct vec_iter_t
+{
+    size_t pos;
+} vec_iter_t;
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+/**
+ * @brief Initialize a vector of STRIDE-byte elements
+ *
+ * @param   stride      (size_t)            Size of one element in bytes
+ * @param   policy      (ll_lock_t)         Synchronization policy
+ *
+ * @returns vec         (vec_t *)           PTR to vector, NULL if Failed.
+ */
+vec_t *vec_create(size_t stride, ll_lock_t policy);
+
+/**
+ * @brief Make room for at least COUNT elements without further growth
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ * @param   count       (size_t)            Total elements to hold
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t vec_reserve(vec_t *vec, size_t count);
+
+/**
+ * @brief Release unused capacity beyond the current length
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t vec_shrink(vec_t *vec);
+
+/**
+ * @brief Copy one ELEM (STRIDE bytes) to the end of the vector. Grows
+ * geometrically.
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ * @param   elem        (const void *)      PTR to the element to copy in
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t vec_append(vec_t *vec, const void *elem);
+
+/**
+ * @brief Copy COUNT contiguous ELEMS to the end of the vector in one step
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ * @param   elems       (const void *)      PTR to COUNT packed elements
+ * @param   count       (size_t)            Number of elements
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t vec_append_n(vec_t *vec, const void *elems, size_t count);
+
+/**
+ * @brief Return PTR to the element at IDX. Valid until the vector grows.
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ * @param   idx         (size_t)            Element index
+ *
+ * @returns elem        (void *)            PTR to element, NULL if Failed.
+ */
+void *vec_at(vec_t *vec, size_t idx);
+
+/**
+ * @brief Return PTR to the last element. Valid until the vector grows.
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ *
+ * @returns elem        (void *)            PTR to element, NULL if Failed.
+ */
+void *vec_tail(vec_t *vec);
+
+/**
+ * @brief print the length of a vector
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ *
+ * @returns vec_len     (int64_t)           LEN of vector, -1 if Failed.
+ */
+int64_t vec_len(vec_t *vec);
+
+/**
+ * @brief Empty the vector, keeping its capacity for reuse
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ * @param   freeelem    (lliter_f)          Func PTR called with each element
+ * PTR first; may be NULL
+ *
+ * @returns del_elems   (int64_t)           Number of elements removed, -1 if
+ * Failed.
+ */
+int64_t vec_clear(vec_t *vec, lliter_f freeelem);
+
+/**
+ * @brief destroy the vector
+ *
+ * @param   vec         (vec_t **)          PTR to the PTR of the vector
+ * @param   freeelem    (lliter_f)          Func PTR called with each element
+ * PTR first; may be NULL
+ *
+ * @returns N/A         (void)
+ */
+void vec_destroy(vec_t **vec, lliter_f freeelem);
+
+/**
+ * @brief Point a caller-owned ITER at the first element. Does not allocate.
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ * @param   iter        (vec_iter_t *)      PTR to the iterator to initialize
+ *
+ * @returns 0 on Success, -1 if Failed.
+ */
+int32_t vec_iter_init(vec_t *vec, vec_iter_t *iter);
+
+/**
+ * @brief Return the next contiguous run of up to MAX_COUNT elements and
+ * advance ITER past it. Walk the run with STRIDE-byte steps (or as a typed
+ * array) without any per-element call.
+ *
+ * @param   vec         (vec_t *)           PTR to the vector
+ * @param   iter        (vec_iter_t *)      PTR to iterator from vec_iter_init()
+ * @param   max_count   (size_t)            Longest run wanted; 0 for no limit
+ * @param   count       (size_t *)          OUT: elements in the returned run
+ *
+ * @returns span        (void *)            PTR to first element of the run,
+ * NULL at the end or if Failed.
+ */
+void *vec_iter_span(vec_t *vec, vec_iter_t *iter, size_t max_count,
+                    size_t *count);
+
+#endif /* LIB_VECTOR_H */
+
+/*** end of file ***/
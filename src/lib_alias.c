@@ -0,0 +1,170 @@
+/** @file lib_alias.c
+ *
+ * @brief Alias Library: Walker alias tables, so a choice among weighted
+ * outcomes costs one random number and one lookup however the weights are
+ * spread.
+ *
+ */
+
+#include "lib_alias.h"
+
+#define ALIAS_ONE ((uint64_t)1 << ALIAS_ROLL_BITS)
+
+struct alias_t
+{
+    int32_t   tables;
+    int32_t   outcomes;
+    uint32_t *keep;
+    uint8_t  *alias;
+};
+
+alias_t *
+alias_create (int32_t tables, int32_t outcomes)
+{
+    alias_t *alias = NULL;
+    if ((tables < 1) || (outcomes < 1) || (outcomes > ALIAS_MAX_OUTCOMES))
+    {
+        goto ALIAS_CREATE_RET;
+    }
+
+    alias = calloc(1, sizeof(*alias));
+    if (NULL == alias)
+    {
+        perror("alias create");
+        errno = 0;
+        goto ALIAS_CREATE_RET;
+    }
+
+    size_t cells = (size_t)tables * (size_t)outcomes;
+    alias->tables   = tables;
+    alias->outcomes = outcomes;
+    alias->keep     = malloc(cells * sizeof(*alias->keep));
+    alias->alias    = malloc(cells * sizeof(*alias->alias));
+    if ((NULL == alias->keep) || (NULL == alias->alias))
+    {
+        perror("alias tables");
+        errno = 0;
+        alias_destroy(&alias);
+        goto ALIAS_CREATE_RET;
+    }
+
+    // every column keeps its own outcome: uniform
+    for (size_t i = 0; i < cells; ++i)
+    {
+        alias->keep[i]  = (uint32_t)(ALIAS_ONE - 1);
+        alias->alias[i] = (uint8_t)(i % (size_t)outcomes);
+    }
+
+ALIAS_CREATE_RET:
+    return alias;
+}
+
+int32_t
+alias_build (alias_t *alias, int32_t table, const double *weights)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == alias) || (NULL == weights) || (table < 0)
+        || (table >= alias->tables))
+    {
+        goto ALIAS_BUILD_RET;
+    }
+
+    int32_t n     = alias->outcomes;
+    double  total = 0.0;
+    for (int32_t i = 0; i < n; ++i)
+    {
+        if (!(weights[i] >= 0.0))
+        {
+            goto ALIAS_BUILD_RET; // negative or NaN
+        }
+        total += weights[i];
+    }
+    if (!(total > 0.0))
+    {
+        goto ALIAS_BUILD_RET;
+    }
+
+    // scaled so the average column holds exactly 1
+    double  scaled[ALIAS_MAX_OUTCOMES];
+    int32_t small[ALIAS_MAX_OUTCOMES];
+    int32_t large[ALIAS_MAX_OUTCOMES];
+    int32_t n_small = 0;
+    int32_t n_large = 0;
+    for (int32_t i = 0; i < n; ++i)
+    {
+        scaled[i] = weights[i] * n / total;
+        if (scaled[i] < 1.0)
+        {
+            small[n_small++] = i;
+        }
+        else
+        {
+            large[n_large++] = i;
+        }
+    }
+
+    uint32_t *keep  = &alias->keep[(size_t)table * (size_t)n];
+    uint8_t  *other = &alias->alias[(size_t)table * (size_t)n];
+
+    // top up each short column from a tall one
+    while ((0 < n_small) && (0 < n_large))
+    {
+        int32_t lo = small[--n_small];
+        int32_t hi = large[n_large - 1];
+
+        keep[lo]  = (uint32_t)(scaled[lo] * (double)ALIAS_ONE);
+        other[lo] = (uint8_t)hi;
+        scaled[hi] -= 1.0 - scaled[lo];
+        if (scaled[hi] < 1.0)
+        {
+            n_large--;
+            small[n_small++] = hi;
+        }
+    }
+
+    // what is left is full up to rounding
+    while (0 < n_large)
+    {
+        int32_t i = large[--n_large];
+        keep[i]   = (uint32_t)(ALIAS_ONE - 1);
+        other[i]  = (uint8_t)i;
+    }
+    while (0 < n_small)
+    {
+        int32_t i = small[--n_small];
+        keep[i]   = (uint32_t)(ALIAS_ONE - 1);
+        other[i]  = (uint8_t)i;
+    }
+    ret_val = RETVAL_SUCCESS;
+
+ALIAS_BUILD_RET:
+    return ret_val;
+}
+
+int32_t
+alias_draw (const alias_t *alias, int32_t table, uint32_t roll)
+{
+    // ROLL * N: the whole part is the column, the fraction the coin
+    uint64_t spread = (uint64_t)roll * (uint64_t)alias->outcomes;
+    size_t   column = (size_t)(spread >> ALIAS_ROLL_BITS);
+    uint32_t coin   = (uint32_t)(spread & (ALIAS_ONE - 1));
+    size_t   at     = ((size_t)table * (size_t)alias->outcomes) + column;
+
+    return (coin < alias->keep[at]) ? (int32_t)column : alias->alias[at];
+}
+
+void
+alias_destroy (alias_t **alias)
+{
+    if ((NULL == alias) || (NULL == *alias))
+    {
+        return;
+    }
+
+    free((*alias)->keep);
+    free((*alias)->alias);
+    free(*alias);
+    *alias = NULL;
+}
+
+/*** end of file ***/
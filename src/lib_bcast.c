@@ -0,0 +1,413 @@
+/** @file lib_bcast.c
+ *
+ * @brief Broadcast Library: fan encoded frames out to any number of viewers
+ * connected over a Unix domain socket. Every viewer is sent the same
+ * refcounted frame, so output is encoded once for N clients. A viewer that
+ * falls behind has its backlog dropped and is resynced with a keyframe
+ * instead of stalling the others.
+ *
+ */
+
+#include "lib_bcast.h"
+
+#include <stdbool.h>
+
+#define BCAST_ATTACH_BUF  65536
+#define BCAST_ATTACH_POLL 100 // ms between checks of *RUNNING
+
+struct bcast_t
+{
+    int      fd;
+    char    *path;
+    size_t   backlog;
+    llist_t *clients;
+};
+
+typedef struct bcast_client_t
+{
+    int      fd;
+    llist_t *queue;  // frame_t, oldest first; single owner, no lock
+    size_t   queued; // bytes in QUEUE not yet written
+    size_t   offset; // bytes of the head frame already written
+    bool     b_resync;
+} bcast_client_t;
+
+static void
+bcast_client_free (void *data)
+{
+    bcast_client_t *client = data;
+    if (NULL == client)
+    {
+        return;
+    }
+
+    ll_destroy(&client->queue, frame_unref);
+    close(client->fd);
+    free(client);
+}
+
+static void
+bcast_accept (bcast_t *bcast)
+{
+    for (;;)
+    {
+        int fd = accept(bcast->fd, NULL, NULL);
+        if (0 > fd)
+        {
+            errno = 0; // EAGAIN: no more pending viewers
+            break;
+        }
+
+        int flags = fcntl(fd, F_GETFL);
+        bcast_client_t *client = calloc(1, sizeof(*client));
+        if ((0 > flags) || (0 > fcntl(fd, F_SETFL, flags | O_NONBLOCK))
+            || (NULL == client))
+        {
+            perror("bcast accept");
+            errno = 0;
+            free(client);
+            close(fd);
+            continue;
+        }
+
+        client->fd       = fd;
+        client->b_resync = true; // starts from a keyframe
+        client->queue    = ll_create_lock(LL_LOCK_NONE);
+        if ((NULL == client->queue)
+            || (RETVAL_SUCCESS != ll_enq(bcast->clients, client)))
+        {
+            bcast_client_free(client);
+        }
+    }
+}
+
+static int32_t
+bcast_enq (bcast_client_t *client, frame_t *frame)
+{
+    int32_t ret_val = RETVAL_SUCCESS;
+    size_t  len     = 0;
+
+    (void)frame_data(frame, &len);
+    if (0 == len)
+    {
+        goto BCAST_ENQ_RET;
+    }
+
+    ret_val = ll_enq(client->queue, frame_ref(frame));
+    if (RETVAL_SUCCESS != ret_val)
+    {
+        frame_unref(frame);
+        goto BCAST_ENQ_RET;
+    }
+    client->queued += len;
+
+BCAST_ENQ_RET:
+    return ret_val;
+}
+
+/*
+ * Drop everything queued except a partly written head frame (the stream
+ * cannot be cut mid-escape-sequence) and mark the client for a keyframe.
+ */
+static void
+bcast_overflow (bcast_client_t *client)
+{
+    frame_t *head = NULL;
+    if (0 < client->offset)
+    {
+        head = ll_deq(client->queue);
+    }
+
+    (void)ll_dump(client->queue, frame_unref);
+    client->queued   = 0;
+    client->b_resync = true;
+
+    if (NULL != head)
+    {
+        size_t len = 0;
+        (void)frame_data(head, &len);
+        client->queued = len - client->offset;
+        (void)ll_enq(client->queue, head);
+    }
+}
+
+/*
+ * Write queued frames until the socket would block. Returns -1 once the
+ * viewer has gone away.
+ */
+static int32_t
+bcast_flush (bcast_client_t *client)
+{
+    int32_t  ret_val = RETVAL_SUCCESS;
+    frame_t *head    = NULL;
+
+    while (NULL != (head = ll_head(client->queue)))
+    {
+        size_t         len  = 0;
+        const uint8_t *data = frame_data(head, &len);
+
+        ssize_t sent = 0;
+        if (client->offset < len)
+        {
+            sent = send(client->fd, data + client->offset,
+                        len - client->offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        }
+
+        if (0 > sent)
+        {
+            if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+            {
+                ret_val = RETVAL_FAILURE;
+            }
+            errno = 0;
+            break;
+        }
+
+        client->offset += (size_t)sent;
+        client->queued -= (size_t)sent;
+        if (client->offset < len)
+        {
+            break;
+        }
+
+        frame_unref(ll_deq(client->queue));
+        client->offset = 0;
+    }
+
+    return ret_val;
+}
+
+bcast_t *
+bcast_create (const char *path, size_t backlog)
+{
+    bcast_t           *bcast = NULL;
+    struct sockaddr_un addr  = { .sun_family = AF_UNIX };
+    struct stat        st;
+
+    if ((NULL == path) || (strlen(path) >= sizeof(addr.sun_path)))
+    {
+        fprintf(stderr, "bcast: bad socket path\n");
+        goto BCAST_CREATE_RET;
+    }
+    strcpy(addr.sun_path, path);
+
+    bcast = calloc(1, sizeof(*bcast));
+    if (NULL == bcast)
+    {
+        perror("bcast create");
+        errno = 0;
+        goto BCAST_CREATE_RET;
+    }
+
+    bcast->fd      = -1;
+    bcast->backlog = backlog ? backlog : BCAST_BACKLOG_DEFAULT;
+    bcast->path    = strdup(path);
+    bcast->clients = ll_create_lock(LL_LOCK_NONE);
+    if ((NULL == bcast->path) || (NULL == bcast->clients))
+    {
+        perror("bcast create");
+        errno = 0;
+        goto BCAST_CREATE_FAIL;
+    }
+
+    // only ever replace a socket, e.g. one left behind by a crash
+    if ((0 == lstat(path, &st)) && S_ISSOCK(st.st_mode))
+    {
+        (void)unlink(path);
+    }
+    errno = 0;
+
+    bcast->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((0 > bcast->fd)
+        || (0 > bind(bcast->fd, (struct sockaddr *)&addr, sizeof(addr)))
+        || (0 > listen(bcast->fd, SOMAXCONN))
+        || (0 > fcntl(bcast->fd, F_SETFL, O_NONBLOCK)))
+    {
+        perror("bcast socket");
+        errno = 0;
+        goto BCAST_CREATE_FAIL;
+    }
+
+    goto BCAST_CREATE_RET;
+
+BCAST_CREATE_FAIL:
+    if (0 <= bcast->fd)
+    {
+        close(bcast->fd);
+    }
+    // empty here, but a NULL freenode makes ll_destroy free nothing at all
+    ll_destroy(&bcast->clients, bcast_client_free);
+    free(bcast->path);
+    free(bcast);
+    bcast = NULL;
+
+BCAST_CREATE_RET:
+    return bcast;
+}
+
+int32_t
+bcast_publish (bcast_t *bcast, frame_t *frame, bcast_key_f keyframe, void *ctx)
+{
+    int32_t  ret_val = RETVAL_FAILURE;
+    frame_t *key     = NULL; // encoded on first demand, shared by all
+
+    if ((NULL == bcast) || (NULL == keyframe))
+    {
+        goto BCAST_PUBLISH_RET;
+    }
+
+    bcast_accept(bcast);
+
+    // rotate through the clients once; dead ones are not re-queued
+    int32_t count = ll_len(bcast->clients);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        bcast_client_t *client = ll_deq(bcast->clients);
+
+        if (client->b_resync)
+        {
+            // frames before the keyframe are moot; wait for the queue to
+            // drain, then send the whole picture
+            if (0 == ll_len(client->queue))
+            {
+                if (NULL == key)
+                {
+                    key = frame_create(0);
+                    if ((NULL != key) && (RETVAL_SUCCESS != keyframe(key, ctx)))
+                    {
+                        frame_unref(key);
+                        key = NULL;
+                    }
+                }
+
+                if ((NULL != key) && (RETVAL_SUCCESS == bcast_enq(client, key)))
+                {
+                    client->b_resync = false;
+                }
+            }
+        }
+        else if (NULL != frame)
+        {
+            (void)bcast_enq(client, frame);
+            if (client->queued > bcast->backlog)
+            {
+                bcast_overflow(client);
+            }
+        }
+
+        if ((RETVAL_SUCCESS != bcast_flush(client))
+            || (RETVAL_SUCCESS != ll_enq(bcast->clients, client)))
+        {
+            bcast_client_free(client);
+        }
+    }
+
+    if (NULL != key)
+    {
+        // a keyframe alone must fit, or the viewer could never catch up
+        size_t len = 0;
+        (void)frame_data(key, &len);
+        if (bcast->backlog < (2 * len))
+        {
+            bcast->backlog = 2 * len;
+        }
+        frame_unref(key);
+    }
+
+    ret_val = ll_len(bcast->clients);
+
+BCAST_PUBLISH_RET:
+    return ret_val;
+}
+
+void
+bcast_destroy (bcast_t **bcast)
+{
+    if ((NULL == bcast) || (NULL == *bcast))
+    {
+        return;
+    }
+
+    ll_destroy(&(*bcast)->clients, bcast_client_free);
+    close((*bcast)->fd);
+    (void)unlink((*bcast)->path);
+    free((*bcast)->path);
+    free(*bcast);
+    *bcast = NULL;
+}
+
+int32_t
+bcast_attach (const char *path, volatile sig_atomic_t *running)
+{
+    int32_t            ret_val = RETVAL_FAILURE;
+    int                fd      = -1;
+    struct sockaddr_un addr    = { .sun_family = AF_UNIX };
+    uint8_t           *buf     = NULL;
+
+    if ((NULL == path) || (NULL == running)
+        || (strlen(path) >= sizeof(addr.sun_path)))
+    {
+        fprintf(stderr, "bcast: bad socket path\n");
+        goto BCAST_ATTACH_RET;
+    }
+    strcpy(addr.sun_path, path);
+
+    buf = malloc(BCAST_ATTACH_BUF);
+    fd  = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((NULL == buf) || (0 > fd)
+        || (0 > connect(fd, (struct sockaddr *)&addr, sizeof(addr))))
+    {
+        perror("bcast attach");
+        errno = 0;
+        goto BCAST_ATTACH_RET;
+    }
+
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    while (*running)
+    {
+        int ready = poll(&pfd, 1, BCAST_ATTACH_POLL);
+        if (0 >= ready)
+        {
+            errno = 0; // timeout or EINTR: recheck *RUNNING
+            continue;
+        }
+
+        ssize_t got = read(fd, buf, BCAST_ATTACH_BUF);
+        if (0 >= got)
+        {
+            if ((0 > got) && (EINTR == errno))
+            {
+                errno = 0;
+                continue;
+            }
+            break; // server closed
+        }
+
+        for (ssize_t off = 0; off < got;)
+        {
+            ssize_t written = write(STDOUT_FILENO, buf + off, got - off);
+            if (0 > written)
+            {
+                if (EINTR == errno)
+                {
+                    errno = 0;
+                    continue;
+                }
+                goto BCAST_ATTACH_RET;
+            }
+            off += written;
+        }
+    }
+
+    ret_val = RETVAL_SUCCESS;
+
+BCAST_ATTACH_RET:
+    if (0 <= fd)
+    {
+        close(fd);
+    }
+    free(buf);
+    return ret_val;
+}
+
+/*** end of file ***/
@@ -0,0 +1,237 @@
+/** @file lib_bitboard.c
+ *
+ * @brief Bitboard Library: which cells of the screen are taken, one bit per
+ * cell, so a pipe can look ahead before it turns. Reachable area is found by
+ * flood filling a whole row of words at a time with shifts and masks.
+ *
+ */
+
+#include "lib_bitboard.h"
+
+#define BITBOARD_WORD_BITS 64
+
+struct bitboard_t
+{
+    int32_t   cols;
+    int32_t   rows;
+    int32_t   words;
+    uint64_t *free;
+    uint64_t *reach;
+};
+
+/*
+ * Open every cell; bits past the last column stay 0 so shifts can't leak
+ * into them.
+ */
+static void
+bitboard_clear (bitboard_t *board)
+{
+    int32_t  tail = board->cols % BITBOARD_WORD_BITS;
+    uint64_t last = (0 == tail) ? UINT64_MAX : (((uint64_t)1 << tail) - 1);
+
+    for (int32_t y = 0; y < board->rows; ++y)
+    {
+        uint64_t *row = &board->free[(size_t)y * (size_t)board->words];
+        memset(row, 0xFF, (size_t)board->words * sizeof(*row));
+        row[board->words - 1] = last;
+    }
+}
+
+bitboard_t *
+bitboard_create (int32_t cols, int32_t rows)
+{
+    bitboard_t *board = calloc(1, sizeof(*board));
+    if (NULL == board)
+    {
+        perror("bitboard create");
+        errno = 0;
+        goto BITBOARD_CREATE_RET;
+    }
+
+    if (RETVAL_SUCCESS != bitboard_resize(board, cols, rows))
+    {
+        free(board);
+        board = NULL;
+    }
+
+BITBOARD_CREATE_RET:
+    return board;
+}
+
+int32_t
+bitboard_resize (bitboard_t *board, int32_t cols, int32_t rows)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == board) || (cols < 1) || (rows < 1))
+    {
+        goto BITBOARD_RESIZE_RET;
+    }
+
+    int32_t words = (cols + BITBOARD_WORD_BITS - 1) / BITBOARD_WORD_BITS;
+    size_t  count = (size_t)words * (size_t)rows;
+
+    if ((cols != board->cols) || (rows != board->rows))
+    {
+        uint64_t *open  = malloc(count * sizeof(*open));
+        uint64_t *reach = malloc(2 * ((size_t)words + 2) * ((size_t)rows + 2)
+                                 * sizeof(*reach));
+        if ((NULL == open) || (NULL == reach))
+        {
+            perror("bitboard resize");
+            errno = 0;
+            free(open);
+            free(reach);
+            goto BITBOARD_RESIZE_RET;
+        }
+
+        free(board->free);
+        free(board->reach);
+        board->free  = open;
+        board->reach = reach;
+        board->cols  = cols;
+        board->rows  = rows;
+        board->words = words;
+    }
+
+    bitboard_clear(board);
+    ret_val = RETVAL_SUCCESS;
+
+BITBOARD_RESIZE_RET:
+    return ret_val;
+}
+
+void
+bitboard_set (bitboard_t *board, int32_t x, int32_t y)
+{
+    if ((NULL == board) || (x < 0) || (y < 0) || (x >= board->cols)
+        || (y >= board->rows))
+    {
+        return;
+    }
+
+    board->free[((size_t)y * (size_t)board->words)
+                + (size_t)(x / BITBOARD_WORD_BITS)]
+        &= ~((uint64_t)1 << (x % BITBOARD_WORD_BITS));
+}
+
+int32_t
+bitboard_open (bitboard_t *board, int32_t x, int32_t y)
+{
+    if ((NULL == board) || (x < 0) || (y < 0) || (x >= board->cols)
+        || (y >= board->rows))
+    {
+        return 0;
+    }
+
+    return (int32_t)((board->free[((size_t)y * (size_t)board->words)
+                                  + (size_t)(x / BITBOARD_WORD_BITS)]
+                      >> (x % BITBOARD_WORD_BITS))
+                     & 1);
+}
+
+int32_t
+bitboard_reach (bitboard_t *board, int32_t x, int32_t y, int32_t steps)
+{
+    int32_t count = RETVAL_FAILURE;
+    if ((NULL == board) || (steps < 0) || (steps > BITBOARD_MAX_STEPS))
+    {
+        goto BITBOARD_REACH_RET;
+    }
+
+    count = 0;
+    if (!bitboard_open(board, x, y))
+    {
+        goto BITBOARD_REACH_RET;
+    }
+
+    // the scratch boards have a zero word on every side: no edge cases
+    size_t    stride = (size_t)board->words + 2;
+    uint64_t *curr   = board->reach;
+    uint64_t *next   = board->reach + (stride * ((size_t)board->rows + 2));
+    size_t    origin = (((size_t)y + 1) * stride) + 1
+                     + (size_t)(x / BITBOARD_WORD_BITS);
+
+    // only the diamond around X, Y can be reached: clear and walk its box
+    int32_t top    = (y - steps < 0) ? 0 : y - steps;
+    int32_t bottom = (y + steps >= board->rows) ? board->rows - 1 : y + steps;
+    int32_t left   = ((x - steps < 0) ? 0 : x - steps) / BITBOARD_WORD_BITS;
+    int32_t right  = ((x + steps >= board->cols) ? board->cols - 1 : x + steps)
+                    / BITBOARD_WORD_BITS;
+
+    for (int32_t r = top - 1; r <= bottom + 1; ++r)
+    {
+        size_t at  = (((size_t)r + 1) * stride) + (size_t)left;
+        size_t len = (size_t)(right - left + 3) * sizeof(*curr);
+        memset(&curr[at], 0, len);
+        memset(&next[at], 0, len);
+    }
+    curr[origin] = (uint64_t)1 << (x % BITBOARD_WORD_BITS);
+
+    int32_t step = 0;
+    for (; step < steps; ++step)
+    {
+        // after STEP steps nothing is further than STEP away
+        int32_t  r_lo  = (y - step - 1 < top) ? top : y - step - 1;
+        int32_t  r_hi  = (y + step + 1 > bottom) ? bottom : y + step + 1;
+        uint64_t grown = 0;
+
+        for (int32_t r = r_lo; r <= r_hi; ++r)
+        {
+            const uint64_t *open = &board->free[(size_t)r
+                                                * (size_t)board->words];
+            const uint64_t *row  = &curr[(((size_t)r + 1) * stride) + 1];
+            uint64_t       *out  = &next[(((size_t)r + 1) * stride) + 1];
+
+            for (int32_t w = left; w <= right; ++w)
+            {
+                // left and right neighbours, carrying across words
+                uint64_t cell = row[w];
+                uint64_t side = (cell << 1) | (cell >> 1)
+                                | (row[w - 1] >> (BITBOARD_WORD_BITS - 1))
+                                | (row[w + 1] << (BITBOARD_WORD_BITS - 1));
+                uint64_t vert = row[w - (int32_t)stride]
+                                | row[w + (int32_t)stride];
+
+                out[w]  = (cell | side | vert) & open[w];
+                grown  |= out[w] ^ cell;
+            }
+        }
+
+        uint64_t *temp = curr;
+        curr           = next;
+        next           = temp;
+
+        if (0 == grown)
+        {
+            break; // the pocket is full
+        }
+    }
+
+    for (int32_t r = top; r <= bottom; ++r)
+    {
+        const uint64_t *row = &curr[(((size_t)r + 1) * stride) + 1];
+        for (int32_t w = left; w <= right; ++w)
+        {
+            count += __builtin_popcountll(row[w]);
+        }
+    }
+
+BITBOARD_REACH_RET:
+    return count;
+}
+
+void
+bitboard_destroy (bitboard_t **board)
+{
+    if ((NULL == board) || (NULL == *board))
+    {
+        return;
+    }
+
+    free((*board)->free);
+    free((*board)->reach);
+    free(*board);
+    *board = NULL;
+}
+
+/*** end of file ***/
@@ -0,0 +1,261 @@
+/** @file lib_density.c
+ *
+ * @brief Density Library: a coarse map of how full each region of the screen
+ * is, so a pipe can turn toward empty space. Cells are counted per tile as
+ * they are drawn, along with the sum of each tile's 3x3 neighbourhood and
+ * running totals per tile column and row, so looking ahead in a direction,
+ * near or as far as the edge, is a read or two. Nothing is ever rebuilt.
+ *
+ */
+
+#include "lib_density.h"
+
+#define DENSITY_TILE_CELLS (DENSITY_TILE_W * DENSITY_TILE_H)
+#define DENSITY_EDGE_DIV   4 // keeps pipes off walls without fencing the edges
+
+struct density_t
+{
+    int32_t   cols;
+    int32_t   rows;
+    int32_t   tcols;
+    int32_t   trows;
+    uint16_t *count;
+    uint16_t *block;
+    uint32_t *col_upto;
+    uint32_t *row_upto;
+};
+
+/*
+ * Start every 3x3 sum with the tiles that lie off the grid, counted full.
+ */
+static void
+density_border (density_t *density)
+{
+    for (int32_t ty = 0; ty < density->trows; ++ty)
+    {
+        for (int32_t tx = 0; tx < density->tcols; ++tx)
+        {
+            int32_t inside_x = 1 + (tx > 0) + (tx < density->tcols - 1);
+            int32_t inside_y = 1 + (ty > 0) + (ty < density->trows - 1);
+
+            density->block[((size_t)ty * (size_t)density->tcols)
+                           + (size_t)tx]
+                = (uint16_t)((9 - (inside_x * inside_y))
+                             * DENSITY_TILE_CELLS);
+        }
+    }
+}
+
+density_t *
+density_create (int32_t cols, int32_t rows)
+{
+    density_t *density = calloc(1, sizeof(*density));
+    if (NULL == density)
+    {
+        perror("density create");
+        errno = 0;
+        goto DENSITY_CREATE_RET;
+    }
+
+    if (RETVAL_SUCCESS != density_resize(density, cols, rows))
+    {
+        free(density);
+        density = NULL;
+    }
+
+DENSITY_CREATE_RET:
+    return density;
+}
+
+int32_t
+density_resize (density_t *density, int32_t cols, int32_t rows)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == density) || (cols < 1) || (rows < 1))
+    {
+        goto DENSITY_RESIZE_RET;
+    }
+
+    int32_t tcols = (cols + DENSITY_TILE_W - 1) / DENSITY_TILE_W;
+    int32_t trows = (rows + DENSITY_TILE_H - 1) / DENSITY_TILE_H;
+    size_t  tiles = (size_t)tcols * (size_t)trows;
+
+    if ((tcols != density->tcols) || (trows != density->trows))
+    {
+        uint16_t *count = calloc(tiles, sizeof(*count));
+        uint16_t *block = calloc(tiles, sizeof(*block));
+        uint32_t *upto  = calloc((size_t)(tcols + trows + 2), sizeof(*upto));
+        if ((NULL == count) || (NULL == block) || (NULL == upto))
+        {
+            perror("density resize");
+            errno = 0;
+            free(count);
+            free(block);
+            free(upto);
+            goto DENSITY_RESIZE_RET;
+        }
+
+        free(density->count);
+        free(density->block);
+        free(density->col_upto);
+        density->count    = count;
+        density->block    = block;
+        density->col_upto = upto;
+        density->row_upto = upto + tcols + 1;
+        density->tcols    = tcols;
+        density->trows    = trows;
+    }
+    else
+    {
+        memset(density->count, 0, tiles * sizeof(*density->count));
+        memset(density->col_upto, 0,
+               (size_t)(tcols + trows + 2) * sizeof(*density->col_upto));
+    }
+
+    density->cols = cols;
+    density->rows = rows;
+    density_border(density);
+    ret_val       = RETVAL_SUCCESS;
+
+DENSITY_RESIZE_RET:
+    return ret_val;
+}
+
+void
+density_add (density_t *density, int32_t x, int32_t y)
+{
+    if ((NULL == density) || (x < 0) || (y < 0) || (x >= density->cols)
+        || (y >= density->rows))
+    {
+        return;
+    }
+
+    int32_t   tx    = x / DENSITY_TILE_W;
+    int32_t   ty    = y / DENSITY_TILE_H;
+    uint16_t *count = &density->count[((size_t)ty * (size_t)density->tcols)
+                                      + (size_t)tx];
+
+    // a full tile stays full, even if a cell is counted twice
+    if (*count >= DENSITY_TILE_CELLS)
+    {
+        return;
+    }
+    (*count)++;
+
+    for (int32_t i = tx + 1; i <= density->tcols; ++i)
+    {
+        density->col_upto[i]++;
+    }
+    for (int32_t i = ty + 1; i <= density->trows; ++i)
+    {
+        density->row_upto[i]++;
+    }
+
+    // every 3x3 sum this tile is part of
+    for (int32_t by = ty - 1; by <= ty + 1; ++by)
+    {
+        for (int32_t bx = tx - 1; bx <= tx + 1; ++bx)
+        {
+            if ((by >= 0) && (by < density->trows) && (bx >= 0)
+                && (bx < density->tcols))
+            {
+                density->block[((size_t)by * (size_t)density->tcols)
+                               + (size_t)bx]++;
+            }
+        }
+    }
+}
+
+int32_t
+density_free (density_t *density, int32_t x, int32_t y, int32_t dir_x,
+              int32_t dir_y)
+{
+    int32_t free_cells = 0;
+    if ((NULL == density) || (x < 0) || (y < 0))
+    {
+        goto DENSITY_FREE_RET;
+    }
+
+    int32_t tx = (x / DENSITY_TILE_W) + (2 * dir_x);
+    int32_t ty = (y / DENSITY_TILE_H) + (2 * dir_y);
+
+    // near an edge, look at the last tiles before it, at a discount
+    int32_t cx = (tx < 0) ? 0 : tx;
+    int32_t cy = (ty < 0) ? 0 : ty;
+    cx         = (cx >= density->tcols) ? density->tcols - 1 : cx;
+    cy         = (cy >= density->trows) ? density->trows - 1 : cy;
+
+    free_cells = (9 * DENSITY_TILE_CELLS)
+                 - density->block[((size_t)cy * (size_t)density->tcols)
+                                  + (size_t)cx];
+    if ((cx != tx) || (cy != ty))
+    {
+        free_cells /= DENSITY_EDGE_DIV;
+    }
+
+DENSITY_FREE_RET:
+    return free_cells;
+}
+
+int32_t
+density_side (density_t *density, int32_t x, int32_t y, int32_t dir_x,
+              int32_t dir_y)
+{
+    int32_t free_cells = 0;
+    if ((NULL == density) || (x < 0) || (y < 0) || (x >= density->cols)
+        || (y >= density->rows))
+    {
+        goto DENSITY_SIDE_RET;
+    }
+
+    int32_t tx = x / DENSITY_TILE_W;
+    int32_t ty = y / DENSITY_TILE_H;
+
+    // whole tile columns or rows beyond this tile, minus what is covered
+    if (0 < dir_x)
+    {
+        int32_t edge = (tx + 1) * DENSITY_TILE_W;
+        free_cells   = ((density->cols > edge) ? density->cols - edge : 0)
+                     * density->rows
+                     - (int32_t)(density->col_upto[density->tcols]
+                                 - density->col_upto[tx + 1]);
+    }
+    else if (0 > dir_x)
+    {
+        free_cells = (tx * DENSITY_TILE_W * density->rows)
+                     - (int32_t)density->col_upto[tx];
+    }
+    else if (0 < dir_y)
+    {
+        int32_t edge = (ty + 1) * DENSITY_TILE_H;
+        free_cells   = ((density->rows > edge) ? density->rows - edge : 0)
+                     * density->cols
+                     - (int32_t)(density->row_upto[density->trows]
+                                 - density->row_upto[ty + 1]);
+    }
+    else if (0 > dir_y)
+    {
+        free_cells = (ty * DENSITY_TILE_H * density->cols)
+                     - (int32_t)density->row_upto[ty];
+    }
+
+DENSITY_SIDE_RET:
+    return (0 < free_cells) ? free_cells : 0;
+}
+
+void
+density_destroy (density_t **density)
+{
+    if ((NULL == density) || (NULL == *density))
+    {
+        return;
+    }
+
+    free((*density)->count);
+    free((*density)->block);
+    free((*density)->col_upto);
+    free(*density);
+    *density = NULL;
+}
+
+/*** end of file ***/
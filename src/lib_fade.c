@@ -0,0 +1,256 @@
+/** @file lib_fade.c
+ *
+ * @brief Fade Library: dims cells of a grid_t a little each frame until they
+ * disappear. Every cell keeps an age byte; the whole age plane is advanced
+ * at once with a SIMD kernel and only cells whose quantized brightness
+ * changed are rewritten in the grid and emitted.
+ *
+ */
+
+#include "lib_fade.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define FADE_LEVEL_SHIFT 4 // level = age >> 4
+#define FADE_LEVEL_MASK  0xF0
+#define FADE_GONE        (FADE_LEVELS - 1)
+
+struct fade_t
+{
+    int32_t  cols;
+    int32_t  rows;
+    uint8_t  step;
+    uint8_t *age;
+    cell_t  *base;
+    uint16_t lut[FADE_LEVELS];
+};
+
+/*
+ * Rewrite cell I for its new brightness level; emit it if its color moved.
+ */
+static int32_t
+fade_apply (fade_t *fade, grid_t *grid, render_t *render, size_t i)
+{
+    int32_t x     = (int32_t)(i % (size_t)fade->cols);
+    int32_t y     = (int32_t)(i / (size_t)fade->cols);
+    int32_t level = fade->age[i] >> FADE_LEVEL_SHIFT;
+    cell_t  cell  = { 0 };
+
+    if (level >= FADE_GONE)
+    {
+        fade->age[i] = FADE_INERT;
+    }
+    else
+    {
+        uint32_t scale = fade->lut[level];
+
+        cell      = fade->base[i];
+        cell.attr = cell.attr | CELL_RGB;
+        if (!(fade->base[i].attr & CELL_RGB))
+        {
+            cell.r = cell.g = cell.b = 255; // default foreground
+        }
+        cell.r = (uint8_t)((cell.r * scale) >> 8);
+        cell.g = (uint8_t)((cell.g * scale) >> 8);
+        cell.b = (uint8_t)((cell.b * scale) >> 8);
+    }
+
+    // dark colors can quantize to the same value at neighbouring levels
+    const cell_t *curr = grid_get(grid, x, y);
+    if ((NULL == curr) || (0 == memcmp(curr, &cell, sizeof(cell))))
+    {
+        return 0;
+    }
+
+    grid_set(grid, x, y, &cell);
+    if (NULL != render)
+    {
+        render_put_cell(render, x, y, &cell);
+    }
+
+    return 1;
+}
+
+fade_t *
+fade_create (int32_t cols, int32_t rows, int32_t frames)
+{
+    fade_t *fade = NULL;
+    if (frames < 1)
+    {
+        goto FADE_CREATE_RET;
+    }
+
+    fade = calloc(1, sizeof(*fade));
+    if (NULL == fade)
+    {
+        perror("fade create");
+        errno = 0;
+        goto FADE_CREATE_RET;
+    }
+
+    // reach the last level (age 240) in about FRAMES steps
+    int32_t step = ((FADE_GONE << FADE_LEVEL_SHIFT) + frames - 1) / frames;
+    fade->step   = (uint8_t)((step < 1) ? 1 : step);
+
+    // quadratic falloff looks even to the eye; the last level is black
+    for (int32_t level = 0; level < FADE_LEVELS; ++level)
+    {
+        int32_t left     = FADE_GONE - level;
+        fade->lut[level] = (uint16_t)((256 * left * left)
+                                      / (FADE_GONE * FADE_GONE));
+    }
+
+    if (RETVAL_SUCCESS != fade_resize(fade, cols, rows))
+    {
+        free(fade);
+        fade = NULL;
+    }
+
+FADE_CREATE_RET:
+    return fade;
+}
+
+int32_t
+fade_resize (fade_t *fade, int32_t cols, int32_t rows)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == fade) || (cols < 1) || (rows < 1))
+    {
+        goto FADE_RESIZE_RET;
+    }
+
+    size_t   count = (size_t)cols * (size_t)rows;
+    uint8_t *age   = fade->age;
+    cell_t  *base  = fade->base;
+
+    if ((cols != fade->cols) || (rows != fade->rows))
+    {
+        age  = malloc(count);
+        base = calloc(count, sizeof(*base));
+        if ((NULL == age) || (NULL == base))
+        {
+            perror("fade resize");
+            errno = 0;
+            free(age);
+            free(base);
+            goto FADE_RESIZE_RET;
+        }
+
+        free(fade->age);
+        free(fade->base);
+        fade->age  = age;
+        fade->base = base;
+        fade->cols = cols;
+        fade->rows = rows;
+    }
+
+    memset(fade->age, FADE_INERT, count);
+    ret_val = RETVAL_SUCCESS;
+
+FADE_RESIZE_RET:
+    return ret_val;
+}
+
+int32_t
+fade_touch (fade_t *fade, grid_t *grid, int32_t x, int32_t y)
+{
+    int32_t       ret_val = RETVAL_FAILURE;
+    const cell_t *cell    = grid_get(grid, x, y);
+
+    if ((NULL == fade) || (NULL == cell) || (x >= fade->cols)
+        || (y >= fade->rows))
+    {
+        goto FADE_TOUCH_RET;
+    }
+
+    size_t i      = ((size_t)y * (size_t)fade->cols) + (size_t)x;
+    fade->age[i]  = 0;
+    fade->base[i] = *cell;
+    ret_val       = RETVAL_SUCCESS;
+
+FADE_TOUCH_RET:
+    return ret_val;
+}
+
+int32_t
+fade_step (fade_t *fade, grid_t *grid, render_t *render)
+{
+    int32_t count = RETVAL_FAILURE;
+    int32_t cols  = 0;
+    int32_t rows  = 0;
+
+    if ((NULL == fade) || (RETVAL_SUCCESS != grid_size(grid, &cols, &rows))
+        || (cols != fade->cols) || (rows != fade->rows))
+    {
+        goto FADE_STEP_RET;
+    }
+
+    count    = 0;
+    size_t n = (size_t)cols * (size_t)rows;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // 16 cells per iteration; the saturating add parks idle cells at 255
+    const __m128i step = _mm_set1_epi8((char)fade->step);
+    const __m128i high = _mm_set1_epi8((char)FADE_LEVEL_MASK);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; (i + 16) <= n; i += 16)
+    {
+        __m128i old_age = _mm_loadu_si128((const __m128i *)(fade->age + i));
+        __m128i new_age = _mm_adds_epu8(old_age, step);
+        _mm_storeu_si128((__m128i *)(fade->age + i), new_age);
+
+        // lanes whose level bits changed
+        __m128i  moved = _mm_and_si128(_mm_xor_si128(old_age, new_age), high);
+        uint32_t mask  = 0xFFFFu
+                        ^ (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(moved,
+                                                                     zero));
+        while (0 != mask)
+        {
+            count += fade_apply(fade, grid, render,
+                                i + (size_t)__builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // scalar fallback, and the tail of the SIMD loop
+    for (; i < n; ++i)
+    {
+        uint8_t old_age = fade->age[i];
+        if (FADE_INERT == old_age)
+        {
+            continue;
+        }
+
+        uint32_t sum     = (uint32_t)old_age + fade->step;
+        uint8_t  new_age = (sum > FADE_INERT) ? FADE_INERT : (uint8_t)sum;
+        fade->age[i]     = new_age;
+        if ((old_age ^ new_age) & FADE_LEVEL_MASK)
+        {
+            count += fade_apply(fade, grid, render, i);
+        }
+    }
+
+FADE_STEP_RET:
+    return count;
+}
+
+void
+fade_destroy (fade_t **fade)
+{
+    if ((NULL == fade) || (NULL == *fade))
+    {
+        return;
+    }
+
+    free((*fade)->age);
+    free((*fade)->base);
+    free(*fade);
+    *fade = NULL;
+}
+
+/*** end of file ***/
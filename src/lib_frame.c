@@ -0,0 +1,276 @@
+/** @file lib_frame.c
+ *
+ * @brief Frame Library: growable byte buffers holding encoded terminal output
+ * (escape sequences + UTF-8 glyphs). Frames are refcounted so one encoding
+ * can be queued to several outputs at once.
+ *
+ */
+
+#include "lib_frame.h"
+
+#define FRAME_MIN_CAP 256
+
+struct frame_t
+{
+    uint8_t        *data;
+    size_t          len;
+    size_t          cap;
+    _Atomic int32_t refs;
+};
+
+/*
+ * Make room for NEED more bytes, doubling the capacity.
+ */
+static int32_t
+frame_grow (frame_t *frame, size_t need)
+{
+    int32_t ret_val = RETVAL_SUCCESS;
+
+    if ((frame->len + need) <= frame->cap)
+    {
+        goto FRAME_GROW_RET;
+    }
+
+    size_t cap = frame->cap ? frame->cap : FRAME_MIN_CAP;
+    while (cap < (frame->len + need))
+    {
+        cap *= 2;
+    }
+
+    uint8_t *data = realloc(frame->data, cap);
+    if (NULL == data)
+    {
+        perror("frame allocation");
+        errno   = 0;
+        ret_val = RETVAL_FAILURE;
+        goto FRAME_GROW_RET;
+    }
+    frame->data = data;
+    frame->cap  = cap;
+
+FRAME_GROW_RET:
+    return ret_val;
+}
+
+frame_t *
+frame_create (size_t cap)
+{
+    frame_t *frame = calloc(1, sizeof(*frame));
+    if (NULL == frame)
+    {
+        perror("frame create");
+        errno = 0;
+        goto FRAME_CREATE_RET;
+    }
+
+    atomic_init(&frame->refs, 1);
+    if (RETVAL_SUCCESS != frame_grow(frame, cap))
+    {
+        free(frame);
+        frame = NULL;
+    }
+
+FRAME_CREATE_RET:
+    return frame;
+}
+
+int32_t
+frame_put (frame_t *frame, const void *bytes, size_t len)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == frame) || (NULL == bytes))
+    {
+        goto FRAME_PUT_RET;
+    }
+
+    if (RETVAL_SUCCESS == frame_grow(frame, len))
+    {
+        memcpy(frame->data + frame->len, bytes, len);
+        frame->len += len;
+        ret_val = RETVAL_SUCCESS;
+    }
+
+FRAME_PUT_RET:
+    return ret_val;
+}
+
+int32_t
+frame_printf (frame_t *frame, const char *fmt, ...)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    va_list args;
+
+    if ((NULL == frame) || (NULL == fmt))
+    {
+        goto FRAME_PRINTF_RET;
+    }
+
+    // escape sequences are short; one pass nearly always suffices
+    for (int32_t pass = 0; pass < 2; pass++)
+    {
+        size_t room = frame->cap - frame->len;
+
+        va_start(args, fmt);
+        int written = vsnprintf((char *)frame->data + frame->len, room, fmt,
+                                args);
+        va_end(args);
+
+        if (0 > written)
+        {
+            goto FRAME_PRINTF_RET;
+        }
+
+        if ((size_t)written < room)
+        {
+            frame->len += (size_t)written;
+            ret_val = RETVAL_SUCCESS;
+            break;
+        }
+
+        if (RETVAL_SUCCESS != frame_grow(frame, (size_t)written + 1))
+        {
+            goto FRAME_PRINTF_RET;
+        }
+    }
+
+FRAME_PRINTF_RET:
+    return ret_val;
+}
+
+int32_t
+frame_putnum (frame_t *frame, uint32_t value)
+{
+    char   digits[10];
+    size_t len = sizeof(digits);
+
+    do
+    {
+        digits[--len] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (0 != value);
+
+    return frame_put(frame, digits + len, sizeof(digits) - len);
+}
+
+int32_t
+frame_putwc (frame_t *frame, uint32_t glyph)
+{
+    uint8_t utf8[4];
+    size_t  len = 0;
+
+    if (glyph < 0x80)
+    {
+        utf8[len++] = (uint8_t)glyph;
+    }
+    else if (glyph < 0x800)
+    {
+        utf8[len++] = (uint8_t)(0xC0 | (glyph >> 6));
+        utf8[len++] = (uint8_t)(0x80 | (glyph & 0x3F));
+    }
+    else if (glyph < 0x10000)
+    {
+        utf8[len++] = (uint8_t)(0xE0 | (glyph >> 12));
+        utf8[len++] = (uint8_t)(0x80 | ((glyph >> 6) & 0x3F));
+        utf8[len++] = (uint8_t)(0x80 | (glyph & 0x3F));
+    }
+    else
+    {
+        utf8[len++] = (uint8_t)(0xF0 | (glyph >> 18));
+        utf8[len++] = (uint8_t)(0x80 | ((glyph >> 12) & 0x3F));
+        utf8[len++] = (uint8_t)(0x80 | ((glyph >> 6) & 0x3F));
+        utf8[len++] = (uint8_t)(0x80 | (glyph & 0x3F));
+    }
+
+    return frame_put(frame, utf8, len);
+}
+
+void
+frame_reset (frame_t *frame)
+{
+    if (NULL != frame)
+    {
+        frame->len = 0;
+    }
+}
+
+const uint8_t *
+frame_data (frame_t *frame, size_t *len)
+{
+    const uint8_t *data = NULL;
+    if ((NULL == frame) || (NULL == len))
+    {
+        goto FRAME_DATA_RET;
+    }
+
+    data = frame->data;
+    *len = frame->len;
+
+FRAME_DATA_RET:
+    return data;
+}
+
+frame_t *
+frame_ref (frame_t *frame)
+{
+    if (NULL != frame)
+    {
+        atomic_fetch_add_explicit(&frame->refs, 1, memory_order_relaxed);
+    }
+    return frame;
+}
+
+int32_t
+frame_shared (frame_t *frame)
+{
+    return (NULL != frame)
+           && (1 < atomic_load_explicit(&frame->refs, memory_order_acquire));
+}
+
+void
+frame_unref (void *frame)
+{
+    frame_t *temp = frame;
+    if (NULL == temp)
+    {
+        return;
+    }
+
+    if (1 == atomic_fetch_sub_explicit(&temp->refs, 1, memory_order_acq_rel))
+    {
+        free(temp->data);
+        free(temp);
+    }
+}
+
+int32_t
+frame_write (frame_t *frame, int fd)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if (NULL == frame)
+    {
+        goto FRAME_WRITE_RET;
+    }
+
+    size_t off = 0;
+    while (off < frame->len)
+    {
+        ssize_t written = write(fd, frame->data + off, frame->len - off);
+        if (0 > written)
+        {
+            if (EINTR == errno)
+            {
+                errno = 0;
+                continue;
+            }
+            goto FRAME_WRITE_RET;
+        }
+        off += (size_t)written;
+    }
+
+    ret_val = RETVAL_SUCCESS;
+
+FRAME_WRITE_RET:
+    return ret_val;
+}
+
+/*** end of file ***/
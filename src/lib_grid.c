@@ -0,0 +1,317 @@
+/** @file lib_grid.c
+ *
+ * @brief Grid Library: the terminal screen as a 2D array of cells, so the
+ * current picture can be re-encoded from scratch (keyframes) at any time.
+ *
+ */
+
+#include "lib_grid.h"
+
+struct grid_t
+{
+    int32_t cols;
+    int32_t   rows;
+    cell_t   *cells;
+    uint64_t *dirty;
+    size_t    dirty_words;
+};
+
+#define GRID_WORD_BITS 64
+
+/*
+ * Emit only the SGR needed to go from style CURR to the style of CELL.
+ */
+static int32_t
+grid_encode_style (frame_t *frame, cell_t *curr, const cell_t *cell)
+{
+    int32_t ret_val = RETVAL_SUCCESS;
+
+    int32_t b_same_rgb = (curr->r == cell->r) && (curr->g == cell->g)
+                         && (curr->b == cell->b);
+    if ((curr->attr == cell->attr)
+        && (!(cell->attr & CELL_RGB) || b_same_rgb))
+    {
+        goto GRID_ENCODE_STYLE_RET;
+    }
+
+    // dropping an attribute needs a full reset
+    if ((curr->attr & ~cell->attr) != 0)
+    {
+        ret_val |= frame_printf(frame, "\033[0m");
+        *curr = (cell_t){ 0 };
+    }
+
+    if ((cell->attr & CELL_BOLD) && !(curr->attr & CELL_BOLD))
+    {
+        ret_val |= frame_printf(frame, "\033[1m");
+    }
+
+    if ((cell->attr & CELL_RGB) && (!(curr->attr & CELL_RGB) || !b_same_rgb))
+    {
+        // "\033[38;2;%d;%d;%dm", without printf: this runs once per cell
+        ret_val |= frame_put(frame, "\033[38;2;", 7);
+        ret_val |= frame_putnum(frame, cell->r);
+        ret_val |= frame_put(frame, ";", 1);
+        ret_val |= frame_putnum(frame, cell->g);
+        ret_val |= frame_put(frame, ";", 1);
+        ret_val |= frame_putnum(frame, cell->b);
+        ret_val |= frame_put(frame, "m", 1);
+    }
+
+    curr->attr = cell->attr;
+    curr->r    = cell->r;
+    curr->g    = cell->g;
+    curr->b    = cell->b;
+
+GRID_ENCODE_STYLE_RET:
+    return ret_val;
+}
+
+grid_t *
+grid_create (int32_t cols, int32_t rows)
+{
+    grid_t *grid = calloc(1, sizeof(*grid));
+    if (NULL == grid)
+    {
+        perror("grid create");
+        errno = 0;
+        goto GRID_CREATE_RET;
+    }
+
+    if (RETVAL_SUCCESS != grid_resize(grid, cols, rows))
+    {
+        free(grid);
+        grid = NULL;
+    }
+
+GRID_CREATE_RET:
+    return grid;
+}
+
+int32_t
+grid_resize (grid_t *grid, int32_t cols, int32_t rows)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == grid) || (cols < 1) || (rows < 1))
+    {
+        goto GRID_RESIZE_RET;
+    }
+
+    if ((cols == grid->cols) && (rows == grid->rows))
+    {
+        grid_clear(grid);
+        ret_val = RETVAL_SUCCESS;
+        goto GRID_RESIZE_RET;
+    }
+
+    size_t    words = ((size_t)rows + GRID_WORD_BITS - 1) / GRID_WORD_BITS;
+    cell_t   *cells = calloc((size_t)cols * (size_t)rows, sizeof(*cells));
+    uint64_t *dirty = calloc(words, sizeof(*dirty));
+    if ((NULL == cells) || (NULL == dirty))
+    {
+        perror("grid resize");
+        errno = 0;
+        free(cells);
+        free(dirty);
+        goto GRID_RESIZE_RET;
+    }
+
+    free(grid->cells);
+    free(grid->dirty);
+    grid->cells       = cells;
+    grid->dirty       = dirty;
+    grid->dirty_words = words;
+    grid->cols        = cols;
+    grid->rows        = rows;
+    grid_clear(grid); // marks every row dirty
+    ret_val = RETVAL_SUCCESS;
+
+GRID_RESIZE_RET:
+    return ret_val;
+}
+
+void
+grid_clear (grid_t *grid)
+{
+    if ((NULL != grid) && (NULL != grid->cells))
+    {
+        memset(grid->cells, 0,
+               (size_t)grid->cols * (size_t)grid->rows * sizeof(cell_t));
+        memset(grid->dirty, 0xFF, grid->dirty_words * sizeof(uint64_t));
+    }
+}
+
+int32_t
+grid_set (grid_t *grid, int32_t x, int32_t y, const cell_t *cell)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == grid) || (NULL == cell))
+    {
+        goto GRID_SET_RET;
+    }
+
+    if ((x < 0) || (y < 0) || (x >= grid->cols) || (y >= grid->rows))
+    {
+        goto GRID_SET_RET;
+    }
+
+    grid->cells[((size_t)y * (size_t)grid->cols) + (size_t)x] = *cell;
+    grid->dirty[y / GRID_WORD_BITS] |= (uint64_t)1 << (y % GRID_WORD_BITS);
+    ret_val = RETVAL_SUCCESS;
+
+GRID_SET_RET:
+    return ret_val;
+}
+
+int32_t
+grid_load (grid_t *grid, const cell_t *cells)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == grid) || (NULL == grid->cells) || (NULL == cells))
+    {
+        goto GRID_LOAD_RET;
+    }
+
+    memcpy(grid->cells, cells,
+           (size_t)grid->cols * (size_t)grid->rows * sizeof(cell_t));
+    memset(grid->dirty, 0xFF, grid->dirty_words * sizeof(uint64_t));
+    ret_val = RETVAL_SUCCESS;
+
+GRID_LOAD_RET:
+    return ret_val;
+}
+
+const cell_t *
+grid_get (grid_t *grid, int32_t x, int32_t y)
+{
+    const cell_t *cell = NULL;
+    if ((NULL == grid) || (x < 0) || (y < 0) || (x >= grid->cols)
+        || (y >= grid->rows))
+    {
+        goto GRID_GET_RET;
+    }
+
+    cell = &grid->cells[((size_t)y * (size_t)grid->cols) + (size_t)x];
+
+GRID_GET_RET:
+    return cell;
+}
+
+int32_t
+grid_size (grid_t *grid, int32_t *cols, int32_t *rows)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == grid) || (NULL == cols) || (NULL == rows))
+    {
+        goto GRID_SIZE_RET;
+    }
+
+    *cols   = grid->cols;
+    *rows   = grid->rows;
+    ret_val = RETVAL_SUCCESS;
+
+GRID_SIZE_RET:
+    return ret_val;
+}
+
+const uint64_t *
+grid_dirty (grid_t *grid, size_t *words)
+{
+    const uint64_t *dirty = NULL;
+    if ((NULL == grid) || (NULL == words))
+    {
+        goto GRID_DIRTY_RET;
+    }
+
+    dirty  = grid->dirty;
+    *words = grid->dirty_words;
+
+GRID_DIRTY_RET:
+    return dirty;
+}
+
+int32_t
+grid_dirty_rows (grid_t *grid)
+{
+    int32_t count = RETVAL_FAILURE;
+    if ((NULL == grid) || (NULL == grid->dirty))
+    {
+        goto GRID_DIRTY_ROWS_RET;
+    }
+
+    count = 0;
+    for (size_t w = 0; w < grid->dirty_words; ++w)
+    {
+        count += __builtin_popcountll(grid->dirty[w]);
+    }
+
+GRID_DIRTY_ROWS_RET:
+    return count;
+}
+
+void
+grid_dirty_reset (grid_t *grid)
+{
+    if ((NULL != grid) && (NULL != grid->dirty))
+    {
+        memset(grid->dirty, 0, grid->dirty_words * sizeof(uint64_t));
+    }
+}
+
+int32_t
+grid_encode_lines (grid_t *grid, frame_t *frame, int32_t b_style)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == grid) || (NULL == frame))
+    {
+        goto GRID_ENCODE_LINES_RET;
+    }
+
+    ret_val = RETVAL_SUCCESS;
+    for (int32_t y = 0; y < grid->rows; ++y)
+    {
+        const cell_t *row   = &grid->cells[(size_t)y * (size_t)grid->cols];
+        cell_t        style = { 0 };
+
+        for (int32_t x = 0; x < grid->cols; ++x)
+        {
+            if (0 == row[x].glyph)
+            {
+                ret_val |= frame_put(frame, " ", 1);
+                continue;
+            }
+
+            if (b_style)
+            {
+                ret_val |= grid_encode_style(frame, &style, &row[x]);
+            }
+            ret_val |= frame_putwc(frame, row[x].glyph);
+        }
+
+        // each line stands alone, e.g. for diffing
+        if (0 != style.attr)
+        {
+            ret_val |= frame_printf(frame, "\033[0m");
+        }
+        ret_val |= frame_put(frame, "\n", 1);
+    }
+
+GRID_ENCODE_LINES_RET:
+    return ret_val;
+}
+
+void
+grid_destroy (grid_t **grid)
+{
+    if ((NULL == grid) || (NULL == *grid))
+    {
+        return;
+    }
+
+    free((*grid)->cells);
+    free((*grid)->dirty);
+    free(*grid);
+    *grid = NULL;
+}
+
+/*** end of file ***/
@@ -0,0 +1,368 @@
+/** @file lib_lattice.c
+ *
+ * @brief Lattice Library: pipes growing through a 3D lattice of cells, one
+ * cell a step, in any of six directions and never through a taken cell. The
+ * pipes are kept as pieces to draw: a tube per straight run, grown in place
+ * while the run goes on, and a joint sphere at every turn.
+ *
+ */
+
+#include "lib_lattice.h"
+
+#include <stdbool.h>
+
+#define LATTICE_TURN     4 // 1 in this many steps turns, when it may go on
+#define LATTICE_RUN_MIN  40 // steps a pipe runs before it ends on its own
+#define LATTICE_RUN_MORE 120 // plus up to this many
+#define LATTICE_TRIES    64 // random cells tried for the start of a pipe
+
+struct lattice_t
+{
+    int32_t  size[3];
+    uint8_t *taken;
+    vec_t   *pieces;
+    int32_t  head[3];
+    int32_t  dir;
+    int32_t  left;
+    int32_t  pipes;
+    int64_t  filled;
+    uint32_t rgb;
+    bool     b_run;
+};
+
+static const int32_t g_dirs[LATTICE_DIRS][3] = {
+    { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 },
+    { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+};
+
+// enamel colors, as the screensaver had them
+static const uint32_t g_colors[] = {
+    0xE03030, 0x30C040, 0x3060E0, 0xE0C030,
+    0x30C0C0, 0xC040C0, 0xE08030, 0xC0C0C0,
+};
+#define LATTICE_COLORS (int32_t)(sizeof(g_colors) / sizeof(g_colors[0]))
+
+/*
+ * Index of cell X, Y, Z in TAKEN, or -1 outside the lattice.
+ */
+static int64_t
+lattice_index (const lattice_t *lattice, const int32_t *cell)
+{
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        if ((0 > cell[i]) || (lattice->size[i] <= cell[i]))
+        {
+            return -1;
+        }
+    }
+
+    return ((((int64_t)cell[2] * lattice->size[1]) + cell[1])
+            * lattice->size[0])
+           + cell[0];
+}
+
+/*
+ * Whether the cell one step from the head in direction DIR is free.
+ */
+static bool
+lattice_free (const lattice_t *lattice, int32_t dir)
+{
+    int32_t cell[3] = { lattice->head[0] + g_dirs[dir][0],
+                        lattice->head[1] + g_dirs[dir][1],
+                        lattice->head[2] + g_dirs[dir][2] };
+    int64_t index   = lattice_index(lattice, cell);
+
+    return (0 <= index) && (0 == lattice->taken[index]);
+}
+
+static void
+lattice_center (const int32_t *cell, float *point)
+{
+    point[0] = (float)cell[0];
+    point[1] = (float)cell[1];
+    point[2] = (float)cell[2];
+}
+
+/*
+ * Start a pipe at a random free cell, heading a random way, in a color the
+ * last pipe didn't have. Its first piece is a tube of no length (a ball) that
+ * the first straight step stretches.
+ */
+static int32_t
+lattice_start (lattice_t *lattice)
+{
+    for (int32_t i = 0; i < LATTICE_TRIES; ++i)
+    {
+        int32_t cell[3] = { rand() % lattice->size[0],
+                            rand() % lattice->size[1],
+                            rand() % lattice->size[2] };
+        int64_t index   = lattice_index(lattice, cell);
+        if (0 != lattice->taken[index])
+        {
+            continue;
+        }
+
+        int32_t color = rand() % (LATTICE_COLORS - 1);
+        if (g_colors[color] == lattice->rgb)
+        {
+            color = LATTICE_COLORS - 1; // the one the draw above skips
+        }
+
+        lattice_piece_t piece = { .radius = LATTICE_TUBE,
+                                  .rgb    = g_colors[color] };
+        lattice_center(cell, piece.a);
+        lattice_center(cell, piece.b);
+        if (RETVAL_SUCCESS != vec_append(lattice->pieces, &piece))
+        {
+            return RETVAL_FAILURE;
+        }
+
+        memcpy(lattice->head, cell, sizeof(cell));
+        lattice->taken[index] = 1;
+        lattice->filled++;
+        lattice->dir   = rand() % LATTICE_DIRS;
+        lattice->left  = LATTICE_RUN_MIN + (rand() % LATTICE_RUN_MORE);
+        lattice->rgb   = piece.rgb;
+        lattice->b_run = true;
+        lattice->pipes++;
+        return RETVAL_SUCCESS;
+    }
+
+    return RETVAL_FAILURE; // too full to find a spot
+}
+
+/*
+ * The new heading: straight on unless blocked or a turn is rolled, then any
+ * free way off to the side. -1 when boxed in.
+ */
+static int32_t
+lattice_turn (const lattice_t *lattice)
+{
+    bool    b_ahead = lattice_free(lattice, lattice->dir);
+    int32_t sides[LATTICE_DIRS];
+    int32_t count   = 0;
+
+    if (b_ahead && (0 != (rand() % LATTICE_TURN)))
+    {
+        return lattice->dir;
+    }
+
+    for (int32_t dir = 0; dir < LATTICE_DIRS; ++dir)
+    {
+        // not ahead, and not back the way it came
+        if (((dir >> 1) != (lattice->dir >> 1)) && lattice_free(lattice, dir))
+        {
+            sides[count++] = dir;
+        }
+    }
+
+    if (0 < count)
+    {
+        return sides[rand() % count];
+    }
+
+    return b_ahead ? lattice->dir : -1;
+}
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+
+lattice_t *
+lattice_create (int32_t nx, int32_t ny, int32_t nz)
+{
+    lattice_t *lattice = calloc(1, sizeof(*lattice));
+    if (NULL == lattice)
+    {
+        perror("lattice create");
+        errno = 0;
+        goto LATTICE_CREATE_RET;
+    }
+
+    lattice->dir    = -1;
+    lattice->pieces = vec_create(sizeof(lattice_piece_t), LL_LOCK_NONE);
+    if ((NULL == lattice->pieces)
+        || (RETVAL_SUCCESS != lattice_resize(lattice, nx, ny, nz)))
+    {
+        lattice_destroy(&lattice);
+    }
+
+LATTICE_CREATE_RET:
+    return lattice;
+}
+
+int32_t
+lattice_resize (lattice_t *lattice, int32_t nx, int32_t ny, int32_t nz)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == lattice) || (nx < 2) || (ny < 2) || (nz < 2))
+    {
+        goto LATTICE_RESIZE_RET;
+    }
+
+    if ((nx != lattice->size[0]) || (ny != lattice->size[1])
+        || (nz != lattice->size[2]))
+    {
+        uint8_t *taken = malloc((size_t)nx * (size_t)ny * (size_t)nz);
+        if (NULL == taken)
+        {
+            perror("lattice resize");
+            errno = 0;
+            goto LATTICE_RESIZE_RET;
+        }
+
+        free(lattice->taken);
+        lattice->taken   = taken;
+        lattice->size[0] = nx;
+        lattice->size[1] = ny;
+        lattice->size[2] = nz;
+    }
+
+    lattice_reset(lattice);
+    ret_val = RETVAL_SUCCESS;
+
+LATTICE_RESIZE_RET:
+    return ret_val;
+}
+
+int32_t
+lattice_fit (lattice_t *lattice, int32_t width, int32_t height)
+{
+    int32_t ny = height / LATTICE_CELL_PX;
+    int32_t nx = width / LATTICE_CELL_PX;
+    ny         = (ny < LATTICE_MIN) ? LATTICE_MIN : ny;
+    nx         = (nx < LATTICE_MIN) ? LATTICE_MIN : nx;
+
+    return lattice_resize(lattice, nx, ny, ny);
+}
+
+void
+lattice_reset (lattice_t *lattice)
+{
+    if ((NULL == lattice) || (NULL == lattice->taken))
+    {
+        return;
+    }
+
+    memset(lattice->taken, 0,
+           (size_t)lattice->size[0] * (size_t)lattice->size[1]
+               * (size_t)lattice->size[2]);
+    vec_clear(lattice->pieces, NULL); // keep the capacity for the next cycle
+    lattice->dir    = -1;
+    lattice->pipes  = 0;
+    lattice->filled = 0;
+    lattice->b_run  = false;
+}
+
+int32_t
+lattice_step (lattice_t *lattice, size_t *first)
+{
+    if ((NULL == lattice) || (NULL == first) || (NULL == lattice->taken))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    *first = (size_t)vec_len(lattice->pieces);
+
+    if (0 > lattice->dir)
+    {
+        int64_t cells = (int64_t)lattice->size[0] * lattice->size[1]
+                        * lattice->size[2];
+        if ((LATTICE_PIPES <= lattice->pipes)
+            || ((lattice->filled * 100) >= (cells * LATTICE_FILL)))
+        {
+            return RETVAL_FAILURE; // the cycle is over
+        }
+
+        return lattice_start(lattice);
+    }
+
+    int32_t dir = lattice_turn(lattice);
+    if ((0 > dir) || (0 >= lattice->left--))
+    {
+        lattice->dir   = -1; // boxed in, or long enough
+        lattice->b_run = false;
+        return RETVAL_SUCCESS;
+    }
+
+    int32_t cell[3] = { lattice->head[0] + g_dirs[dir][0],
+                        lattice->head[1] + g_dirs[dir][1],
+                        lattice->head[2] + g_dirs[dir][2] };
+
+    if ((dir == lattice->dir) && lattice->b_run)
+    {
+        // a straight step stretches the run's tube
+        lattice_piece_t *run = vec_tail(lattice->pieces);
+        lattice_center(cell, run->b);
+        *first -= 1;
+    }
+    else
+    {
+        lattice_piece_t joint = { .radius = LATTICE_JOINT,
+                                  .rgb    = lattice->rgb };
+        lattice_piece_t tube  = { .radius = LATTICE_TUBE,
+                                  .rgb    = lattice->rgb };
+        lattice_center(lattice->head, joint.a);
+        lattice_center(lattice->head, joint.b);
+        lattice_center(lattice->head, tube.a);
+        lattice_center(cell, tube.b);
+        if ((RETVAL_SUCCESS != vec_append(lattice->pieces, &joint))
+            || (RETVAL_SUCCESS != vec_append(lattice->pieces, &tube)))
+        {
+            return RETVAL_FAILURE;
+        }
+        lattice->b_run = true;
+    }
+
+    lattice->taken[lattice_index(lattice, cell)] = 1;
+    lattice->filled++;
+    memcpy(lattice->head, cell, sizeof(cell));
+    lattice->dir = dir;
+
+    return RETVAL_SUCCESS;
+}
+
+const lattice_piece_t *
+lattice_pieces (lattice_t *lattice, size_t *count)
+{
+    if ((NULL == lattice) || (NULL == count))
+    {
+        return NULL;
+    }
+
+    *count = (size_t)vec_len(lattice->pieces);
+    return (0 < *count) ? vec_at(lattice->pieces, 0) : NULL;
+}
+
+int32_t
+lattice_bounds (const lattice_t *lattice, float *lo, float *hi)
+{
+    if ((NULL == lattice) || (NULL == lo) || (NULL == hi))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        lo[i] = -LATTICE_JOINT;
+        hi[i] = (float)(lattice->size[i] - 1) + LATTICE_JOINT;
+    }
+
+    return RETVAL_SUCCESS;
+}
+
+void
+lattice_destroy (lattice_t **lattice)
+{
+    if ((NULL == lattice) || (NULL == *lattice))
+    {
+        return;
+    }
+
+    vec_destroy(&(*lattice)->pieces, NULL);
+    free((*lattice)->taken);
+    free(*lattice);
+    *lattice = NULL;
+}
+
+/*** end of file ***/
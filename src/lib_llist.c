@@ -7,39 +7,625 @@
 
 #include "lib_llist.h"
 
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+
 struct ll_node_t
 {
     struct ll_node_t *next;
     void             *data;
 };
 
+/*
+ * Nodes are carved out of slabs that grow geometrically from LL_SLAB_MIN to
+ * LL_SLAB_MAX nodes. Released nodes go on the pool's free chain; slabs
+ * themselves are only returned to malloc on dump/destroy.
+ *
+ * A pool normally belongs to one list. ll_split_at/ll_take_all hand nodes to
+ * a new list without copying, so both lists then share (and refcount) the
+ * pool, and pool access takes the pool's own spin flag until only one list
+ * is left.
+ */
+#define LL_SLAB_MIN 16
+#define LL_SLAB_MAX 4096
+
+typedef struct ll_slab_t
+{
+    struct ll_slab_t *next;
+    int32_t           capacity;
+    int32_t           used;
+    ll_node_t         nodes[];
+} ll_slab_t;
+
+typedef struct ll_pool_t
+{
+    _Atomic int32_t refs; // lists drawing from this pool
+    atomic_flag     lock; // only taken while refs > 1
+    ll_slab_t      *slabs;      // newest first
+    ll_node_t      *free_nodes; // released nodes, linked through ->next
+} ll_pool_t;
+
+/*
+ * Optional key index: open addressing, linear probing, backward-shift delete.
+ * Each slot remembers its node's list position (SEQ) so duplicate keys still
+ * resolve to the first occurrence, exactly like the linear scan.
+ */
+#define LL_INDEX_MIN 16
+
+typedef struct ll_hslot_t
+{
+    ll_node_t *node;
+    uint64_t   hash;
+    int64_t    seq;
+} ll_hslot_t;
+
+typedef struct ll_index_t
+{
+    llkey_f     getkey;
+    llhash_f    hashkey;
+    ll_hslot_t *slots;
+    uint32_t    mask;
+    uint32_t    used;
+    int64_t     seq_head; // next SEQ handed out by ll_push (decreasing)
+    int64_t     seq_tail; // next SEQ handed out by ll_enq (increasing)
+} ll_index_t;
+
+/*
+ * Snapshot readers (ll_snap_begin) walk the list without its lock. While any
+ * are open, removed nodes are parked here untouched, with the DATA free
+ * callback they are owed, and only recycled when the last reader leaves.
+ * Appends and pushes never modify existing nodes, so they need no deferral.
+ */
+typedef struct ll_limbo_t
+{
+    ll_node_t *node;
+    lliter_f   freenode; // NULL if DATA went back to the caller
+} ll_limbo_t;
+
 struct llist_t
 {
-    int32_t         count;
-    ll_node_t      *head;
-    ll_node_t      *tail;
-    pthread_mutex_t lock;
+    int32_t    count;
+    ll_lock_t  policy;
+    ll_node_t *head;
+    ll_node_t *tail;
+    ll_pool_t  *pool;
+    ll_index_t *index; // NULL unless ll_index_create()
+    int32_t     readers;
+    int32_t     limbo_count;
+    int32_t     limbo_cap;
+    ll_limbo_t *limbo;
+    union
+    {
+        pthread_mutex_t    mutex;
+        pthread_spinlock_t spin;
+    } lock; // must stay last; only the member for POLICY is allocated
 };
 
+#define LL_CACHELINE 64
+
+struct llmpsc_t
+{
+    _Alignas(LL_CACHELINE) llmpsc_node_t *_Atomic tail;
+    _Alignas(LL_CACHELINE) llmpsc_node_t stub;
+    llmpsc_node_t                       *cache;
+};
+
+/*
+ * Lock dispatch. LL_LOCK_NONE lists compile down to a predictable branch and
+ * never touch a lock word.
+ */
+static inline void
+ll_lock (llist_t *llist)
+{
+    switch (llist->policy)
+    {
+        case LL_LOCK_MUTEX:
+            pthread_mutex_lock(&llist->lock.mutex);
+            break;
+
+        case LL_LOCK_SPIN:
+            pthread_spin_lock(&llist->lock.spin);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static inline void
+ll_unlock (llist_t *llist)
+{
+    switch (llist->policy)
+    {
+        case LL_LOCK_MUTEX:
+            pthread_mutex_unlock(&llist->lock.mutex);
+            break;
+
+        case LL_LOCK_SPIN:
+            pthread_spin_unlock(&llist->lock.spin);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * Pool helpers; callers hold the list lock.
+ */
+static bool
+ll_pool_lock (ll_pool_t *pool)
+{
+    bool b_shared = (1 < atomic_load_explicit(&pool->refs, memory_order_acquire));
+
+    while (b_shared
+           && atomic_flag_test_and_set_explicit(&pool->lock,
+                                                memory_order_acquire))
+    {
+        sched_yield();
+    }
+
+    return b_shared;
+}
+
+static inline void
+ll_pool_unlock (ll_pool_t *pool, bool b_shared)
+{
+    if (b_shared)
+    {
+        atomic_flag_clear_explicit(&pool->lock, memory_order_release);
+    }
+}
+
+static ll_node_t *
+ll_node_alloc (llist_t *llist)
+{
+    ll_pool_t *pool     = llist->pool;
+    bool       b_shared = ll_pool_lock(pool);
+    ll_node_t *node     = pool->free_nodes;
+
+    if (NULL != node)
+    {
+        pool->free_nodes = node->next;
+        goto LL_NODE_ALLOC_RET;
+    }
+
+    ll_slab_t *slab = pool->slabs;
+    if ((NULL == slab) || (slab->used == slab->capacity))
+    {
+        int32_t capacity = LL_SLAB_MIN;
+        if (NULL != slab)
+        {
+            capacity = (slab->capacity < LL_SLAB_MAX) ? (slab->capacity * 2)
+                                                      : LL_SLAB_MAX;
+        }
+
+        slab = malloc(sizeof(*slab) + ((size_t)capacity * sizeof(ll_node_t)));
+        if (NULL == slab)
+        {
+            goto LL_NODE_ALLOC_RET;
+        }
+        slab->capacity = capacity;
+        slab->used     = 0;
+        slab->next     = pool->slabs;
+        pool->slabs    = slab;
+    }
+
+    node = &slab->nodes[slab->used++];
+
+LL_NODE_ALLOC_RET:
+    ll_pool_unlock(pool, b_shared);
+    return node;
+}
+
+static inline void
+ll_node_free (llist_t *llist, ll_node_t *node)
+{
+    ll_pool_t *pool     = llist->pool;
+    bool       b_shared = ll_pool_lock(pool);
+
+    node->next       = pool->free_nodes;
+    pool->free_nodes = node;
+
+    ll_pool_unlock(pool, b_shared);
+}
+
+static void
+ll_pool_release (ll_pool_t *pool)
+{
+    ll_slab_t *slab = pool->slabs;
+    ll_slab_t *temp = NULL;
+
+    while (slab)
+    {
+        temp = slab;
+        slab = slab->next;
+        free(temp);
+    }
+
+    pool->slabs      = NULL;
+    pool->free_nodes = NULL;
+}
+
+/*
+ * Give back every node of LLIST. A sole owner drops whole slabs in
+ * O(slabs); a shared pool gets the chain spliced onto its free list.
+ */
+static void
+ll_pool_reclaim (llist_t *llist)
+{
+    ll_pool_t *pool = llist->pool;
+
+    if (1 == atomic_load_explicit(&pool->refs, memory_order_acquire))
+    {
+        ll_pool_release(pool);
+    }
+    else if (NULL != llist->head)
+    {
+        bool b_shared = ll_pool_lock(pool);
+        llist->tail->next = pool->free_nodes;
+        pool->free_nodes  = llist->head;
+        ll_pool_unlock(pool, b_shared);
+    }
+}
+
+/*
+ * Move every slab and free node of SRC (sole owner) into DST.
+ */
+static void
+ll_pool_merge (ll_pool_t *dst, ll_pool_t *src)
+{
+    ll_slab_t *slab_tail = src->slabs;
+    ll_node_t *free_tail = src->free_nodes;
+
+    if (NULL == slab_tail)
+    {
+        return;
+    }
+
+    while (slab_tail->next)
+    {
+        slab_tail = slab_tail->next;
+    }
+    while (free_tail && free_tail->next)
+    {
+        free_tail = free_tail->next;
+    }
+
+    bool b_shared = ll_pool_lock(dst);
+
+    // keep DST's partially used slab at the front for bump allocation
+    if (NULL == dst->slabs)
+    {
+        dst->slabs = src->slabs;
+    }
+    else
+    {
+        slab_tail->next  = dst->slabs->next;
+        dst->slabs->next = src->slabs;
+    }
+
+    if (NULL != free_tail)
+    {
+        free_tail->next  = dst->free_nodes;
+        dst->free_nodes  = src->free_nodes;
+    }
+
+    ll_pool_unlock(dst, b_shared);
+
+    src->slabs      = NULL;
+    src->free_nodes = NULL;
+}
+
+/*
+ * Snapshot helpers; callers hold the list lock.
+ */
+static void
+ll_retire (llist_t *llist, ll_node_t *node, lliter_f freenode)
+{
+    if (0 == llist->readers)
+    {
+        if ((NULL != freenode) && (NULL != node->data))
+        {
+            freenode(node->data);
+        }
+        ll_node_free(llist, node);
+        return;
+    }
+
+    if (llist->limbo_count == llist->limbo_cap)
+    {
+        int32_t     cap   = llist->limbo_cap ? (llist->limbo_cap * 2) : 64;
+        ll_limbo_t *limbo = realloc(llist->limbo, (size_t)cap * sizeof(*limbo));
+        if (NULL == limbo)
+        {
+            // a reader may still be on NODE; leaking it is the safe option
+            perror("ll_retire limbo");
+            errno = 0;
+            return;
+        }
+        llist->limbo     = limbo;
+        llist->limbo_cap = cap;
+    }
+
+    llist->limbo[llist->limbo_count].node     = node;
+    llist->limbo[llist->limbo_count].freenode = freenode;
+    ++llist->limbo_count;
+}
+
+static void
+ll_limbo_drain (llist_t *llist)
+{
+    for (int32_t idx = 0; idx < llist->limbo_count; idx++)
+    {
+        ll_limbo_t *entry = &llist->limbo[idx];
+        if ((NULL != entry->freenode) && (NULL != entry->node->data))
+        {
+            entry->freenode(entry->node->data);
+        }
+        ll_node_free(llist, entry->node);
+    }
+    llist->limbo_count = 0;
+}
+
+/*
+ * Structural changes (destroy, splice, split) relink nodes a reader may be
+ * standing on, so they wait for open snapshots to close.
+ */
+static void
+ll_wait_readers (llist_t *llist)
+{
+    while (0 != llist->readers)
+    {
+        ll_unlock(llist);
+        sched_yield();
+        ll_lock(llist);
+    }
+}
+
+/*
+ * Index helpers; callers hold the list lock.
+ */
+static void
+ll_index_place (ll_index_t *index, ll_node_t *node, uint64_t hash, int64_t seq)
+{
+    uint32_t pos = (uint32_t)hash & index->mask;
+    while (NULL != index->slots[pos].node)
+    {
+        pos = (pos + 1) & index->mask;
+    }
+
+    index->slots[pos].node = node;
+    index->slots[pos].hash = hash;
+    index->slots[pos].seq  = seq;
+    ++index->used;
+}
+
+/*
+ * Make room for EXTRA more entries up front, so that many inserts after it
+ * cannot fail.
+ */
+static int32_t
+ll_index_grow (ll_index_t *index, uint32_t extra)
+{
+    int32_t  ret_val  = RETVAL_SUCCESS;
+    uint32_t capacity = index->mask + 1;
+    uint64_t wanted   = (uint64_t)index->used + extra;
+    uint64_t grown    = capacity;
+
+    // keep the load factor at or under 3/4
+    while ((wanted * 4) > (grown * 3))
+    {
+        grown *= 2;
+    }
+    if (grown == capacity)
+    {
+        goto LL_INDEX_GROW_RET;
+    }
+
+    ll_hslot_t *slots = (grown > UINT32_MAX)
+                            ? NULL
+                            : calloc((size_t)grown, sizeof(*slots));
+    if (NULL == slots)
+    {
+        perror("ll_index grow");
+        errno   = 0;
+        ret_val = RETVAL_FAILURE;
+        goto LL_INDEX_GROW_RET;
+    }
+
+    ll_hslot_t *old = index->slots;
+    index->slots    = slots;
+    index->mask     = (uint32_t)grown - 1;
+    index->used     = 0;
+
+    for (uint32_t pos = 0; pos < capacity; pos++)
+    {
+        if (NULL != old[pos].node)
+        {
+            ll_index_place(index, old[pos].node, old[pos].hash, old[pos].seq);
+        }
+    }
+    free(old);
+
+LL_INDEX_GROW_RET:
+    return ret_val;
+}
+
+static int32_t
+ll_index_insert (llist_t *llist, ll_node_t *node, bool b_front)
+{
+    int32_t     ret_val = RETVAL_SUCCESS;
+    ll_index_t *index   = llist->index;
+
+    if (NULL == index)
+    {
+        goto LL_INDEX_INSERT_RET;
+    }
+
+    ret_val = ll_index_grow(index, 1);
+    if (RETVAL_SUCCESS != ret_val)
+    {
+        goto LL_INDEX_INSERT_RET;
+    }
+
+    int64_t seq = b_front ? index->seq_head-- : index->seq_tail++;
+    ll_index_place(index, node, index->hashkey(index->getkey(node->data)), seq);
+
+LL_INDEX_INSERT_RET:
+    return ret_val;
+}
+
+static void
+ll_index_remove (llist_t *llist, ll_node_t *node)
+{
+    ll_index_t *index = llist->index;
+    if (NULL == index)
+    {
+        return;
+    }
+
+    uint64_t hash = index->hashkey(index->getkey(node->data));
+    uint32_t pos  = (uint32_t)hash & index->mask;
+    while (index->slots[pos].node != node)
+    {
+        if (NULL == index->slots[pos].node)
+        {
+            return;
+        }
+        pos = (pos + 1) & index->mask;
+    }
+
+    // backward-shift: pull later entries of the probe run into the hole
+    uint32_t next = pos;
+    for (;;)
+    {
+        next = (next + 1) & index->mask;
+        if (NULL == index->slots[next].node)
+        {
+            break;
+        }
+
+        uint32_t home = (uint32_t)index->slots[next].hash & index->mask;
+        bool     b_move = (pos <= next) ? ((home <= pos) || (home > next))
+                                        : ((home <= pos) && (home > next));
+        if (b_move)
+        {
+            index->slots[pos] = index->slots[next];
+            pos               = next;
+        }
+    }
+
+    index->slots[pos].node = NULL;
+    --index->used;
+}
+
+static void
+ll_index_clear (ll_index_t *index)
+{
+    if (NULL == index)
+    {
+        return;
+    }
+
+    memset(index->slots, 0, ((size_t)index->mask + 1) * sizeof(ll_hslot_t));
+    index->used     = 0;
+    index->seq_head = -1;
+    index->seq_tail = 0;
+}
+
+static ll_node_t *
+ll_index_find (ll_index_t *index, char *key, llcmp_f cmpnode)
+{
+    ll_node_t *best     = NULL;
+    int64_t    best_seq = 0;
+    uint64_t   hash     = index->hashkey(key);
+
+    for (uint32_t pos = (uint32_t)hash & index->mask;
+         NULL != index->slots[pos].node;
+         pos = (pos + 1) & index->mask)
+    {
+        ll_hslot_t *slot = &index->slots[pos];
+        if ((slot->hash == hash) && ((NULL == best) || (slot->seq < best_seq))
+            && (0 == cmpnode(slot->node->data, key)))
+        {
+            best     = slot->node;
+            best_seq = slot->seq;
+        }
+    }
+
+    return best;
+}
+
 llist_t *
 ll_create (void)
 {
-    llist_t *llist = NULL;
+    return ll_create_lock(LL_LOCK_MUTEX);
+}
 
-    llist = calloc(1, sizeof(*llist));
+llist_t *
+ll_create_lock (ll_lock_t policy)
+{
+    llist_t *llist     = NULL;
+    size_t   alloc_sz  = offsetof(llist_t, lock);
+    int32_t  init_fail = 0;
+
+    switch (policy)
+    {
+        case LL_LOCK_NONE:
+            break;
+
+        case LL_LOCK_MUTEX:
+            alloc_sz += sizeof(pthread_mutex_t);
+            break;
+
+        case LL_LOCK_SPIN:
+            alloc_sz += sizeof(pthread_spinlock_t);
+            break;
+
+        default:
+            (void)fprintf(stderr, "ll_create_lock invalid policy\n");
+            goto LL_CREATE_RET;
+    }
+
+    llist = calloc(1, alloc_sz);
     if (NULL == llist)
     {
         perror("llist create");
         errno = 0;
         goto LL_CREATE_RET;
     }
+    llist->policy = policy;
 
-    if (0 != pthread_mutex_init(&llist->lock, NULL))
+    llist->pool = calloc(1, sizeof(*llist->pool));
+    if (NULL == llist->pool)
     {
-        perror("ll_create mutex init");
+        perror("llist pool create");
         errno = 0;
         free(llist);
         llist = NULL;
+        goto LL_CREATE_RET;
+    }
+    atomic_init(&llist->pool->refs, 1);
+    atomic_flag_clear(&llist->pool->lock);
+
+    if (LL_LOCK_MUTEX == policy)
+    {
+        init_fail = pthread_mutex_init(&llist->lock.mutex, NULL);
+    }
+    else if (LL_LOCK_SPIN == policy)
+    {
+        init_fail = pthread_spin_init(&llist->lock.spin, PTHREAD_PROCESS_PRIVATE);
+    }
+
+    if (0 != init_fail)
+    {
+        perror("ll_create lock init");
+        errno = 0;
+        free(llist->pool);
+        free(llist);
+        llist = NULL;
     }
 
 LL_CREATE_RET:
@@ -55,17 +641,26 @@ ll_enq (llist_t *llist, void *data)
         goto LL_ENQ_RET;
     }
 
-    ll_node_t *node = calloc(1, sizeof(*node));
+    ll_lock(llist);
+
+    ll_node_t *node = ll_node_alloc(llist);
     if (NULL == node)
     {
+        ll_unlock(llist);
         perror("enqueue allocation");
         errno = 0;
         goto LL_ENQ_RET;
     }
 
+    node->next = NULL;
     node->data = data;
 
-    pthread_mutex_lock(&llist->lock);
+    if (RETVAL_SUCCESS != ll_index_insert(llist, node, false))
+    {
+        ll_node_free(llist, node);
+        ll_unlock(llist);
+        goto LL_ENQ_RET;
+    }
 
     if (NULL == llist->head)
     {
@@ -79,7 +674,7 @@ ll_enq (llist_t *llist, void *data)
     llist->tail = node;
     ++llist->count;
 
-    pthread_mutex_unlock(&llist->lock);
+    ll_unlock(llist);
     ret_val = RETVAL_SUCCESS;
 
 LL_ENQ_RET:
@@ -95,23 +690,24 @@ ll_deq (llist_t *llist)
         goto LL_DEQ_RET;
     }
 
-    pthread_mutex_lock(&llist->lock);
+    ll_lock(llist);
 
-    if (NULL == llist->head)
-    {
-        // llist->tail = llist->head;
-        goto LL_DEQ_RET;
-    }
-    else
+    if (NULL != llist->head)
     {
         data            = llist->head->data;
         ll_node_t *temp = llist->head;
         llist->head     = llist->head->next;
-        free(temp);
+        ll_index_remove(llist, temp);
+        ll_retire(llist, temp, NULL);
         --llist->count;
+
+        if (NULL == llist->head)
+        {
+            llist->tail = NULL;
+        }
     }
 
-    pthread_mutex_unlock(&llist->lock);
+    ll_unlock(llist);
 
 LL_DEQ_RET:
     return data;
@@ -126,17 +722,24 @@ ll_push (llist_t *llist, void *data)
         goto LL_ENQ_RET;
     }
 
-    ll_node_t *node = calloc(1, sizeof(*node));
+    ll_lock(llist);
 
+    ll_node_t *node = ll_node_alloc(llist);
     if (NULL == node)
     {
+        ll_unlock(llist);
         perror("push allocation");
         errno = 0;
         goto LL_ENQ_RET;
     }
     node->data = data;
 
-    pthread_mutex_lock(&llist->lock);
+    if (RETVAL_SUCCESS != ll_index_insert(llist, node, true))
+    {
+        ll_node_free(llist, node);
+        ll_unlock(llist);
+        goto LL_ENQ_RET;
+    }
 
     node->next  = llist->head;
     llist->head = node;
@@ -146,7 +749,7 @@ ll_push (llist_t *llist, void *data)
     }
     ++llist->count;
 
-    pthread_mutex_unlock(&llist->lock);
+    ll_unlock(llist);
 
     ret_val = RETVAL_SUCCESS;
 
@@ -169,7 +772,14 @@ ll_search (llist_t *llist, char *key, llcmp_f cmpnode)
         goto LL_SEARCH_RET;
     }
 
-    pthread_mutex_lock(&llist->lock);
+    ll_lock(llist);
+
+    if (NULL != llist->index)
+    {
+        ll_node_t *found = ll_index_find(llist->index, key, cmpnode);
+        ret_ptr          = found ? found->data : NULL;
+        goto LL_SEARCH_UNLOCK;
+    }
 
     ll_node_t *node = llist->head;
     while (node)
@@ -182,7 +792,8 @@ ll_search (llist_t *llist, char *key, llcmp_f cmpnode)
         node = node->next;
     }
 
-    pthread_mutex_unlock(&llist->lock);
+LL_SEARCH_UNLOCK:
+    ll_unlock(llist);
 
 LL_SEARCH_RET:
     return ret_ptr;
@@ -199,7 +810,7 @@ ll_delete (llist_t *llist, int64_t num_delete, lliter_f freenode)
     }
     ++ret_val;
 
-    pthread_mutex_lock(&llist->lock);
+    ll_lock(llist);
     if (NULL == llist->head)
     {
         llist->tail = llist->head;
@@ -207,92 +818,349 @@ ll_delete (llist_t *llist, int64_t num_delete, lliter_f freenode)
     }
     void *temp_data = NULL;
 
-    for (int idx = 0; idx < num_delete; idx++)
+    for (int idx = 0; (idx < num_delete) && (NULL != llist->head); idx++)
     {
         temp_data       = llist->head->data;
         ll_node_t *temp = llist->head;
         llist->head     = llist->head->next;
-        free(temp);
+        ll_index_remove(llist, temp);
+        ll_retire(llist, temp, freenode);
         --llist->count;
 
         if (NULL != temp_data)
         {
-            freenode(temp_data);
-            ++ret_val;
+            ++ret_val;
+        }
+    }
+
+    if (NULL == llist->head)
+    {
+        llist->tail = NULL;
+    }
+
+LL_DEL_PRERET:
+    ll_unlock(llist);
+
+LL_DEL_RET:
+    return ret_val;
+}
+
+int64_t
+ll_dump (llist_t *llist, lliter_f freenode)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+
+    if ((NULL == llist) || (NULL == freenode))
+    {
+        goto LL_DUMP_RET;
+    }
+    ++ret_val;
+
+    ll_lock(llist);
+
+    ll_node_t *node = llist->head;
+    ll_node_t *next = NULL;
+
+    if (0 != llist->readers)
+    {
+        // open snapshots: every node (and its DATA) waits in limbo
+        while (node)
+        {
+            next = node->next;
+            ll_retire(llist, node, freenode);
+            ++ret_val;
+            node = next;
+        }
+        goto LL_DUMP_RESET;
+    }
+
+    // DATA still needs one visit each; the nodes go back slab by slab
+    while (node)
+    {
+        if (NULL != node->data)
+        {
+            freenode(node->data);
+        }
+        ++ret_val;
+        node = node->next;
+    }
+    ll_pool_reclaim(llist);
+
+LL_DUMP_RESET:
+    ll_index_clear(llist->index);
+
+    llist->head  = NULL;
+    llist->tail  = NULL;
+    llist->count = 0;
+
+    ll_unlock(llist);
+
+LL_DUMP_RET:
+    return ret_val;
+}
+
+void
+ll_destroy (llist_t **llist, lliter_f freenode)
+{
+    if ((NULL == llist) || (NULL == (*llist)) || (NULL == freenode))
+    {
+        return;
+    }
+
+    ll_lock(*llist);
+    ll_wait_readers(*llist);
+
+    ll_node_t *node = (*llist)->head;
+
+    while (node)
+    {
+        freenode(node->data);
+        node = node->next;
+    }
+    free((*llist)->limbo);
+    (*llist)->limbo = NULL;
+    ll_pool_reclaim(*llist);
+    if (1 == atomic_fetch_sub_explicit(&(*llist)->pool->refs, 1,
+                                       memory_order_acq_rel))
+    {
+        ll_pool_release((*llist)->pool);
+        free((*llist)->pool);
+    }
+    (*llist)->pool = NULL;
+    if (NULL != (*llist)->index)
+    {
+        free((*llist)->index->slots);
+        free((*llist)->index);
+        (*llist)->index = NULL;
+    }
+
+    ll_unlock(*llist);
+
+    if (LL_LOCK_MUTEX == (*llist)->policy)
+    {
+        pthread_mutex_destroy(&(*llist)->lock.mutex);
+    }
+    else if (LL_LOCK_SPIN == (*llist)->policy)
+    {
+        pthread_spin_destroy(&(*llist)->lock.spin);
+    }
+    (*llist)->head = NULL;
+    free(*llist);
+    *llist = NULL;
+}
+
+/*
+ * Lock two distinct lists in address order so concurrent A->B and B->A
+ * transfers cannot deadlock.
+ */
+static void
+ll_lock_pair (llist_t *first, llist_t *second)
+{
+    if ((uintptr_t)first > (uintptr_t)second)
+    {
+        llist_t *temp = first;
+        first         = second;
+        second        = temp;
+    }
+    ll_lock(first);
+    ll_lock(second);
+}
+
+/*
+ * Re-home SRC's chain onto nodes from DST's pool. Only needed when SRC's
+ * pool is still shared with some third list; O(n).
+ */
+static int32_t
+ll_chain_copy (llist_t *dst, llist_t *src)
+{
+    int32_t    ret_val = RETVAL_FAILURE;
+    ll_node_t *head    = NULL;
+    ll_node_t *tail    = NULL;
+
+    for (ll_node_t *node = src->head; node; node = node->next)
+    {
+        ll_node_t *copy = ll_node_alloc(dst);
+        if (NULL == copy)
+        {
+            perror("splice allocation");
+            errno = 0;
+            while (head)
+            {
+                copy = head;
+                head = head->next;
+                ll_node_free(dst, copy);
+            }
+            goto LL_CHAIN_COPY_RET;
+        }
+
+        copy->data = node->data;
+        copy->next = NULL;
+        if (NULL == head)
+        {
+            head = copy;
+        }
+        else
+        {
+            tail->next = copy;
         }
+        tail = copy;
     }
 
-LL_DEL_PRERET:
-    pthread_mutex_unlock(&llist->lock);
+    ll_pool_reclaim(src);
+    src->head = head;
+    src->tail = tail;
+    ret_val   = RETVAL_SUCCESS;
 
-LL_DEL_RET:
+LL_CHAIN_COPY_RET:
     return ret_val;
 }
 
-int64_t
-ll_dump (llist_t *llist, lliter_f freenode)
+int32_t
+ll_splice (llist_t *dst, llist_t *src)
 {
     int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == dst) || (NULL == src) || (dst == src))
+    {
+        goto LL_SPLICE_RET;
+    }
 
-    if ((NULL == llist) || (NULL == freenode))
+    ll_lock_pair(dst, src);
+    while ((0 != dst->readers) || (0 != src->readers))
     {
-        goto LL_DUMP_RET;
+        ll_unlock(dst);
+        ll_unlock(src);
+        sched_yield();
+        ll_lock_pair(dst, src);
     }
-    ++ret_val;
 
-    pthread_mutex_lock(&llist->lock);
+    if (NULL == src->head)
+    {
+        ret_val = RETVAL_SUCCESS;
+        goto LL_SPLICE_UNLOCK;
+    }
 
-    ll_node_t *head = llist->head;
-    ll_node_t *temp = NULL;
+    // an indexed DST gets room for every new node before anything is linked,
+    // so the list and its index cannot fall out of step
+    if ((NULL != dst->index)
+        && (RETVAL_SUCCESS != ll_index_grow(dst->index, (uint32_t)src->count)))
+    {
+        goto LL_SPLICE_UNLOCK;
+    }
 
-    while (head)
+    if (dst->pool != src->pool)
     {
-        temp = head;
-        head = head->next;
-        if (NULL != temp->data)
-        freenode(temp->data);
-        ++ret_val;
-        free(temp);
-        temp = NULL;
-        --llist->count;
+        if (1 == atomic_load_explicit(&src->pool->refs, memory_order_acquire))
+        {
+            ll_pool_merge(dst->pool, src->pool);
+        }
+        else if (RETVAL_SUCCESS != ll_chain_copy(dst, src))
+        {
+            goto LL_SPLICE_UNLOCK;
+        }
+    }
+
+    ll_node_t *first = src->head;
+    if (NULL == dst->head)
+    {
+        dst->head = first;
+    }
+    else
+    {
+        dst->tail->next = first;
     }
+    dst->tail = src->tail;
+    dst->count += src->count;
 
-    llist->head = NULL;
-    llist->tail = NULL;
+    src->head  = NULL;
+    src->tail  = NULL;
+    src->count = 0;
+    ll_index_clear(src->index);
 
-    pthread_mutex_unlock(&llist->lock);
+    // an indexed DST has to learn about every new node: O(k); the room was
+    // made above, so no insert can fail
+    for (ll_node_t *node = first; node && dst->index; node = node->next)
+    {
+        (void)ll_index_insert(dst, node, false);
+    }
 
-LL_DUMP_RET:
+    ret_val = RETVAL_SUCCESS;
+
+LL_SPLICE_UNLOCK:
+    ll_unlock(dst);
+    ll_unlock(src);
+
+LL_SPLICE_RET:
     return ret_val;
 }
 
-void
-ll_destroy (llist_t **llist, lliter_f freenode)
+llist_t *
+ll_split_at (llist_t *llist, int32_t index)
 {
-    if ((NULL == llist) || (NULL == (*llist)) || (NULL == freenode))
+    llist_t *rest = NULL;
+    if ((NULL == llist) || (0 > index))
     {
-        return;
+        goto LL_SPLIT_RET;
     }
 
-    pthread_mutex_lock(&(*llist)->lock);
+    rest = ll_create_lock(llist->policy);
+    if (NULL == rest)
+    {
+        goto LL_SPLIT_RET;
+    }
 
-    ll_node_t *head = (*llist)->head;
-    ll_node_t *temp = NULL;
+    ll_lock(llist);
+    ll_wait_readers(llist);
 
-    while (head)
+    if (index > llist->count)
     {
-        temp = head;
-        head = head->next;
-        freenode(temp->data);
-        free(temp);
+        ll_unlock(llist);
+        (void)fprintf(stderr, "ll_split_at index out of range\n");
+        ll_destroy(&rest, free);
+        goto LL_SPLIT_RET;
     }
 
-    pthread_mutex_unlock(&(*llist)->lock);
+    // REST draws from (and keeps alive) the pool its nodes live in
+    free(rest->pool);
+    rest->pool = llist->pool;
+    atomic_fetch_add_explicit(&rest->pool->refs, 1, memory_order_acq_rel);
 
-    pthread_mutex_destroy(&(*llist)->lock);
-    (*llist)->head = NULL;
-    free(*llist);
-    *llist = NULL;
+    ll_node_t *prev = NULL;
+    for (int32_t idx = 0; idx < index; idx++)
+    {
+        prev = prev ? prev->next : llist->head;
+    }
+
+    rest->head  = prev ? prev->next : llist->head;
+    rest->tail  = rest->head ? llist->tail : NULL;
+    rest->count = llist->count - index;
+
+    if (NULL == prev)
+    {
+        llist->head = NULL;
+        ll_index_clear(llist->index);
+    }
+    else
+    {
+        prev->next = NULL;
+        for (ll_node_t *node = rest->head; node && llist->index;
+             node            = node->next)
+        {
+            ll_index_remove(llist, node);
+        }
+    }
+    llist->tail  = prev;
+    llist->count = index;
+
+    ll_unlock(llist);
+
+LL_SPLIT_RET:
+    return rest;
+}
+
+llist_t *
+ll_take_all (llist_t *llist)
+{
+    return ll_split_at(llist, 0);
 }
 
 void
@@ -303,41 +1171,42 @@ ll_printf (llist_t *llist, lliter_f printnode)
         return;
     }
 
-    int32_t counter = 1;
+    int32_t   counter = 1;
+    ll_snap_t snap    = { 0 };
+    void     *data    = NULL;
 
-    pthread_mutex_lock(&llist->lock);
-    ll_node_t *node = llist->head;
+    (void)ll_snap_begin(llist, &snap);
+    int32_t total = snap.remaining;
 
-    if (NULL == node)
+    if (0 == total)
     {
         printf(" HEAD: | EMPTY |\n");
     }
 
-    while (node)
+    while (NULL != (data = ll_snap_next(&snap)))
     {
         if (1 == counter)
         {
             printf(" HEAD: ");
-            printnode(node->data);
+            printnode(data);
             counter++;
         }
-        else if (counter == llist->count)
+        else if (counter == total)
         {
             printf(" TAIL: ");
-            printnode(node->data);
+            printnode(data);
             counter++;
         }
         else
         {
             printf("%5d: ", counter++);
-            printnode(node->data);
+            printnode(data);
         }
 
-        node = node->next;
         (void)fflush(stdout);
     }
 
-    pthread_mutex_unlock(&llist->lock);
+    ll_snap_end(&snap);
     puts("");
 }
 
@@ -395,31 +1264,90 @@ ll_iter (llist_t *llist, lliter_f iter)
         goto ITER_RETURN;
     }
 
-    if (NULL == llist->head)
+    // callbacks run on a snapshot, so writers are never held up by them
+    ll_snap_t snap = { 0 };
+    void     *data = NULL;
+
+    (void)ll_snap_begin(llist, &snap);
+    if (0 != snap.remaining)
     {
-        goto ITER_RETURN;
+        ++ret_val;
     }
 
-    ++ret_val;
+    while (NULL != (data = ll_snap_next(&snap)))
+    {
+        iter(data);
+        ++ret_val;
+    }
+    ll_snap_end(&snap);
 
-    pthread_mutex_lock(&llist->lock);
-    ll_node_t *curr = llist->head;
+ITER_RETURN:
+    return ret_val;
+}
 
-    while (curr)
+int32_t
+ll_snap_begin (llist_t *llist, ll_snap_t *snap)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == llist) || (NULL == snap))
     {
-        if (curr->data)
-        {
-            iter(curr->data);
-            ++ret_val;
-        }
-        curr = curr->next;
+        goto LL_SNAP_BEGIN_RET;
     }
-    pthread_mutex_unlock(&llist->lock);
 
-ITER_RETURN:
+    ll_lock(llist);
+    ++llist->readers;
+    snap->llist     = llist;
+    snap->next      = llist->head;
+    snap->remaining = llist->count;
+    ll_unlock(llist);
+
+    ret_val = RETVAL_SUCCESS;
+
+LL_SNAP_BEGIN_RET:
     return ret_val;
 }
 
+void *
+ll_snap_next (ll_snap_t *snap)
+{
+    void *data = NULL;
+
+    if ((NULL == snap) || (0 >= snap->remaining) || (NULL == snap->next))
+    {
+        goto LL_SNAP_NEXT_RET;
+    }
+
+    // never read ->next past the snapshot; a writer may be appending there
+    data = snap->next->data;
+    --snap->remaining;
+    snap->next = (0 < snap->remaining) ? snap->next->next : NULL;
+
+LL_SNAP_NEXT_RET:
+    return data;
+}
+
+void
+ll_snap_end (ll_snap_t *snap)
+{
+    if ((NULL == snap) || (NULL == snap->llist))
+    {
+        return;
+    }
+
+    llist_t *llist = snap->llist;
+
+    ll_lock(llist);
+    if ((0 == --llist->readers) && (0 != llist->limbo_count))
+    {
+        ll_limbo_drain(llist);
+    }
+    ll_unlock(llist);
+
+    snap->llist     = NULL;
+    snap->next      = NULL;
+    snap->remaining = 0;
+}
+
 ll_node_t *
 ll_iter_start (llist_t *llist)
 {
@@ -434,7 +1362,9 @@ ll_iter_start (llist_t *llist)
     node = calloc(1, sizeof(*node));
     if (node)
     {
-        node->next = llist->head;
+        ll_iter_t iter = { 0 };
+        (void)ll_iter_init(llist, &iter);
+        node->next = iter.next;
     }
 
 LL_ITER_START_RET:
@@ -446,13 +1376,14 @@ ll_iter_next (ll_node_t *node)
 {
     void *data = NULL;
 
-    if ((NULL == node) || (NULL == node->next))
+    if (NULL == node)
     {
         goto LL_ITER_NEXT_RET;
     }
 
-    data       = node->next->data;
-    node->next = node->next->next;
+    ll_iter_t iter = { .next = node->next };
+    data           = ll_iter_step(&iter);
+    node->next     = iter.next;
 
 LL_ITER_NEXT_RET:
     return data;
@@ -490,4 +1421,295 @@ ll_iter_destroy (ll_node_t **node)
     *node = NULL;
 }
 
+int32_t
+ll_index_create (llist_t *llist, llkey_f getkey, llhash_f hashkey)
+{
+    int32_t     ret_val = RETVAL_FAILURE;
+    ll_index_t *index   = NULL;
+
+    if ((NULL == llist) || (NULL == getkey) || (NULL == hashkey))
+    {
+        goto LL_INDEX_CREATE_RET;
+    }
+
+    index = calloc(1, sizeof(*index));
+    if (NULL != index)
+    {
+        index->slots = calloc(LL_INDEX_MIN, sizeof(*index->slots));
+    }
+    if ((NULL == index) || (NULL == index->slots))
+    {
+        perror("ll_index_create");
+        errno = 0;
+        free(index);
+        goto LL_INDEX_CREATE_RET;
+    }
+
+    index->getkey   = getkey;
+    index->hashkey  = hashkey;
+    index->mask     = LL_INDEX_MIN - 1;
+    index->seq_head = -1;
+
+    ll_lock(llist);
+
+    if (NULL != llist->index)
+    {
+        ll_unlock(llist);
+        (void)fprintf(stderr, "ll_index_create index already exists\n");
+        free(index->slots);
+        free(index);
+        goto LL_INDEX_CREATE_RET;
+    }
+
+    llist->index = index;
+    ret_val      = RETVAL_SUCCESS;
+
+    for (ll_node_t *node = llist->head; node; node = node->next)
+    {
+        if (RETVAL_SUCCESS != ll_index_insert(llist, node, false))
+        {
+            llist->index = NULL;
+            free(index->slots);
+            free(index);
+            ret_val = RETVAL_FAILURE;
+            break;
+        }
+    }
+
+    ll_unlock(llist);
+
+LL_INDEX_CREATE_RET:
+    return ret_val;
+}
+
+uint64_t
+ll_hash_str (char *key)
+{
+    // FNV-1a, 64 bit
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    while (key && *key)
+    {
+        hash ^= (uint8_t)*key++;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+int32_t
+ll_iter_init (llist_t *llist, ll_iter_t *iter)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == llist) || (NULL == iter))
+    {
+        goto LL_ITER_INIT_RET;
+    }
+
+    ll_lock(llist);
+    iter->next = llist->head;
+    ll_unlock(llist);
+
+    ret_val = RETVAL_SUCCESS;
+
+LL_ITER_INIT_RET:
+    return ret_val;
+}
+
+void *
+ll_iter_step (ll_iter_t *iter)
+{
+    void *data = NULL;
+
+    if ((NULL == iter) || (NULL == iter->next))
+    {
+        goto LL_ITER_STEP_RET;
+    }
+
+    data       = iter->next->data;
+    iter->next = iter->next->next;
+
+LL_ITER_STEP_RET:
+    return data;
+}
+
+int32_t
+ll_iter_batch (ll_iter_t *iter, void **out, int32_t max_out)
+{
+    int32_t num_out = RETVAL_FAILURE;
+    if ((NULL == iter) || (NULL == out) || (0 > max_out))
+    {
+        goto LL_ITER_BATCH_RET;
+    }
+
+    ll_node_t *node = iter->next;
+    for (num_out = 0; (num_out < max_out) && (NULL != node); num_out++)
+    {
+        out[num_out] = node->data;
+        node         = node->next;
+    }
+    iter->next = node;
+
+LL_ITER_BATCH_RET:
+    return num_out;
+}
+
+// =============================================================================
+//                        LOCK-FREE MPSC QUEUE FUNCTIONS
+// =============================================================================
+
+/*
+ * The stub is always the first link of the shared chain: producers append
+ * after it and the consumer detaches everything behind it at once. Taken
+ * links are parked in queue->cache, which only the consumer touches.
+ */
+static llmpsc_node_t *
+ll_mpsc_grab (llmpsc_t *queue)
+{
+    llmpsc_node_t *first
+        = atomic_load_explicit(&queue->stub.next, memory_order_acquire);
+
+    if (NULL == first)
+    {
+        goto LL_MPSC_GRAB_RET;
+    }
+
+    // stub is no longer anyone's predecessor; re-arm it and swing the tail
+    atomic_store_explicit(&queue->stub.next, NULL, memory_order_relaxed);
+    llmpsc_node_t *last = atomic_exchange_explicit(
+        &queue->tail, &queue->stub, memory_order_acq_rel);
+
+    // producers may still be between their exchange and their link store
+    llmpsc_node_t *node = first;
+    while (node != last)
+    {
+        llmpsc_node_t *next = NULL;
+        while (NULL
+               == (next = atomic_load_explicit(&node->next,
+                                               memory_order_acquire)))
+        {
+            sched_yield();
+        }
+        node = next;
+    }
+
+LL_MPSC_GRAB_RET:
+    return first;
+}
+
+llmpsc_t *
+ll_mpsc_create (void)
+{
+    llmpsc_t *queue = NULL;
+
+    queue = aligned_alloc(LL_CACHELINE, sizeof(*queue));
+    if (NULL == queue)
+    {
+        perror("ll_mpsc_create");
+        errno = 0;
+        goto LL_MPSC_CREATE_RET;
+    }
+
+    atomic_init(&queue->stub.next, NULL);
+    atomic_init(&queue->tail, &queue->stub);
+    queue->cache = NULL;
+
+LL_MPSC_CREATE_RET:
+    return queue;
+}
+
+int32_t
+ll_mpsc_enq (llmpsc_t *queue, llmpsc_node_t *node)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == queue) || (NULL == node))
+    {
+        goto LL_MPSC_ENQ_RET;
+    }
+
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    llmpsc_node_t *prev
+        = atomic_exchange_explicit(&queue->tail, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+
+    ret_val = RETVAL_SUCCESS;
+
+LL_MPSC_ENQ_RET:
+    return ret_val;
+}
+
+llmpsc_node_t *
+ll_mpsc_deq (llmpsc_t *queue)
+{
+    llmpsc_node_t *node = NULL;
+    if (NULL == queue)
+    {
+        goto LL_MPSC_DEQ_RET;
+    }
+
+    if (NULL == queue->cache)
+    {
+        queue->cache = ll_mpsc_grab(queue);
+    }
+
+    node = queue->cache;
+    if (NULL != node)
+    {
+        queue->cache = atomic_load_explicit(&node->next, memory_order_relaxed);
+        atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    }
+
+LL_MPSC_DEQ_RET:
+    return node;
+}
+
+int64_t
+ll_mpsc_take_all (llmpsc_t *queue, lliter_f iter)
+{
+    int64_t ret_val = RETVAL_FAILURE;
+    if ((NULL == queue) || (NULL == iter))
+    {
+        goto LL_MPSC_TAKE_RET;
+    }
+    ++ret_val;
+
+    // leftovers from ll_mpsc_deq() are older than anything still shared
+    llmpsc_node_t *runs[2] = { queue->cache, NULL };
+    queue->cache           = NULL;
+    runs[1]                = ll_mpsc_grab(queue);
+
+    for (int idx = 0; idx < 2; idx++)
+    {
+        llmpsc_node_t *node = runs[idx];
+        while (node)
+        {
+            llmpsc_node_t *next
+                = atomic_load_explicit(&node->next, memory_order_relaxed);
+            iter(node);
+            ++ret_val;
+            node = next;
+        }
+    }
+
+LL_MPSC_TAKE_RET:
+    return ret_val;
+}
+
+void
+ll_mpsc_destroy (llmpsc_t **queue, lliter_f freenode)
+{
+    if ((NULL == queue) || (NULL == (*queue)))
+    {
+        return;
+    }
+
+    if (NULL != freenode)
+    {
+        (void)ll_mpsc_take_all(*queue, freenode);
+    }
+
+    free(*queue);
+    *queue = NULL;
+}
+
 /*** end of file ***/
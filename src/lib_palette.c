@@ -0,0 +1,293 @@
+/** @file lib_palette.c
+ *
+ * @brief Palette Library: redefine a band of the terminal's 256-color palette
+ * with OSC 4, so everything drawn in those indices changes color at once
+ * without redrawing a cell.
+ *
+ */
+
+#include "lib_palette.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define PALETTE_REPLY 48 // "\033]4;255;rgb:ffff/ffff/ffff\033\\" and change
+
+struct palette_t
+{
+    int32_t   first;
+    int32_t   count;
+    uint32_t *saved;
+    bool      b_saved;
+};
+
+static int64_t
+palette_now_ms (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+/*
+ * One "rgb:R/G/B" channel of 1 to 4 hex digits, scaled to 8 bits. Advances
+ * *TEXT past it; -1 if there is none.
+ */
+static int32_t
+palette_channel (const char **text)
+{
+    char         *end   = NULL;
+    unsigned long value = strtoul(*text, &end, 16);
+    long          digits = end - *text;
+
+    if ((1 > digits) || (4 < digits))
+    {
+        return -1;
+    }
+    *text = end;
+
+    unsigned long top = (1UL << (4 * digits)) - 1;
+    return (int32_t)(((value * 255) + (top / 2)) / top);
+}
+
+/*
+ * Pick every "4;N;rgb:R/G/B" answer out of the LEN bytes at REPLY. Returns
+ * how many of the band's entries were answered.
+ */
+static int32_t
+palette_parse (palette_t *palette, const char *reply, size_t len)
+{
+    int32_t answered = 0;
+
+    for (size_t i = 0; (i + 4) < len; ++i)
+    {
+        if ((0x1b != reply[i]) || (0 != memcmp(reply + i + 1, "]4;", 3)))
+        {
+            continue;
+        }
+
+        const char *text  = reply + i + 4;
+        char       *end   = NULL;
+        long        index = strtol(text, &end, 10);
+        int32_t     slot  = (int32_t)index - palette->first;
+        if ((end == text) || (0 != strncmp(end, ";rgb:", 5)) || (0 > slot)
+            || (palette->count <= slot))
+        {
+            continue;
+        }
+
+        text          = end + 5;
+        int32_t red   = palette_channel(&text);
+        int32_t grn   = ('/' == *text++) ? palette_channel(&text) : -1;
+        int32_t blu   = ('/' == *text++) ? palette_channel(&text) : -1;
+        if ((0 > red) || (0 > grn) || (0 > blu))
+        {
+            continue;
+        }
+
+        palette->saved[slot] = ((uint32_t)red << 16) | ((uint32_t)grn << 8)
+                               | (uint32_t)blu;
+        answered++;
+    }
+
+    return answered;
+}
+
+/*
+ * Whether the LEN bytes at REPLY hold the Device Attributes answer
+ * ("\033[?...c"), which comes after every OSC 4 answer.
+ */
+static bool
+palette_done (const char *reply, size_t len)
+{
+    for (size_t i = 0; (i + 2) < len; ++i)
+    {
+        if ((0x1b == reply[i]) && ('[' == reply[i + 1])
+            && ('?' == reply[i + 2]))
+        {
+            return NULL != memchr(reply + i, 'c', len - i);
+        }
+    }
+
+    return false;
+}
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+
+palette_t *
+palette_create (int32_t first, int32_t count)
+{
+    palette_t *palette = NULL;
+    if ((0 > first) || (1 > count) || (PALETTE_SIZE < first + count))
+    {
+        goto PALETTE_CREATE_RET;
+    }
+
+    palette = calloc(1, sizeof(*palette));
+    if (NULL == palette)
+    {
+        perror("palette create");
+        errno = 0;
+        goto PALETTE_CREATE_RET;
+    }
+
+    palette->first = first;
+    palette->count = count;
+    palette->saved = calloc((size_t)count, sizeof(*palette->saved));
+    if (NULL == palette->saved)
+    {
+        perror("palette create");
+        errno = 0;
+        palette_destroy(&palette);
+    }
+
+PALETTE_CREATE_RET:
+    return palette;
+}
+
+int32_t
+palette_probe (palette_t *palette, int32_t timeout_ms)
+{
+    int32_t        ret_val = RETVAL_FAILURE;
+    char          *reply   = NULL;
+    size_t         len     = 0;
+    struct termios saved;
+    int            tty     = -1;
+
+    if (NULL == palette)
+    {
+        return RETVAL_FAILURE;
+    }
+
+    tty = open("/dev/tty", O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if ((0 > tty) || (0 != tcgetattr(tty, &saved)))
+    {
+        errno = 0; // no terminal to ask
+        goto PALETTE_PROBE_RET;
+    }
+
+    size_t cap = ((size_t)palette->count * PALETTE_REPLY) + PALETTE_REPLY;
+    reply      = malloc(cap);
+    frame_t *ask = frame_create(0);
+    if ((NULL == reply) || (NULL == ask))
+    {
+        perror("palette probe");
+        errno = 0;
+        frame_unref(ask);
+        goto PALETTE_PROBE_RET;
+    }
+    reply[0] = '\0';
+
+    // answers are read, not echoed, and nothing waits for a newline
+    struct termios raw = saved;
+    raw.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+    raw.c_cc[VMIN]  = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(tty, TCSANOW, &raw);
+
+    for (int32_t i = 0; i < palette->count; ++i)
+    {
+        frame_printf(ask, "\033]4;%d;?\033\\", (int)(palette->first + i));
+    }
+    frame_put(ask, "\033[c", 3);
+    frame_write(ask, tty);
+    frame_unref(ask);
+
+    // terminals answer in order: once DA is in, every OSC 4 answer is too
+    int64_t deadline = palette_now_ms() + timeout_ms;
+    while ((len < cap - 1) && !palette_done(reply, len))
+    {
+        int64_t       left = deadline - palette_now_ms();
+        struct pollfd pfd  = { .fd = tty, .events = POLLIN };
+        if ((0 >= left) || (0 >= poll(&pfd, 1, (int)left)))
+        {
+            break;
+        }
+
+        ssize_t got = read(tty, reply + len, cap - 1 - len);
+        if (0 < got)
+        {
+            len += (size_t)got;
+            reply[len] = '\0'; // the parse below runs strtol over it
+        }
+        else if ((0 > got) && (EINTR != errno) && (EAGAIN != errno))
+        {
+            break;
+        }
+    }
+    errno = 0;
+
+    // a late answer is dropped rather than shown
+    tcsetattr(tty, TCSAFLUSH, &saved);
+
+    palette->b_saved = (palette->count == palette_parse(palette, reply, len));
+    ret_val          = palette->b_saved ? RETVAL_SUCCESS : RETVAL_FAILURE;
+
+PALETTE_PROBE_RET:
+    if (0 <= tty)
+    {
+        close(tty);
+    }
+    free(reply);
+    return ret_val;
+}
+
+int32_t
+palette_set (palette_t *palette, frame_t *frame, const uint32_t *rgb)
+{
+    if ((NULL == palette) || (NULL == frame) || (NULL == rgb))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    // "\033]4;%d;rgb:%02x/%02x/%02x;%d;rgb:...\033\\": one sequence
+    frame_put(frame, "\033]4", 3);
+    for (int32_t i = 0; i < palette->count; ++i)
+    {
+        frame_printf(frame, ";%d;rgb:%02x/%02x/%02x",
+                     (int)(palette->first + i), (unsigned)(rgb[i] >> 16) & 0xFF,
+                     (unsigned)(rgb[i] >> 8) & 0xFF, (unsigned)rgb[i] & 0xFF);
+    }
+
+    return frame_put(frame, "\033\\", 2);
+}
+
+int32_t
+palette_restore (palette_t *palette, frame_t *frame)
+{
+    if ((NULL == palette) || (NULL == frame))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    if (palette->b_saved)
+    {
+        return palette_set(palette, frame, palette->saved);
+    }
+
+    frame_put(frame, "\033]104", 5);
+    for (int32_t i = 0; i < palette->count; ++i)
+    {
+        frame_printf(frame, ";%d", (int)(palette->first + i));
+    }
+
+    return frame_put(frame, "\033\\", 2);
+}
+
+void
+palette_destroy (palette_t **palette)
+{
+    if ((NULL == palette) || (NULL == *palette))
+    {
+        return;
+    }
+
+    free((*palette)->saved);
+    free(*palette);
+    *palette = NULL;
+}
+
+/*** end of file ***/
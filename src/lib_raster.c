@@ -0,0 +1,468 @@
+/** @file lib_raster.c
+ *
+ * @brief Raster Library: draw a grid_t into an RGB framebuffer for offline
+ * rendering (PPM / raw RGB frames). Box-drawing glyphs come from an atlas
+ * baked once at the chosen cell size; rows are split into bands drawn in
+ * parallel, and only rows marked dirty in the grid are redrawn.
+ *
+ */
+
+#include "lib_raster.h"
+#include "lib_trace.h"
+
+#include <stdbool.h>
+
+#define RASTER_BOX_FIRST  0x2500 // Unicode "Box Drawing" block
+#define RASTER_BOX_COUNT  128
+#define RASTER_BLANK      RASTER_BOX_COUNT // atlas slot of the empty glyph
+#define RASTER_PAR_ROWS   8 // fewer dirty rows than this are drawn inline
+#define RASTER_DEFAULT_FG 255 // bold default foreground (the border)
+
+// arm weights, 2 bits each: 0 none, 1 light, 2 heavy
+#define ARMS(l, r, u, d) ((l) | ((r) << 2) | ((u) << 4) | ((d) << 6))
+#define ARM_L(a)         ((a) & 3)
+#define ARM_R(a)         (((a) >> 2) & 3)
+#define ARM_U(a)         (((a) >> 4) & 3)
+#define ARM_D(a)         (((a) >> 6) & 3)
+
+struct raster_t
+{
+    int32_t           cell_w;
+    int32_t           cell_h;
+    int32_t           cols;
+    int32_t           rows;
+    uint8_t          *pixels;
+    uint8_t          *atlas;
+    int32_t           threads;
+    pthread_t         workers[RASTER_MAX_THREADS];
+    pthread_mutex_t   mutex;
+    pthread_cond_t    start;
+    pthread_cond_t    done;
+    uint64_t          job_gen; // bumped per job, under MUTEX
+    int32_t           pending; // workers still drawing the current job
+    grid_t           *job; // NULL tells the workers to exit
+    bool              b_all;
+};
+
+typedef struct raster_worker_t
+{
+    raster_t *raster;
+    int32_t   id;
+} raster_worker_t;
+
+// the glyphs lines are built from; anything else in the block draws blank
+static const struct
+{
+    uint16_t glyph;
+    uint8_t  arms;
+} g_box_arms[] = {
+    { 0x2500, ARMS(1, 1, 0, 0) }, { 0x2501, ARMS(2, 2, 0, 0) },
+    { 0x2502, ARMS(0, 0, 1, 1) }, { 0x2503, ARMS(0, 0, 2, 2) },
+    { 0x250c, ARMS(0, 1, 0, 1) }, { 0x250f, ARMS(0, 2, 0, 2) },
+    { 0x2510, ARMS(1, 0, 0, 1) }, { 0x2513, ARMS(2, 0, 0, 2) },
+    { 0x2514, ARMS(0, 1, 1, 0) }, { 0x2517, ARMS(0, 2, 2, 0) },
+    { 0x2518, ARMS(1, 0, 1, 0) }, { 0x251b, ARMS(2, 0, 2, 0) },
+    { 0x251c, ARMS(0, 1, 1, 1) }, { 0x2523, ARMS(0, 2, 2, 2) },
+    { 0x2524, ARMS(1, 0, 1, 1) }, { 0x252b, ARMS(2, 0, 2, 2) },
+    { 0x252c, ARMS(1, 1, 0, 1) }, { 0x2533, ARMS(2, 2, 0, 2) },
+    { 0x2534, ARMS(1, 1, 1, 0) }, { 0x253b, ARMS(2, 2, 2, 0) },
+    { 0x253c, ARMS(1, 1, 1, 1) }, { 0x254b, ARMS(2, 2, 2, 2) },
+    { 0x256d, ARMS(0, 1, 0, 1) }, { 0x256e, ARMS(1, 0, 0, 1) },
+    { 0x256f, ARMS(1, 0, 1, 0) }, { 0x2570, ARMS(0, 1, 1, 0) },
+};
+
+/*
+ * Fill the rectangle [X0,X1) x [Y0,Y1) of one glyph mask.
+ */
+static void
+raster_fill (raster_t *raster, uint8_t *mask, int32_t x0, int32_t x1,
+             int32_t y0, int32_t y1)
+{
+    for (int32_t y = y0; y < y1; ++y)
+    {
+        memset(mask + (y * raster->cell_w) + x0, 0xFF, (size_t)(x1 - x0));
+    }
+}
+
+/*
+ * Masks are 0x00 or 0xFF per pixel, so a pixel is MASK & COLOR.
+ */
+static void
+raster_bake (raster_t *raster)
+{
+    int32_t cw = raster->cell_w;
+    int32_t ch = raster->cell_h;
+
+    for (size_t i = 0; i < (sizeof(g_box_arms) / sizeof(g_box_arms[0])); ++i)
+    {
+        uint8_t  arms = g_box_arms[i].arms;
+        uint8_t *mask = raster->atlas
+                        + ((size_t)(g_box_arms[i].glyph - RASTER_BOX_FIRST)
+                           * (size_t)cw * (size_t)ch);
+
+        int32_t b_heavy = (2 == ARM_L(arms)) || (2 == ARM_R(arms))
+                          || (2 == ARM_U(arms)) || (2 == ARM_D(arms));
+
+        // line thickness: across a vertical (tv) and a horizontal (th) arm
+        int32_t tv = b_heavy ? ((cw / 4) > 2 ? (cw / 4) : 2)
+                             : ((cw / 8) > 1 ? (cw / 8) : 1);
+        int32_t th = b_heavy ? ((ch / 8) > 2 ? (ch / 8) : 2)
+                             : ((ch / 16) > 1 ? (ch / 16) : 1);
+        tv = (tv < cw) ? tv : cw;
+        th = (th < ch) ? th : ch;
+
+        int32_t x0 = (cw - tv) / 2;
+        int32_t y0 = (ch - th) / 2;
+
+        // every arm covers the center so corners join up
+        if (ARM_L(arms))
+        {
+            raster_fill(raster, mask, 0, x0 + tv, y0, y0 + th);
+        }
+        if (ARM_R(arms))
+        {
+            raster_fill(raster, mask, x0, cw, y0, y0 + th);
+        }
+        if (ARM_U(arms))
+        {
+            raster_fill(raster, mask, x0, x0 + tv, 0, y0 + th);
+        }
+        if (ARM_D(arms))
+        {
+            raster_fill(raster, mask, x0, x0 + tv, y0, ch);
+        }
+    }
+}
+
+static void
+raster_cell (raster_t *raster, int32_t x, int32_t y, const cell_t *cell)
+{
+    int32_t cw    = raster->cell_w;
+    int32_t ch    = raster->cell_h;
+    size_t  pitch = (size_t)raster->cols * (size_t)cw * 3;
+    uint8_t *dst  = raster->pixels + ((size_t)y * (size_t)ch * pitch)
+                   + ((size_t)x * (size_t)cw * 3);
+
+    uint32_t slot = cell->glyph - RASTER_BOX_FIRST;
+    if (slot >= RASTER_BOX_COUNT)
+    {
+        slot = RASTER_BLANK;
+    }
+    const uint8_t *mask = raster->atlas + ((size_t)slot * (size_t)cw * (size_t)ch);
+
+    uint8_t red = RASTER_DEFAULT_FG;
+    uint8_t grn = RASTER_DEFAULT_FG;
+    uint8_t blu = RASTER_DEFAULT_FG;
+    if (cell->attr & CELL_RGB)
+    {
+        red = cell->r;
+        grn = cell->g;
+        blu = cell->b;
+    }
+
+    for (int32_t py = 0; py < ch; ++py, dst += pitch, mask += cw)
+    {
+        for (int32_t px = 0; px < cw; ++px)
+        {
+            dst[(px * 3) + 0] = mask[px] & red;
+            dst[(px * 3) + 1] = mask[px] & grn;
+            dst[(px * 3) + 2] = mask[px] & blu;
+        }
+    }
+}
+
+/*
+ * Draw every dirty row Y with (Y % STEP) == FIRST.
+ */
+static void
+raster_rows (raster_t *raster, grid_t *grid, bool b_all, int32_t first,
+             int32_t step)
+{
+    size_t          words = 0;
+    const uint64_t *dirty = grid_dirty(grid, &words);
+
+    TRACE_BEGIN("raster");
+    for (int32_t y = first; y < raster->rows; y += step)
+    {
+        if (!b_all && !(dirty[y / 64] & ((uint64_t)1 << (y % 64))))
+        {
+            continue;
+        }
+
+        for (int32_t x = 0; x < raster->cols; ++x)
+        {
+            raster_cell(raster, x, y, grid_get(grid, x, y));
+        }
+    }
+    TRACE_END("raster");
+}
+
+static void *
+raster_worker (void *arg)
+{
+    raster_worker_t *worker = arg;
+    raster_t        *raster = worker->raster;
+    uint64_t         seen   = 0;
+
+    pthread_mutex_lock(&raster->mutex);
+    for (;;)
+    {
+        while (seen == raster->job_gen)
+        {
+            pthread_cond_wait(&raster->start, &raster->mutex);
+        }
+        seen = raster->job_gen;
+        if (NULL == raster->job)
+        {
+            break;
+        }
+
+        pthread_mutex_unlock(&raster->mutex);
+        raster_rows(raster, raster->job, raster->b_all, worker->id,
+                    raster->threads);
+        pthread_mutex_lock(&raster->mutex);
+
+        if (0 == --raster->pending)
+        {
+            pthread_cond_signal(&raster->done);
+        }
+    }
+    pthread_mutex_unlock(&raster->mutex);
+
+    free(worker);
+    return NULL;
+}
+
+raster_t *
+raster_create (int32_t cell_w, int32_t cell_h, int32_t threads)
+{
+    raster_t *raster = NULL;
+    if ((cell_w < 1) || (cell_h < 1))
+    {
+        goto RASTER_CREATE_RET;
+    }
+
+    if (threads <= 0)
+    {
+        threads = (int32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    threads = (threads < 1) ? 1 : threads;
+    threads = (threads > RASTER_MAX_THREADS) ? RASTER_MAX_THREADS : threads;
+
+    raster = calloc(1, sizeof(*raster));
+    if (NULL == raster)
+    {
+        perror("raster create");
+        errno = 0;
+        goto RASTER_CREATE_RET;
+    }
+
+    raster->cell_w  = cell_w;
+    raster->cell_h  = cell_h;
+    raster->threads = 1;
+    raster->atlas   = calloc((size_t)(RASTER_BOX_COUNT + 1),
+                             (size_t)cell_w * (size_t)cell_h);
+    if (NULL == raster->atlas)
+    {
+        perror("raster atlas");
+        errno = 0;
+        free(raster);
+        raster = NULL;
+        goto RASTER_CREATE_RET;
+    }
+    raster_bake(raster);
+
+    pthread_mutex_init(&raster->mutex, NULL);
+    pthread_cond_init(&raster->start, NULL);
+    pthread_cond_init(&raster->done, NULL);
+
+    // the caller is thread 0; run with however many workers could start
+    for (int32_t i = 1; i < threads; ++i)
+    {
+        raster_worker_t *worker = malloc(sizeof(*worker));
+        if (NULL == worker)
+        {
+            break;
+        }
+        worker->raster = raster;
+        worker->id     = i;
+
+        if (0 != pthread_create(&raster->workers[i], NULL, raster_worker,
+                                worker))
+        {
+            free(worker);
+            errno = 0;
+            break;
+        }
+        raster->threads = i + 1;
+    }
+
+RASTER_CREATE_RET:
+    return raster;
+}
+
+int32_t
+raster_draw (raster_t *raster, grid_t *grid)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    int32_t cols    = 0;
+    int32_t rows    = 0;
+
+    if ((NULL == raster) || (RETVAL_SUCCESS != grid_size(grid, &cols, &rows)))
+    {
+        goto RASTER_DRAW_RET;
+    }
+
+    bool b_all = (cols != raster->cols) || (rows != raster->rows);
+    if (b_all)
+    {
+        size_t   bytes  = (size_t)cols * (size_t)raster->cell_w * (size_t)rows
+                       * (size_t)raster->cell_h * 3;
+        uint8_t *pixels = realloc(raster->pixels, bytes);
+        if (NULL == pixels)
+        {
+            perror("raster resize");
+            errno = 0;
+            goto RASTER_DRAW_RET;
+        }
+        raster->pixels = pixels;
+        raster->cols   = cols;
+        raster->rows   = rows;
+    }
+
+    // only wake the workers when there is enough to share
+    if ((1 == raster->threads)
+        || (!b_all && (grid_dirty_rows(grid) < RASTER_PAR_ROWS)))
+    {
+        raster_rows(raster, grid, b_all, 0, 1);
+    }
+    else
+    {
+        pthread_mutex_lock(&raster->mutex);
+        raster->job     = grid;
+        raster->b_all   = b_all;
+        raster->pending = raster->threads - 1;
+        raster->job_gen++;
+        pthread_cond_broadcast(&raster->start);
+        pthread_mutex_unlock(&raster->mutex);
+
+        raster_rows(raster, grid, b_all, 0, raster->threads);
+
+        pthread_mutex_lock(&raster->mutex);
+        while (0 < raster->pending)
+        {
+            pthread_cond_wait(&raster->done, &raster->mutex);
+        }
+        pthread_mutex_unlock(&raster->mutex);
+    }
+
+    ret_val = RETVAL_SUCCESS;
+
+RASTER_DRAW_RET:
+    return ret_val;
+}
+
+const uint8_t *
+raster_pixels (raster_t *raster, int32_t *width, int32_t *height)
+{
+    const uint8_t *pixels = NULL;
+    if ((NULL == raster) || (NULL == width) || (NULL == height))
+    {
+        goto RASTER_PIXELS_RET;
+    }
+
+    *width  = raster->cols * raster->cell_w;
+    *height = raster->rows * raster->cell_h;
+    pixels  = raster->pixels;
+
+RASTER_PIXELS_RET:
+    return pixels;
+}
+
+int32_t
+raster_write (raster_t *raster, int fd, raster_fmt_t fmt)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    int32_t width   = 0;
+    int32_t height  = 0;
+    char    head[48];
+    int     head_len = 0;
+
+    const uint8_t *pixels = raster_pixels(raster, &width, &height);
+    if (NULL == pixels)
+    {
+        goto RASTER_WRITE_RET;
+    }
+
+    if (RASTER_PPM == fmt)
+    {
+        head_len = snprintf(head, sizeof(head), "P6\n%d %d\n255\n", width,
+                            height);
+    }
+
+    struct
+    {
+        const uint8_t *data;
+        size_t         len;
+    } parts[2] = {
+        { (const uint8_t *)head, (size_t)head_len },
+        { pixels, (size_t)width * (size_t)height * 3 },
+    };
+
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        size_t off = 0;
+        while (off < parts[i].len)
+        {
+            ssize_t written = write(fd, parts[i].data + off,
+                                    parts[i].len - off);
+            if (0 > written)
+            {
+                if (EINTR == errno)
+                {
+                    errno = 0;
+                    continue;
+                }
+                goto RASTER_WRITE_RET;
+            }
+            off += (size_t)written;
+        }
+    }
+
+    ret_val = RETVAL_SUCCESS;
+
+RASTER_WRITE_RET:
+    return ret_val;
+}
+
+void
+raster_destroy (raster_t **raster)
+{
+    if ((NULL == raster) || (NULL == *raster))
+    {
+        return;
+    }
+
+    raster_t *temp = *raster;
+
+    pthread_mutex_lock(&temp->mutex);
+    temp->job = NULL;
+    temp->job_gen++;
+    pthread_cond_broadcast(&temp->start);
+    pthread_mutex_unlock(&temp->mutex);
+
+    for (int32_t i = 1; i < temp->threads; ++i)
+    {
+        pthread_join(temp->workers[i], NULL);
+    }
+    pthread_mutex_destroy(&temp->mutex);
+    pthread_cond_destroy(&temp->start);
+    pthread_cond_destroy(&temp->done);
+
+    free(temp->pixels);
+    free(temp->atlas);
+    free(temp);
+    *raster = NULL;
+}
+
+/*** end of file ***/
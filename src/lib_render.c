@@ -0,0 +1,930 @@
+/** @file lib_render.c
+ *
+ * @brief Render Library: turns grid cells into terminal output. A backend is
+ * a vtable (begin_frame / put_cell / end_frame / resize / leave) picked once
+ * at startup, so the per-cell path never checks what mode it is in.
+ *
+ */
+
+#include "lib_render.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+
+#define RENDER_UNKNOWN (-1)
+#define RENDER_CHUNK   4096 // kitty: most base64 bytes in one escape
+#define RENDER_PLACE   112 // kitty: most bytes to swap one cell's sprite
+#define RENDER_MOVE    12 // most bytes of a cursor move
+#define RENDER_PAL     0x1000000 // truecolor: a palette index, not 0xRRGGBB
+
+struct render_t
+{
+    const render_ops_t *ops;
+    frame_t            *frame;
+    int32_t             x;
+    int32_t             y;
+    int32_t             attr;
+    int32_t             color;
+    int32_t             cols;
+    uint32_t            frames;
+    int                 fd;
+    vec_t              *log;
+    sprite_t           *sprite;
+    int32_t             rows;
+    uint16_t           *want;
+    uint16_t           *shown;
+    uint64_t           *pending;
+    size_t              budget;
+    bool                b_sent;
+    bool                b_left;
+};
+
+// =============================================================================
+//                              SHARED EMITTERS
+// =============================================================================
+
+/*
+ * Move the cursor to X, Y unless it is already there; a forward move on the
+ * same row is shorter than an absolute one.
+ */
+static inline void
+render_move (render_t *render, int32_t x, int32_t y)
+{
+    frame_t *frame = render->frame;
+
+    if ((render->y == y) && (render->x == x))
+    {
+        return;
+    }
+
+    if ((render->y == y) && (render->x >= 0) && (render->x < x))
+    {
+        // "\033[%dC"
+        frame_put(frame, "\033[", 2);
+        frame_putnum(frame, (uint32_t)(x - render->x));
+        frame_put(frame, "C", 1);
+    }
+    else
+    {
+        // "\033[%d;%dH"
+        frame_put(frame, "\033[", 2);
+        frame_putnum(frame, (uint32_t)(y + 1));
+        frame_put(frame, ";", 1);
+        frame_putnum(frame, (uint32_t)(x + 1));
+        frame_put(frame, "H", 1);
+    }
+}
+
+/*
+ * Print the glyph (a space erases) and advance the cursor. The last column
+ * leaves the cursor pending a wrap, so its position is forgotten.
+ */
+static inline void
+render_glyph (render_t *render, int32_t x, int32_t y, uint32_t glyph)
+{
+    if (0 == glyph)
+    {
+        frame_put(render->frame, " ", 1);
+    }
+    else
+    {
+        frame_putwc(render->frame, glyph);
+    }
+
+    render->x = ((render->cols <= 0) || ((x + 1) < render->cols)) ? x + 1
+                                                                   : -1;
+    render->y = y;
+}
+
+/*
+ * Switch SGR to ATTR (CELL_BOLD or 0) and COLOR (backend value, -1 for the
+ * default foreground). KIND is a constant at every call site, so each
+ * backend gets its own copy with the color encoding folded in.
+ */
+static inline __attribute__((always_inline)) void
+render_style (render_t *render, int32_t attr, int32_t color,
+              const render_kind_t kind)
+{
+    frame_t *frame = render->frame;
+
+    if ((render->attr == attr) && (render->color == color))
+    {
+        return;
+    }
+
+    // dropping bold or a color needs a full reset
+    if ((RENDER_UNKNOWN == render->attr) || (render->attr & ~attr)
+        || ((RENDER_UNKNOWN != render->color) && (RENDER_UNKNOWN == color)))
+    {
+        frame_put(frame, "\033[0m", 4);
+        render->attr  = 0;
+        render->color = RENDER_UNKNOWN;
+    }
+
+    if ((attr & CELL_BOLD) && !(render->attr & CELL_BOLD))
+    {
+        frame_put(frame, "\033[1m", 4);
+    }
+
+    if ((RENDER_UNKNOWN != color) && (render->color != color))
+    {
+        switch (kind)
+        {
+            case RENDER_TRUECOLOR:
+                if (color & RENDER_PAL)
+                {
+                    // "\033[38;5;%dm"
+                    frame_put(frame, "\033[38;5;", 7);
+                    frame_putnum(frame, (uint32_t)color & 0xFF);
+                    frame_put(frame, "m", 1);
+                    break;
+                }
+                // "\033[38;2;%d;%d;%dm"
+                frame_put(frame, "\033[38;2;", 7);
+                frame_putnum(frame, ((uint32_t)color >> 16) & 0xFF);
+                frame_put(frame, ";", 1);
+                frame_putnum(frame, ((uint32_t)color >> 8) & 0xFF);
+                frame_put(frame, ";", 1);
+                frame_putnum(frame, (uint32_t)color & 0xFF);
+                frame_put(frame, "m", 1);
+                break;
+
+            case RENDER_256:
+                // "\033[38;5;%dm"
+                frame_put(frame, "\033[38;5;", 7);
+                frame_putnum(frame, (uint32_t)color);
+                frame_put(frame, "m", 1);
+                break;
+
+            case RENDER_16:
+                // "\033[%dm", 30-37 or 90-97
+                frame_put(frame, "\033[", 2);
+                frame_putnum(frame, (uint32_t)color);
+                frame_put(frame, "m", 1);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    render->attr  = attr;
+    render->color = color;
+}
+
+static void
+render_term_begin (render_t *render, frame_t *frame)
+{
+    render->frame = frame;
+    render->x     = RENDER_UNKNOWN;
+    render->y     = RENDER_UNKNOWN;
+    render->attr  = RENDER_UNKNOWN;
+    render->color = RENDER_UNKNOWN;
+}
+
+static void
+render_term_end (render_t *render)
+{
+    // nothing to undo unless a style was set since render_term_begin
+    if ((NULL != render->frame)
+        && ((0 < render->attr) || (RENDER_UNKNOWN != render->color)))
+    {
+        frame_put(render->frame, "\033[0m", 4); // reset
+    }
+    render->attr  = 0;
+    render->color = RENDER_UNKNOWN;
+    render->frames++;
+}
+
+static void
+render_term_resize (render_t *render, int32_t cols, int32_t rows)
+{
+    (void)rows;
+    render->cols = cols;
+
+    // hide cursor, reset, clear screen
+    frame_printf(render->frame, "\033[?25l\033[0m\033[2J\033[;H");
+    render->x     = 0;
+    render->y     = 0;
+    render->attr  = 0;
+    render->color = RENDER_UNKNOWN;
+}
+
+static void
+render_term_leave (render_t *render)
+{
+    // reset, clear screen, show cursor
+    frame_printf(render->frame, "\033[0m\033[2J\033[;H\033[?25h");
+}
+
+// =============================================================================
+//                              TERMINAL BACKENDS
+// =============================================================================
+
+static void
+render_truecolor_put (render_t *render, int32_t x, int32_t y,
+                      const cell_t *cell)
+{
+    int32_t color = (cell->attr & CELL_RGB)
+                        ? (int32_t)(((uint32_t)cell->r << 16)
+                                    | ((uint32_t)cell->g << 8) | cell->b)
+                        : RENDER_UNKNOWN;
+    if (cell->attr & CELL_PAL)
+    {
+        color = RENDER_PAL | cell->r; // a --cycle band entry
+    }
+    int32_t attr  = cell->glyph ? (cell->attr & CELL_BOLD) : 0;
+
+    render_move(render, x, y);
+    render_style(render, attr, cell->glyph ? color : RENDER_UNKNOWN,
+                 RENDER_TRUECOLOR);
+    render_glyph(render, x, y, cell->glyph);
+}
+
+/*
+ * xterm palette: 232-255 grays, else the 6x6x6 cube at 16-231. A palette
+ * cell is sent as its index.
+ */
+static void
+render_256_put (render_t *render, int32_t x, int32_t y, const cell_t *cell)
+{
+    int32_t color = RENDER_UNKNOWN;
+    if ((cell->attr & CELL_PAL) && cell->glyph)
+    {
+        color = cell->r;
+    }
+    else if ((cell->attr & CELL_RGB) && cell->glyph)
+    {
+        if ((cell->r == cell->g) && (cell->g == cell->b) && (cell->r >= 8)
+            && (cell->r <= 238))
+        {
+            color = 232 + ((cell->r - 8) / 10);
+        }
+        else
+        {
+            color = 16 + (36 * ((cell->r * 5 + 127) / 255))
+                    + (6 * ((cell->g * 5 + 127) / 255))
+                    + ((cell->b * 5 + 127) / 255);
+        }
+    }
+    int32_t attr = cell->glyph ? (cell->attr & CELL_BOLD) : 0;
+
+    render_move(render, x, y);
+    render_style(render, attr, color, RENDER_256);
+    render_glyph(render, x, y, cell->glyph);
+}
+
+/*
+ * One bit per channel picks the hue; bright (90-97) once any channel is
+ * high. Very dark colors become bright black (gray), then nothing.
+ */
+static void
+render_16_put (render_t *render, int32_t x, int32_t y, const cell_t *cell)
+{
+    int32_t color = RENDER_UNKNOWN;
+    if ((cell->attr & CELL_RGB) && cell->glyph)
+    {
+        uint8_t high = cell->r;
+        high         = (cell->g > high) ? cell->g : high;
+        high         = (cell->b > high) ? cell->b : high;
+
+        int32_t hue = ((cell->r >= (high / 2 + 1)) ? 1 : 0)
+                      | ((cell->g >= (high / 2 + 1)) ? 2 : 0)
+                      | ((cell->b >= (high / 2 + 1)) ? 4 : 0);
+        if (high < 64)
+        {
+            color = 90; // bright black
+        }
+        else
+        {
+            color = ((high >= 192) ? 90 : 30) + hue;
+        }
+    }
+    int32_t attr = cell->glyph ? (cell->attr & CELL_BOLD) : 0;
+
+    render_move(render, x, y);
+    render_style(render, attr, color, RENDER_16);
+    render_glyph(render, x, y, cell->glyph);
+}
+
+static void
+render_mono_put (render_t *render, int32_t x, int32_t y, const cell_t *cell)
+{
+    render_move(render, x, y);
+    render_style(render, cell->glyph ? (cell->attr & CELL_BOLD) : 0,
+                 RENDER_UNKNOWN, RENDER_MONO);
+    render_glyph(render, x, y, cell->glyph);
+}
+
+// =============================================================================
+//                              OTHER BACKENDS
+// =============================================================================
+
+static void
+render_null_begin (render_t *render, frame_t *frame)
+{
+    render->frame = frame;
+}
+
+static void
+render_null_put (render_t *render, int32_t x, int32_t y, const cell_t *cell)
+{
+    (void)render;
+    (void)x;
+    (void)y;
+    (void)cell;
+}
+
+static void
+render_null_end (render_t *render)
+{
+    render->frames++;
+}
+
+static void
+render_null_resize (render_t *render, int32_t cols, int32_t rows)
+{
+    (void)rows;
+    render->cols = cols;
+}
+
+static void
+render_null_leave (render_t *render)
+{
+    (void)render;
+}
+
+static void
+render_record_put (render_t *render, int32_t x, int32_t y,
+                   const cell_t *cell)
+{
+    render_rec_t rec = { .frame = render->frames,
+                         .x     = (int16_t)x,
+                         .y     = (int16_t)y,
+                         .cell  = *cell };
+    vec_append(render->log, &rec);
+}
+
+static void
+render_record_end (render_t *render)
+{
+    size_t        len = 0;
+    vec_iter_t    iter;
+    render_rec_t *span = NULL;
+
+    vec_iter_init(render->log, &iter);
+    while (NULL != (span = vec_iter_span(render->log, &iter, 0, &len)))
+    {
+        size_t bytes = len * sizeof(*span);
+        for (size_t off = 0; off < bytes;)
+        {
+            ssize_t written = write(render->fd, (uint8_t *)span + off,
+                                    bytes - off);
+            if (0 > written)
+            {
+                if (EINTR == errno)
+                {
+                    errno = 0;
+                    continue;
+                }
+                perror("render record");
+                errno = 0;
+                break;
+            }
+            off += (size_t)written;
+        }
+    }
+
+    vec_clear(render->log, NULL);
+    render->frames++;
+}
+
+static void
+render_record_resize (render_t *render, int32_t cols, int32_t rows)
+{
+    cell_t cell = { .glyph = ((uint32_t)cols << 16) | (uint32_t)rows };
+
+    render->cols = cols;
+    render_record_put(render, -1, -1, &cell);
+}
+
+// =============================================================================
+//                              GRAPHICS BACKENDS
+// =============================================================================
+
+/*
+ * Append LEN bytes at DATA as base64.
+ */
+static void
+render_base64 (frame_t *frame, const uint8_t *data, size_t len)
+{
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                 "abcdefghijklmnopqrstuvwxyz0123456789+/";
+    char              quad[4];
+
+    for (size_t i = 0; i < len; i += 3)
+    {
+        uint32_t bits = (uint32_t)data[i] << 16;
+        bits |= (i + 1 < len) ? ((uint32_t)data[i + 1] << 8) : 0;
+        bits |= (i + 2 < len) ? (uint32_t)data[i + 2] : 0;
+
+        quad[0] = digits[(bits >> 18) & 0x3F];
+        quad[1] = digits[(bits >> 12) & 0x3F];
+        quad[2] = (i + 1 < len) ? digits[(bits >> 6) & 0x3F] : '=';
+        quad[3] = (i + 2 < len) ? digits[bits & 0x3F] : '=';
+        frame_put(frame, quad, 4);
+    }
+}
+
+/*
+ * Transmit every sprite (not the blank one) once, as RGBA, in escapes of at
+ * most RENDER_CHUNK base64 bytes. The terminal keeps them by id.
+ */
+static void
+render_kitty_upload (render_t *render)
+{
+    int32_t cw    = 0;
+    int32_t ch    = 0;
+    sprite_size(render->sprite, &cw, &ch);
+    size_t  bytes = (size_t)cw * (size_t)ch * 4;
+    size_t  step  = (RENDER_CHUNK / 4) * 3;
+
+    for (int32_t i = 0; i < SPRITE_BLANK; ++i)
+    {
+        const uint8_t *rgba = sprite_pixels(render->sprite, i);
+        for (size_t off = 0; off < bytes; off += step)
+        {
+            size_t len = ((bytes - off) < step) ? (bytes - off) : step;
+            if (0 == off)
+            {
+                frame_printf(render->frame,
+                             "\033_Ga=t,f=32,s=%d,v=%d,i=%d,q=2,m=%d;",
+                             (int)cw, (int)ch, (int)(RENDER_KITTY_ID + i),
+                             (off + len < bytes) ? 1 : 0);
+            }
+            else
+            {
+                frame_printf(render->frame, "\033_Gm=%d;",
+                             (off + len < bytes) ? 1 : 0);
+            }
+            render_base64(render->frame, rgba + off, len);
+            frame_put(render->frame, "\033\\", 2);
+        }
+    }
+    render->b_sent = true;
+}
+
+/*
+ * Swap the sprite at cell I (column X, row Y) for WANT: drop the placement
+ * of what is shown, then place WANT (kitty), or paint WANT over it (Sixel).
+ */
+static inline __attribute__((always_inline)) void
+render_gfx_cell (render_t *render, int32_t x, int32_t y, size_t i,
+                 const render_kind_t kind)
+{
+    uint16_t want  = render->want[i];
+    uint16_t shown = render->shown[i];
+
+    if (RENDER_KITTY == kind)
+    {
+        // a placement id per cell, so a cell's placement can be found again
+        if (SPRITE_BLANK != shown)
+        {
+            frame_printf(render->frame, "\033_Ga=d,d=i,i=%d,p=%u,q=2\033\\",
+                         (int)(RENDER_KITTY_ID + shown), (unsigned)(i + 1));
+        }
+        if (SPRITE_BLANK != want)
+        {
+            render_move(render, x, y);
+            frame_printf(render->frame,
+                         "\033_Ga=p,i=%d,p=%u,c=1,r=1,C=1,q=2\033\\",
+                         (int)(RENDER_KITTY_ID + want), (unsigned)(i + 1));
+            render->x = x; // C=1: the cursor stays
+            render->y = y;
+        }
+    }
+    else
+    {
+        size_t         len  = 0;
+        const uint8_t *dcs  = sprite_sixel(render->sprite, want,
+                                           (y == render->rows - 1), &len);
+        render_move(render, x, y);
+        frame_put(render->frame, dcs, len);
+        render->x = RENDER_UNKNOWN; // where Sixel leaves it varies
+        render->y = RENDER_UNKNOWN;
+    }
+    render->shown[i] = want;
+}
+
+/*
+ * Send the cells whose sprite changed, row by row, until the next one could
+ * take the frame past the budget. The rest stay pending for the next frame.
+ */
+static inline __attribute__((always_inline)) void
+render_gfx_flush (render_t *render, const render_kind_t kind)
+{
+    size_t start = 0;
+    size_t spent = 0;
+    frame_data(render->frame, &start);
+
+    for (int32_t y = 0; (NULL != render->pending) && (y < render->rows); ++y)
+    {
+        uint64_t bit = (uint64_t)1 << (y % 64);
+        if (!(render->pending[y / 64] & bit))
+        {
+            continue;
+        }
+
+        for (int32_t x = 0; x < render->cols; ++x)
+        {
+            size_t i = ((size_t)y * (size_t)render->cols) + (size_t)x;
+            if (render->want[i] == render->shown[i])
+            {
+                continue;
+            }
+
+            size_t cost = RENDER_PLACE;
+            if (RENDER_SIXEL == kind)
+            {
+                sprite_sixel(render->sprite, render->want[i],
+                             (y == render->rows - 1), &cost);
+                cost += RENDER_MOVE;
+            }
+            if ((0 < render->budget) && (0 < spent)
+                && (spent + cost > render->budget))
+            {
+                return; // over budget: this row onward waits
+            }
+
+            render_gfx_cell(render, x, y, i, kind);
+            frame_data(render->frame, &spent);
+            spent -= start;
+        }
+        render->pending[y / 64] &= ~bit;
+    }
+}
+
+static void
+render_gfx_put (render_t *render, int32_t x, int32_t y, const cell_t *cell)
+{
+    if ((NULL == render->want) || (0 > x) || (0 > y) || (x >= render->cols)
+        || (y >= render->rows))
+    {
+        return;
+    }
+
+    size_t i        = ((size_t)y * (size_t)render->cols) + (size_t)x;
+    render->want[i] = (uint16_t)sprite_pick(render->sprite, cell);
+    if (render->want[i] != render->shown[i])
+    {
+        render->pending[y / 64] |= (uint64_t)1 << (y % 64);
+    }
+}
+
+static void
+render_kitty_end (render_t *render)
+{
+    render_gfx_flush(render, RENDER_KITTY);
+    render->frames++;
+}
+
+static void
+render_sixel_end (render_t *render)
+{
+    render_gfx_flush(render, RENDER_SIXEL);
+    render->frames++;
+}
+
+/*
+ * Clear the screen and start from every cell blank.
+ */
+static void
+render_gfx_resize (render_t *render, int32_t cols, int32_t rows)
+{
+    size_t cells = (size_t)cols * (size_t)rows;
+    size_t words = ((size_t)rows + 63) / 64;
+
+    free(render->want);
+    free(render->shown);
+    free(render->pending);
+    render->want    = malloc(cells * sizeof(*render->want));
+    render->shown   = malloc(cells * sizeof(*render->shown));
+    render->pending = calloc(words, sizeof(*render->pending));
+    if ((NULL == render->want) || (NULL == render->shown)
+        || (NULL == render->pending))
+    {
+        perror("render resize");
+        errno = 0;
+        free(render->want);
+        free(render->shown);
+        free(render->pending);
+        render->want    = NULL;
+        render->shown   = NULL;
+        render->pending = NULL;
+        cols = rows = 0;
+    }
+    for (size_t i = 0; (NULL != render->want) && (i < cells); ++i)
+    {
+        render->want[i]  = SPRITE_BLANK;
+        render->shown[i] = SPRITE_BLANK;
+    }
+    render->rows = rows;
+
+    render_term_resize(render, cols, rows);
+}
+
+/*
+ * Drop every placement of ours too (the images stay), and upload the
+ * sprites the first time.
+ */
+static void
+render_kitty_resize (render_t *render, int32_t cols, int32_t rows)
+{
+    frame_put(render->frame, "\033_Ga=d,d=a,q=2\033\\", 16);
+    if (!render->b_sent)
+    {
+        render_kitty_upload(render);
+    }
+    render_gfx_resize(render, cols, rows);
+}
+
+static void
+render_kitty_leave (render_t *render)
+{
+    // every placement and image, freed
+    frame_put(render->frame, "\033_Ga=d,d=A,q=2\033\\", 16);
+    render_term_leave(render);
+}
+
+static const render_ops_t g_render_ops[] = {
+    [RENDER_TRUECOLOR] = { "truecolor", render_term_begin,
+                           render_truecolor_put, render_term_end,
+                           render_term_resize, render_term_leave },
+    [RENDER_256]       = { "256", render_term_begin, render_256_put,
+                           render_term_end, render_term_resize,
+                           render_term_leave },
+    [RENDER_16]        = { "16", render_term_begin, render_16_put,
+                           render_term_end, render_term_resize,
+                           render_term_leave },
+    [RENDER_MONO]      = { "mono", render_term_begin, render_mono_put,
+                           render_term_end, render_term_resize,
+                           render_term_leave },
+    [RENDER_NULL]      = { "null", render_null_begin, render_null_put,
+                           render_null_end, render_null_resize,
+                           render_null_leave },
+    [RENDER_RECORD]    = { "record", render_null_begin, render_record_put,
+                           render_record_end, render_record_resize,
+                           render_null_leave },
+    [RENDER_KITTY]     = { "kitty", render_term_begin, render_gfx_put,
+                           render_kitty_end, render_kitty_resize,
+                           render_kitty_leave },
+    [RENDER_SIXEL]     = { "sixel", render_term_begin, render_gfx_put,
+                           render_sixel_end, render_gfx_resize,
+                           render_term_leave },
+};
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+
+render_kind_t
+render_detect (void)
+{
+    render_kind_t kind      = RENDER_16;
+    const char   *term      = getenv("TERM");
+    const char   *colorterm = getenv("COLORTERM");
+
+    if ((NULL != colorterm)
+        && ((0 == strcmp(colorterm, "truecolor"))
+            || (0 == strcmp(colorterm, "24bit"))))
+    {
+        kind = RENDER_TRUECOLOR;
+    }
+    else if ((NULL == term) || ('\0' == term[0])
+             || (0 == strcmp(term, "dumb")))
+    {
+        kind = RENDER_MONO;
+    }
+    else if ((NULL != strstr(term, "truecolor"))
+             || (NULL != strstr(term, "direct")))
+    {
+        kind = RENDER_TRUECOLOR;
+    }
+    else if (NULL != strstr(term, "256color"))
+    {
+        kind = RENDER_256;
+    }
+
+    return kind;
+}
+
+int32_t
+render_parse (const char *name, render_kind_t *kind)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == name) || (NULL == kind))
+    {
+        goto RENDER_PARSE_RET;
+    }
+
+    for (size_t i = 0; i < (sizeof(g_render_ops) / sizeof(g_render_ops[0]));
+         ++i)
+    {
+        if (0 == strcmp(name, g_render_ops[i].name))
+        {
+            *kind   = (render_kind_t)i;
+            ret_val = RETVAL_SUCCESS;
+            break;
+        }
+    }
+
+RENDER_PARSE_RET:
+    return ret_val;
+}
+
+render_t *
+render_create (render_kind_t kind, const char *path)
+{
+    render_t *render = NULL;
+    if ((unsigned)kind >= (sizeof(g_render_ops) / sizeof(g_render_ops[0])))
+    {
+        goto RENDER_CREATE_RET;
+    }
+
+    render = calloc(1, sizeof(*render));
+    if (NULL == render)
+    {
+        perror("render create");
+        errno = 0;
+        goto RENDER_CREATE_RET;
+    }
+
+    render->ops = &g_render_ops[kind];
+    render->fd  = -1;
+    render->x = render->y = render->attr = render->color = RENDER_UNKNOWN;
+
+    if (RENDER_RECORD == kind)
+    {
+        render->log = vec_create(sizeof(render_rec_t), LL_LOCK_NONE);
+        render->fd  = (NULL == path)
+                          ? -1
+                          : open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if ((NULL == render->log) || (0 > render->fd))
+        {
+            perror("render record");
+            errno = 0;
+            render_destroy(&render);
+        }
+    }
+    else if ((RENDER_KITTY == kind) || (RENDER_SIXEL == kind))
+    {
+        render->sprite = sprite_create(RENDER_CELL_W, RENDER_CELL_H);
+        if (NULL == render->sprite)
+        {
+            render_destroy(&render);
+        }
+    }
+
+RENDER_CREATE_RET:
+    return render;
+}
+
+int32_t
+render_graphics (render_t *render, int32_t cell_w, int32_t cell_h,
+                 size_t budget)
+{
+    int32_t cw = 0;
+    int32_t ch = 0;
+
+    if (NULL == render)
+    {
+        return RETVAL_FAILURE;
+    }
+    if (NULL == render->sprite)
+    {
+        return RETVAL_SUCCESS; // not a graphics backend
+    }
+
+    render->budget = budget;
+    sprite_size(render->sprite, &cw, &ch);
+    if ((cw == cell_w) && (ch == cell_h))
+    {
+        return RETVAL_SUCCESS;
+    }
+
+    sprite_t *sprite = sprite_create(cell_w, cell_h);
+    if (NULL == sprite)
+    {
+        return RETVAL_FAILURE;
+    }
+    sprite_destroy(&render->sprite);
+    render->sprite = sprite;
+    render->b_sent = false;
+
+    return RETVAL_SUCCESS;
+}
+
+void
+render_begin_frame (render_t *render, frame_t *frame)
+{
+    render->ops->begin_frame(render, frame);
+}
+
+void
+render_put_cell (render_t *render, int32_t x, int32_t y, const cell_t *cell)
+{
+    if (!render->b_left)
+    {
+        render->ops->put_cell(render, x, y, cell);
+    }
+}
+
+void
+render_end_frame (render_t *render)
+{
+    if (!render->b_left)
+    {
+        render->ops->end_frame(render);
+    }
+}
+
+void
+render_resize (render_t *render, int32_t cols, int32_t rows)
+{
+    if (!render->b_left)
+    {
+        render->ops->resize(render, cols, rows);
+    }
+}
+
+void
+render_leave (render_t *render, frame_t *frame)
+{
+    // no end_frame: the graphics backends would paint their pending cells
+    // onto the screen just cleared
+    if (NULL != render->pending)
+    {
+        memset(render->pending, 0,
+               (((size_t)render->rows + 63) / 64) * sizeof(*render->pending));
+    }
+    render->ops->begin_frame(render, frame);
+    render->ops->leave(render);
+    render->b_left = true;
+}
+
+int32_t
+render_keyframe (render_t *render, grid_t *grid, frame_t *frame)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    int32_t cols    = 0;
+    int32_t rows    = 0;
+
+    if ((NULL == render) || (NULL == frame) || render->b_left
+        || (RETVAL_SUCCESS != grid_size(grid, &cols, &rows)))
+    {
+        goto RENDER_KEYFRAME_RET;
+    }
+
+    render->ops->begin_frame(render, frame);
+    render->ops->resize(render, cols, rows);
+    for (int32_t y = 0; y < rows; ++y)
+    {
+        for (int32_t x = 0; x < cols; ++x)
+        {
+            // the screen was just cleared; empty cells are skipped over
+            const cell_t *cell = grid_get(grid, x, y);
+            if (0 != cell->glyph)
+            {
+                render->ops->put_cell(render, x, y, cell);
+            }
+        }
+    }
+    render->ops->end_frame(render);
+    ret_val = RETVAL_SUCCESS;
+
+RENDER_KEYFRAME_RET:
+    return ret_val;
+}
+
+void
+render_destroy (render_t **render)
+{
+    if ((NULL == render) || (NULL == *render))
+    {
+        return;
+    }
+
+    if (0 <= (*render)->fd)
+    {
+        close((*render)->fd);
+    }
+    vec_destroy(&(*render)->log, NULL);
+    sprite_destroy(&(*render)->sprite);
+    free((*render)->want);
+    free((*render)->shown);
+    free((*render)->pending);
+    free(*render);
+    *render = NULL;
+}
+
+/*** end of file ***/
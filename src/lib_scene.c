@@ -0,0 +1,1003 @@
+/** @file lib_scene.c
+ *
+ * @brief Scene Library: a software rasterizer for the pipes of a lattice_t,
+ * drawn into terminal cells as half blocks in truecolor ('▀': the foreground
+ * is the upper pixel, the background the lower one). Every piece is drawn
+ * as a round tube or sphere into a z-buffer, keeping the depth and normal of
+ * the nearest surface per pixel; the pixels are lit once all pieces are in.
+ * The screen is cut into tiles and only the tiles a changed piece covers are
+ * redrawn, split across threads, four pixels at a time with SSE2. Only cells
+ * whose pixels changed are sent.
+ *
+ */
+
+#include "lib_scene.h"
+#include "lib_trace.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define SCENE_PAR_TILES 4 // fewer dirty tiles than this are drawn inline
+#define SCENE_DISTANCE  2.5f // eye to box center, in box half-diagonals
+#define SCENE_MARGIN    0.94f // of the screen the box may take
+#define SCENE_AMBIENT   0.22f
+#define SCENE_DIFFUSE   0.78f
+#define SCENE_SPECULAR  0.55f // of white, at the center of a highlight
+#define SCENE_FOG       0.45f // darkening at the far side of the box
+#define SCENE_HALF      0x2580 // '▀'
+
+/*
+ * A piece on screen: pixel position and view depth of end A, the way to end
+ * B, and the radius along it. A sphere has INV_LEN2 of 0, so every pixel
+ * measures from A.
+ */
+typedef struct scene_prim_t
+{
+    float    ax;
+    float    ay;
+    float    za;
+    float    dx;
+    float    dy;
+    float    dz;
+    float    inv_len2; // 1 / |B - A|^2 on screen
+    float    ra; // screen radius at A
+    float    drad; // and at B, less RA
+    float    rw; // radius in view units, for the depth of the bulge
+    uint32_t rgb;
+    int32_t  x0; // pixel bounds, [X0, X1) x [Y0, Y1); empty if X0 >= X1
+    int32_t  y0;
+    int32_t  x1;
+    int32_t  y1;
+} scene_prim_t;
+
+struct scene_t
+{
+    int32_t         cols;
+    int32_t         rows;
+    int32_t         width;
+    int32_t         height;
+    int32_t         tiles_x;
+    int32_t         tiles_y;
+    float          *depth;
+    float          *norm_x;
+    float          *norm_y;
+    float          *norm_z;
+    uint32_t       *base;
+    uint32_t       *pixels;
+    uint64_t       *shown;
+    uint8_t        *dirty;
+    int32_t        *todo; // dirty tile indices, for the workers
+    int32_t         todo_len;
+    scene_prim_t   *prims;
+    size_t          count;
+    size_t          cap;
+    float           yaw;
+    float           pitch;
+    float           lo[3];
+    float           hi[3];
+    float           view[9];
+    float           center[3];
+    float           push; // added to the depth after the rotation
+    float           focal;
+    float           z_near;
+    float           z_inv; // 1 / (far - near)
+    float           light[3]; // toward the light, screen axes
+    float           half[3]; // between the light and the eye
+    bool            b_view; // a camera was set
+    bool            b_all; // reproject and redraw everything
+    bool            b_clear; // clear the terminal on the next encode
+    int32_t         threads;
+    pthread_t       workers[SCENE_MAX_THREADS];
+    pthread_mutex_t mutex;
+    pthread_cond_t  start;
+    pthread_cond_t  done;
+    uint64_t        job_gen; // bumped per job, under MUTEX
+    int32_t         pending; // workers still drawing the current job
+    bool            b_quit; // tells the workers to exit
+};
+
+typedef struct scene_worker_t
+{
+    scene_t *scene;
+    int32_t  id;
+} scene_worker_t;
+
+static void
+scene_normalize (float *v)
+{
+    float len = sqrtf((v[0] * v[0]) + (v[1] * v[1]) + (v[2] * v[2]));
+    v[0] /= len;
+    v[1] /= len;
+    v[2] /= len;
+}
+
+/*
+ * POINT in view space: centered, rotated, and pushed back from the eye.
+ */
+static void
+scene_view (const scene_t *scene, const float *point, float *out)
+{
+    float p[3] = { point[0] - scene->center[0], point[1] - scene->center[1],
+                   point[2] - scene->center[2] };
+
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        out[i] = (scene->view[(i * 3) + 0] * p[0])
+                 + (scene->view[(i * 3) + 1] * p[1])
+                 + (scene->view[(i * 3) + 2] * p[2]);
+    }
+    out[2] += scene->push;
+}
+
+/*
+ * Set the view from the camera and fit the box to the screen: the focal
+ * length is the largest at which all eight corners are on it.
+ */
+static void
+scene_fit (scene_t *scene)
+{
+    float cy = cosf(scene->yaw);
+    float sy = sinf(scene->yaw);
+    float cp = cosf(scene->pitch);
+    float sp = sinf(scene->pitch);
+
+    // turn about y, then tip the top toward the eye
+    float view[9] = {
+        cy,       0.0f, sy,
+        sp * -sy, cp,   sp * cy,
+        cp * -sy, -sp,  cp * cy,
+    };
+    memcpy(scene->view, view, sizeof(view));
+
+    float radius = 0.0f;
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        float half        = (scene->hi[i] - scene->lo[i]) / 2.0f;
+        scene->center[i]  = scene->lo[i] + half;
+        radius           += half * half;
+    }
+    radius        = sqrtf(radius);
+    scene->push   = SCENE_DISTANCE * radius;
+    scene->z_near = scene->push - radius;
+    scene->z_inv  = 1.0f / (2.0f * radius);
+
+    float most_x = FLT_MIN;
+    float most_y = FLT_MIN;
+    for (int32_t corner = 0; corner < 8; ++corner)
+    {
+        float point[3] = { (corner & 1) ? scene->hi[0] : scene->lo[0],
+                           (corner & 2) ? scene->hi[1] : scene->lo[1],
+                           (corner & 4) ? scene->hi[2] : scene->lo[2] };
+        float out[3];
+        scene_view(scene, point, out);
+        most_x = fmaxf(most_x, fabsf(out[0] / out[2]));
+        most_y = fmaxf(most_y, fabsf(out[1] / out[2]));
+    }
+
+    scene->focal = SCENE_MARGIN
+                   * fminf((float)scene->width / (2.0f * most_x),
+                           (float)scene->height / (2.0f * most_y));
+}
+
+/*
+ * Put PIECE on screen as PRIM.
+ */
+static void
+scene_project (const scene_t *scene, const lattice_piece_t *piece,
+               scene_prim_t *prim)
+{
+    float a[3];
+    float b[3];
+    scene_view(scene, piece->a, a);
+    scene_view(scene, piece->b, b);
+
+    *prim = (scene_prim_t){ .rgb = piece->rgb };
+    if ((a[2] <= piece->radius) || (b[2] <= piece->radius))
+    {
+        return; // at or behind the eye: not drawn
+    }
+
+    float half_w = (float)scene->width / 2.0f;
+    float half_h = (float)scene->height / 2.0f;
+    float ax     = half_w + (scene->focal * a[0] / a[2]);
+    float ay     = half_h - (scene->focal * a[1] / a[2]);
+    float bx     = half_w + (scene->focal * b[0] / b[2]);
+    float by     = half_h - (scene->focal * b[1] / b[2]);
+    float ra     = scene->focal * piece->radius / a[2];
+    float rb     = scene->focal * piece->radius / b[2];
+    float len2   = ((bx - ax) * (bx - ax)) + ((by - ay) * (by - ay));
+
+    prim->ax       = ax;
+    prim->ay       = ay;
+    prim->za       = a[2];
+    prim->dx       = bx - ax;
+    prim->dy       = by - ay;
+    prim->dz       = b[2] - a[2];
+    prim->inv_len2 = (len2 > 1e-6f) ? (1.0f / len2) : 0.0f;
+    prim->ra       = ra;
+    prim->drad     = rb - ra;
+    prim->rw       = piece->radius;
+
+    int32_t x0 = (int32_t)floorf(fminf(ax - ra, bx - rb));
+    int32_t y0 = (int32_t)floorf(fminf(ay - ra, by - rb));
+    int32_t x1 = (int32_t)ceilf(fmaxf(ax + ra, bx + rb));
+    int32_t y1 = (int32_t)ceilf(fmaxf(ay + ra, by + rb));
+    prim->x0   = (x0 < 0) ? 0 : x0;
+    prim->y0   = (y0 < 0) ? 0 : y0;
+    prim->x1   = (x1 > scene->width) ? scene->width : x1;
+    prim->y1   = (y1 > scene->height) ? scene->height : y1;
+}
+
+static void
+scene_mark (scene_t *scene, const scene_prim_t *prim)
+{
+    if ((prim->x0 >= prim->x1) || (prim->y0 >= prim->y1))
+    {
+        return;
+    }
+
+    for (int32_t ty = prim->y0 / SCENE_TILE_H;
+         ty <= (prim->y1 - 1) / SCENE_TILE_H; ++ty)
+    {
+        memset(scene->dirty + (ty * scene->tiles_x) + (prim->x0 / SCENE_TILE_W),
+               1,
+               (size_t)(((prim->x1 - 1) / SCENE_TILE_W)
+                        - (prim->x0 / SCENE_TILE_W) + 1));
+    }
+}
+
+/*
+ * One pixel of PRIM at I, centered at PX, PY: the nearest point of the tube
+ * axis on screen, then the depth and normal of the surface over it.
+ */
+static inline void
+scene_px (scene_t *scene, const scene_prim_t *prim, size_t i, float px,
+          float py)
+{
+    float rx = px - prim->ax;
+    float ry = py - prim->ay;
+    float t  = ((rx * prim->dx) + (ry * prim->dy)) * prim->inv_len2;
+    t        = (t < 0.0f) ? 0.0f : ((t > 1.0f) ? 1.0f : t);
+
+    float inv = 1.0f / (prim->ra + (t * prim->drad));
+    float nx  = (rx - (t * prim->dx)) * inv;
+    float ny  = (ry - (t * prim->dy)) * inv;
+    float q   = (nx * nx) + (ny * ny);
+    if (q >= 1.0f)
+    {
+        return;
+    }
+
+    float nz = sqrtf(1.0f - q);
+    float z  = prim->za + (t * prim->dz) - (prim->rw * nz);
+    if (z >= scene->depth[i])
+    {
+        return;
+    }
+
+    scene->depth[i]  = z;
+    scene->norm_x[i] = nx;
+    scene->norm_y[i] = ny;
+    scene->norm_z[i] = nz;
+    scene->base[i]   = prim->rgb;
+}
+
+/*
+ * Draw PRIM over pixels [X0, X1) of row Y.
+ */
+static void
+scene_span (scene_t *scene, const scene_prim_t *prim, int32_t y, int32_t x0,
+            int32_t x1)
+{
+    size_t  row = (size_t)y * (size_t)scene->width;
+    float   py  = (float)y + 0.5f;
+    int32_t x   = x0;
+
+#if defined(__SSE2__)
+    const __m128 one   = _mm_set1_ps(1.0f);
+    const __m128 zero  = _mm_setzero_ps();
+    const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 ry    = _mm_set1_ps(py - prim->ay);
+    const __m128 dx    = _mm_set1_ps(prim->dx);
+    const __m128 dy    = _mm_set1_ps(prim->dy);
+    const __m128 dz    = _mm_set1_ps(prim->dz);
+    const __m128 ry_dy = _mm_mul_ps(ry, dy);
+    const __m128 inv_l = _mm_set1_ps(prim->inv_len2);
+    const __m128 ra    = _mm_set1_ps(prim->ra);
+    const __m128 drad  = _mm_set1_ps(prim->drad);
+    const __m128 za    = _mm_set1_ps(prim->za);
+    const __m128 rw    = _mm_set1_ps(prim->rw);
+    const __m128i rgb  = _mm_set1_epi32((int)prim->rgb);
+
+    for (; (x + 4) <= x1; x += 4)
+    {
+        size_t i  = row + (size_t)x;
+        __m128 rx = _mm_add_ps(_mm_set1_ps((float)x - prim->ax), lanes);
+        __m128 t  = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(rx, dx), ry_dy), inv_l);
+        t         = _mm_min_ps(_mm_max_ps(t, zero), one);
+
+        __m128 inv = _mm_div_ps(one, _mm_add_ps(ra, _mm_mul_ps(t, drad)));
+        __m128 nx  = _mm_mul_ps(_mm_sub_ps(rx, _mm_mul_ps(t, dx)), inv);
+        __m128 ny  = _mm_mul_ps(_mm_sub_ps(ry, _mm_mul_ps(t, dy)), inv);
+        __m128 q   = _mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny));
+        __m128 nz  = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, q), zero));
+        __m128 z   = _mm_sub_ps(_mm_add_ps(za, _mm_mul_ps(t, dz)),
+                                _mm_mul_ps(rw, nz));
+
+        // inside the outline, and nearer than what is there
+        __m128 old  = _mm_loadu_ps(scene->depth + i);
+        __m128 keep = _mm_and_ps(_mm_cmplt_ps(q, one), _mm_cmplt_ps(z, old));
+        if (0 == _mm_movemask_ps(keep))
+        {
+            continue;
+        }
+
+#define SCENE_BLEND(new, old) \
+    _mm_or_ps(_mm_and_ps(keep, (new)), _mm_andnot_ps(keep, (old)))
+        _mm_storeu_ps(scene->depth + i, SCENE_BLEND(z, old));
+        _mm_storeu_ps(scene->norm_x + i,
+                      SCENE_BLEND(nx, _mm_loadu_ps(scene->norm_x + i)));
+        _mm_storeu_ps(scene->norm_y + i,
+                      SCENE_BLEND(ny, _mm_loadu_ps(scene->norm_y + i)));
+        _mm_storeu_ps(scene->norm_z + i,
+                      SCENE_BLEND(nz, _mm_loadu_ps(scene->norm_z + i)));
+        __m128 base = _mm_castsi128_ps(
+            _mm_loadu_si128((const __m128i *)(scene->base + i)));
+        _mm_storeu_si128((__m128i *)(scene->base + i),
+                         _mm_castps_si128(
+                             SCENE_BLEND(_mm_castsi128_ps(rgb), base)));
+#undef SCENE_BLEND
+    }
+#endif
+
+    // scalar fallback, and the tail of the SIMD loop
+    for (; x < x1; ++x)
+    {
+        scene_px(scene, prim, row + (size_t)x, (float)x + 0.5f, py);
+    }
+}
+
+/*
+ * Light pixel I: ambient and diffuse in the piece's color, a white specular
+ * highlight, all dimmed with distance.
+ */
+static inline uint32_t
+scene_lit (const scene_t *scene, size_t i)
+{
+    float nx = scene->norm_x[i];
+    float ny = scene->norm_y[i];
+    float nz = scene->norm_z[i];
+
+    float diffuse = (nx * scene->light[0]) + (ny * scene->light[1])
+                    + (nz * scene->light[2]);
+    float spec    = (nx * scene->half[0]) + (ny * scene->half[1])
+                 + (nz * scene->half[2]);
+    diffuse = (diffuse > 0.0f) ? diffuse : 0.0f;
+    spec    = (spec > 0.0f) ? spec : 0.0f;
+    spec   *= spec; // to the 16th
+    spec   *= spec;
+    spec   *= spec;
+    spec   *= spec;
+
+    float far = (scene->depth[i] - scene->z_near) * scene->z_inv;
+    far       = (far < 0.0f) ? 0.0f : ((far > 1.0f) ? 1.0f : far);
+    float fog = 1.0f - (SCENE_FOG * far);
+    float k   = (SCENE_AMBIENT + (SCENE_DIFFUSE * diffuse)) * fog;
+    float w   = SCENE_SPECULAR * 255.0f * spec * fog;
+
+    uint32_t rgb = 0;
+    for (int32_t shift = 16; shift >= 0; shift -= 8)
+    {
+        float c = ((float)((scene->base[i] >> shift) & 0xFF) * k) + w;
+        rgb |= (uint32_t)((c > 255.0f) ? 255.0f : c) << shift;
+    }
+
+    return rgb;
+}
+
+/*
+ * Light pixels [X0, X1) of row Y.
+ */
+static void
+scene_shade (scene_t *scene, int32_t y, int32_t x0, int32_t x1)
+{
+    size_t  row = (size_t)y * (size_t)scene->width;
+    int32_t x   = x0;
+
+#if defined(__SSE2__)
+    const __m128  zero   = _mm_setzero_ps();
+    const __m128  one    = _mm_set1_ps(1.0f);
+    const __m128  top    = _mm_set1_ps(255.0f);
+    const __m128  lx     = _mm_set1_ps(scene->light[0]);
+    const __m128  ly     = _mm_set1_ps(scene->light[1]);
+    const __m128  lz     = _mm_set1_ps(scene->light[2]);
+    const __m128  hx     = _mm_set1_ps(scene->half[0]);
+    const __m128  hy     = _mm_set1_ps(scene->half[1]);
+    const __m128  hz     = _mm_set1_ps(scene->half[2]);
+    const __m128  near   = _mm_set1_ps(scene->z_near);
+    const __m128  z_inv  = _mm_set1_ps(scene->z_inv);
+    const __m128  fog    = _mm_set1_ps(SCENE_FOG);
+    const __m128  amb    = _mm_set1_ps(SCENE_AMBIENT);
+    const __m128  dif    = _mm_set1_ps(SCENE_DIFFUSE);
+    const __m128  white  = _mm_set1_ps(SCENE_SPECULAR * 255.0f);
+    const __m128i byte   = _mm_set1_epi32(0xFF);
+
+    for (; (x + 4) <= x1; x += 4)
+    {
+        size_t i  = row + (size_t)x;
+        __m128 nx = _mm_loadu_ps(scene->norm_x + i);
+        __m128 ny = _mm_loadu_ps(scene->norm_y + i);
+        __m128 nz = _mm_loadu_ps(scene->norm_z + i);
+
+        __m128 diffuse = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, lx),
+                                               _mm_mul_ps(ny, ly)),
+                                    _mm_mul_ps(nz, lz));
+        __m128 spec    = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, hx),
+                                               _mm_mul_ps(ny, hy)),
+                                    _mm_mul_ps(nz, hz));
+        diffuse = _mm_max_ps(diffuse, zero);
+        spec    = _mm_max_ps(spec, zero);
+        spec    = _mm_mul_ps(spec, spec); // to the 16th
+        spec    = _mm_mul_ps(spec, spec);
+        spec    = _mm_mul_ps(spec, spec);
+        spec    = _mm_mul_ps(spec, spec);
+
+        __m128 far = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(scene->depth + i),
+                                           near),
+                                z_inv);
+        far        = _mm_min_ps(_mm_max_ps(far, zero), one);
+        __m128 dim = _mm_sub_ps(one, _mm_mul_ps(fog, far));
+        __m128 k   = _mm_mul_ps(_mm_add_ps(amb, _mm_mul_ps(dif, diffuse)),
+                                dim);
+        __m128 w   = _mm_mul_ps(_mm_mul_ps(white, spec), dim);
+
+        __m128i base = _mm_loadu_si128((const __m128i *)(scene->base + i));
+        __m128i rgb  = _mm_setzero_si128();
+        for (int32_t shift = 16; shift >= 0; shift -= 8)
+        {
+            __m128 c = _mm_cvtepi32_ps(
+                _mm_and_si128(_mm_srli_epi32(base, shift), byte));
+            c = _mm_min_ps(_mm_add_ps(_mm_mul_ps(c, k), w), top);
+            rgb = _mm_or_si128(rgb, _mm_slli_epi32(_mm_cvttps_epi32(c),
+                                                   shift));
+        }
+        _mm_storeu_si128((__m128i *)(scene->pixels + i), rgb);
+    }
+#endif
+
+    // scalar fallback, and the tail of the SIMD loop
+    for (; x < x1; ++x)
+    {
+        scene->pixels[row + (size_t)x] = scene_lit(scene, row + (size_t)x);
+    }
+}
+
+/*
+ * Redraw tile TILE from scratch: clear it, draw every piece that reaches
+ * into it, then light it.
+ */
+static void
+scene_tile (scene_t *scene, int32_t tile)
+{
+    int32_t x0 = (tile % scene->tiles_x) * SCENE_TILE_W;
+    int32_t y0 = (tile / scene->tiles_x) * SCENE_TILE_H;
+    int32_t x1 = (x0 + SCENE_TILE_W < scene->width) ? x0 + SCENE_TILE_W
+                                                   : scene->width;
+    int32_t y1 = (y0 + SCENE_TILE_H < scene->height) ? y0 + SCENE_TILE_H
+                                                    : scene->height;
+
+    // nothing there: far away, unlit, black
+    for (int32_t y = y0; y < y1; ++y)
+    {
+        size_t row = ((size_t)y * (size_t)scene->width) + (size_t)x0;
+        size_t len = (size_t)(x1 - x0);
+        for (size_t i = row; i < row + len; ++i)
+        {
+            scene->depth[i] = FLT_MAX;
+        }
+        memset(scene->norm_x + row, 0, len * sizeof(*scene->norm_x));
+        memset(scene->norm_y + row, 0, len * sizeof(*scene->norm_y));
+        memset(scene->norm_z + row, 0, len * sizeof(*scene->norm_z));
+        memset(scene->base + row, 0, len * sizeof(*scene->base));
+    }
+
+    for (size_t p = 0; p < scene->count; ++p)
+    {
+        const scene_prim_t *prim = scene->prims + p;
+        if ((prim->x1 <= x0) || (prim->x0 >= x1) || (prim->y1 <= y0)
+            || (prim->y0 >= y1))
+        {
+            continue;
+        }
+
+        int32_t sx0 = (prim->x0 > x0) ? prim->x0 : x0;
+        int32_t sx1 = (prim->x1 < x1) ? prim->x1 : x1;
+        int32_t sy1 = (prim->y1 < y1) ? prim->y1 : y1;
+        for (int32_t y = (prim->y0 > y0) ? prim->y0 : y0; y < sy1; ++y)
+        {
+            scene_span(scene, prim, y, sx0, sx1);
+        }
+    }
+
+    for (int32_t y = y0; y < y1; ++y)
+    {
+        scene_shade(scene, y, x0, x1);
+    }
+}
+
+/*
+ * Thread ID of THREADS draws every THREADS-th dirty tile.
+ */
+static void
+scene_tiles (scene_t *scene, int32_t id, int32_t threads)
+{
+    for (int32_t k = id; k < scene->todo_len; k += threads)
+    {
+        scene_tile(scene, scene->todo[k]);
+    }
+}
+
+static void *
+scene_worker (void *arg)
+{
+    scene_worker_t *worker = arg;
+    scene_t        *scene  = worker->scene;
+    uint64_t        seen   = 0;
+
+    pthread_mutex_lock(&scene->mutex);
+    for (;;)
+    {
+        while (seen == scene->job_gen)
+        {
+            pthread_cond_wait(&scene->start, &scene->mutex);
+        }
+        seen = scene->job_gen;
+        if (scene->b_quit)
+        {
+            break;
+        }
+
+        pthread_mutex_unlock(&scene->mutex);
+        scene_tiles(scene, worker->id, scene->threads);
+        pthread_mutex_lock(&scene->mutex);
+
+        if (0 == --scene->pending)
+        {
+            pthread_cond_signal(&scene->done);
+        }
+    }
+    pthread_mutex_unlock(&scene->mutex);
+
+    free(worker);
+    return NULL;
+}
+
+/*
+ * WHICH ("38;2;" or "48;2;", maybe after a ';') and the color as "%d;%d;%d";
+ * the caller opens and closes the SGR.
+ */
+static void
+scene_sgr (frame_t *frame, const char *which, uint32_t rgb)
+{
+    frame_put(frame, which, strlen(which));
+    frame_putnum(frame, (rgb >> 16) & 0xFF);
+    frame_put(frame, ";", 1);
+    frame_putnum(frame, (rgb >> 8) & 0xFF);
+    frame_put(frame, ";", 1);
+    frame_putnum(frame, rgb & 0xFF);
+}
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+
+scene_t *
+scene_create (int32_t threads)
+{
+    if (threads <= 0)
+    {
+        threads = (int32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    threads = (threads < 1) ? 1 : threads;
+    threads = (threads > SCENE_MAX_THREADS) ? SCENE_MAX_THREADS : threads;
+
+    scene_t *scene = calloc(1, sizeof(*scene));
+    if (NULL == scene)
+    {
+        perror("scene create");
+        errno = 0;
+        goto SCENE_CREATE_RET;
+    }
+
+    // from the upper left, in front; the highlight sits between it and the eye
+    float light[3] = { -0.45f, -0.55f, 0.70f };
+    scene_normalize(light);
+    float half[3] = { light[0], light[1], light[2] + 1.0f };
+    scene_normalize(half);
+    memcpy(scene->light, light, sizeof(light));
+    memcpy(scene->half, half, sizeof(half));
+    scene->threads = 1;
+
+    pthread_mutex_init(&scene->mutex, NULL);
+    pthread_cond_init(&scene->start, NULL);
+    pthread_cond_init(&scene->done, NULL);
+
+    // the caller is thread 0; run with however many workers could start
+    for (int32_t i = 1; i < threads; ++i)
+    {
+        scene_worker_t *worker = malloc(sizeof(*worker));
+        if (NULL == worker)
+        {
+            break;
+        }
+        worker->scene = scene;
+        worker->id    = i;
+
+        if (0 != pthread_create(&scene->workers[i], NULL, scene_worker,
+                                worker))
+        {
+            free(worker);
+            errno = 0;
+            break;
+        }
+        scene->threads = i + 1;
+    }
+
+SCENE_CREATE_RET:
+    return scene;
+}
+
+int32_t
+scene_resize (scene_t *scene, int32_t cols, int32_t rows)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == scene) || (cols < 1) || (rows < 1))
+    {
+        goto SCENE_RESIZE_RET;
+    }
+
+    if ((cols != scene->cols) || (rows != scene->rows))
+    {
+        size_t  cells   = (size_t)cols * (size_t)rows;
+        size_t  pixels  = cells * 2;
+        int32_t tiles_x = (cols + SCENE_TILE_W - 1) / SCENE_TILE_W;
+        int32_t tiles_y = ((rows * 2) + SCENE_TILE_H - 1) / SCENE_TILE_H;
+        size_t  tiles   = (size_t)tiles_x * (size_t)tiles_y;
+
+        float    *depth  = malloc(pixels * sizeof(*depth));
+        float    *norm_x = malloc(pixels * sizeof(*norm_x));
+        float    *norm_y = malloc(pixels * sizeof(*norm_y));
+        float    *norm_z = malloc(pixels * sizeof(*norm_z));
+        uint32_t *base   = malloc(pixels * sizeof(*base));
+        uint32_t *pix    = calloc(pixels, sizeof(*pix));
+        uint64_t *shown  = malloc(cells * sizeof(*shown));
+        uint8_t  *dirty  = malloc(tiles);
+        int32_t  *todo   = malloc(tiles * sizeof(*todo));
+        if ((NULL == depth) || (NULL == norm_x) || (NULL == norm_y)
+            || (NULL == norm_z) || (NULL == base) || (NULL == pix)
+            || (NULL == shown) || (NULL == dirty) || (NULL == todo))
+        {
+            perror("scene resize");
+            errno = 0;
+            free(depth);
+            free(norm_x);
+            free(norm_y);
+            free(norm_z);
+            free(base);
+            free(pix);
+            free(shown);
+            free(dirty);
+            free(todo);
+            goto SCENE_RESIZE_RET;
+        }
+
+        free(scene->depth);
+        free(scene->norm_x);
+        free(scene->norm_y);
+        free(scene->norm_z);
+        free(scene->base);
+        free(scene->pixels);
+        free(scene->shown);
+        free(scene->dirty);
+        free(scene->todo);
+        scene->depth   = depth;
+        scene->norm_x  = norm_x;
+        scene->norm_y  = norm_y;
+        scene->norm_z  = norm_z;
+        scene->base    = base;
+        scene->pixels  = pix;
+        scene->shown   = shown;
+        scene->dirty   = dirty;
+        scene->todo    = todo;
+        scene->cols    = cols;
+        scene->rows    = rows;
+        scene->width   = cols;
+        scene->height  = rows * 2;
+        scene->tiles_x = tiles_x;
+        scene->tiles_y = tiles_y;
+
+        if (scene->b_view)
+        {
+            scene_fit(scene);
+        }
+    }
+
+    // the terminal was cleared or resized: everything goes out again
+    scene->b_all   = true;
+    scene->b_clear = true;
+    ret_val        = RETVAL_SUCCESS;
+
+SCENE_RESIZE_RET:
+    return ret_val;
+}
+
+int32_t
+scene_camera (scene_t *scene, float yaw, float pitch, const float *lo,
+              const float *hi)
+{
+    if ((NULL == scene) || (NULL == lo) || (NULL == hi))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    scene->yaw   = yaw;
+    scene->pitch = pitch;
+    memcpy(scene->lo, lo, sizeof(scene->lo));
+    memcpy(scene->hi, hi, sizeof(scene->hi));
+    scene->b_view = true;
+    scene->b_all  = true;
+    if (0 < scene->width)
+    {
+        scene_fit(scene);
+    }
+
+    return RETVAL_SUCCESS;
+}
+
+int32_t
+scene_draw (scene_t *scene, const lattice_piece_t *pieces, size_t count,
+            size_t first)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == scene) || (0 == scene->width) || !scene->b_view
+        || ((0 < count) && (NULL == pieces)))
+    {
+        goto SCENE_DRAW_RET;
+    }
+
+    TRACE_BEGIN("scene");
+    if (count > scene->cap)
+    {
+        size_t        cap   = (scene->cap < 64) ? 64 : scene->cap;
+        while (cap < count)
+        {
+            cap *= 2;
+        }
+        scene_prim_t *prims = realloc(scene->prims, cap * sizeof(*prims));
+        if (NULL == prims)
+        {
+            perror("scene draw");
+            errno = 0;
+            TRACE_END("scene");
+            goto SCENE_DRAW_RET;
+        }
+        scene->prims = prims;
+        scene->cap   = cap;
+    }
+
+    size_t tiles = (size_t)scene->tiles_x * (size_t)scene->tiles_y;
+    bool   b_all = scene->b_all || (count < scene->count);
+    first        = b_all ? 0 : ((first < scene->count) ? first : scene->count);
+    memset(scene->dirty, b_all ? 1 : 0, tiles);
+
+    for (size_t p = first; p < count; ++p)
+    {
+        scene_project(scene, pieces + p, scene->prims + p);
+        scene_mark(scene, scene->prims + p);
+    }
+    scene->count = count;
+    scene->b_all = false;
+
+    scene->todo_len = 0;
+    for (size_t t = 0; t < tiles; ++t)
+    {
+        if (scene->dirty[t])
+        {
+            scene->todo[scene->todo_len++] = (int32_t)t;
+        }
+    }
+
+    // only wake the workers when there is enough to share
+    if ((1 == scene->threads) || (scene->todo_len < SCENE_PAR_TILES))
+    {
+        scene_tiles(scene, 0, 1);
+    }
+    else
+    {
+        pthread_mutex_lock(&scene->mutex);
+        scene->pending = scene->threads - 1;
+        scene->job_gen++;
+        pthread_cond_broadcast(&scene->start);
+        pthread_mutex_unlock(&scene->mutex);
+
+        scene_tiles(scene, 0, scene->threads);
+
+        pthread_mutex_lock(&scene->mutex);
+        while (0 < scene->pending)
+        {
+            pthread_cond_wait(&scene->done, &scene->mutex);
+        }
+        pthread_mutex_unlock(&scene->mutex);
+    }
+    TRACE_END("scene");
+
+    ret_val = RETVAL_SUCCESS;
+
+SCENE_DRAW_RET:
+    return ret_val;
+}
+
+int64_t
+scene_encode (scene_t *scene, frame_t *frame)
+{
+    int64_t sent = -1;
+    if ((NULL == scene) || (NULL == frame) || (0 == scene->width))
+    {
+        goto SCENE_ENCODE_RET;
+    }
+
+    if (scene->b_clear)
+    {
+        // hide cursor, reset, clear screen; colors are 24 bits, so no cell
+        // matches the all-ones pair
+        frame_printf(frame, "\033[?25l\033[0m\033[2J");
+        memset(scene->shown, 0xFF,
+               (size_t)scene->cols * (size_t)scene->rows
+                   * sizeof(*scene->shown));
+        scene->b_clear = false;
+    }
+
+    int32_t cur_x = -1;
+    int32_t cur_y = -1;
+    int64_t fg    = -1;
+    int64_t bg    = -1;
+
+    sent = 0;
+    for (int32_t y = 0; y < scene->rows; ++y)
+    {
+        const uint32_t *upper = scene->pixels + ((size_t)y * 2 * scene->width);
+        const uint32_t *lower = upper + scene->width;
+        uint64_t       *shown = scene->shown + ((size_t)y * scene->cols);
+
+        for (int32_t x = 0; x < scene->cols; ++x)
+        {
+            uint64_t pair = ((uint64_t)upper[x] << 32) | lower[x];
+            if (shown[x] == pair)
+            {
+                continue;
+            }
+            shown[x] = pair;
+            sent++;
+
+            if ((cur_y == y) && (0 <= cur_x) && (cur_x < x))
+            {
+                // "\033[%dC"; a run of changed cells needs no move
+                frame_put(frame, "\033[", 2);
+                frame_putnum(frame, (uint32_t)(x - cur_x));
+                frame_put(frame, "C", 1);
+            }
+            else if ((cur_y != y) || (cur_x != x))
+            {
+                // "\033[%d;%dH"
+                frame_put(frame, "\033[", 2);
+                frame_putnum(frame, (uint32_t)(y + 1));
+                frame_put(frame, ";", 1);
+                frame_putnum(frame, (uint32_t)(x + 1));
+                frame_put(frame, "H", 1);
+            }
+
+            // a cell of one color is a space in it; otherwise the upper half
+            bool b_flat = upper[x] == lower[x];
+            bool b_fg   = !b_flat && (fg != (int64_t)upper[x]);
+            bool b_bg   = bg != (int64_t)lower[x];
+            if (b_fg || b_bg)
+            {
+                frame_put(frame, "\033[", 2);
+                if (b_fg)
+                {
+                    scene_sgr(frame, "38;2;", upper[x]);
+                }
+                if (b_bg)
+                {
+                    scene_sgr(frame, b_fg ? ";48;2;" : "48;2;", lower[x]);
+                }
+                frame_put(frame, "m", 1);
+                fg = b_fg ? (int64_t)upper[x] : fg;
+                bg = (int64_t)lower[x];
+            }
+
+            if (b_flat)
+            {
+                frame_put(frame, " ", 1);
+            }
+            else
+            {
+                frame_putwc(frame, SCENE_HALF);
+            }
+
+            // the last column leaves the cursor pending a wrap
+            cur_x = ((x + 1) < scene->cols) ? x + 1 : -1;
+            cur_y = y;
+        }
+    }
+
+    if ((0 <= fg) || (0 <= bg))
+    {
+        frame_put(frame, "\033[0m", 4); // reset
+    }
+
+SCENE_ENCODE_RET:
+    return sent;
+}
+
+const uint32_t *
+scene_pixels (scene_t *scene, int32_t *width, int32_t *height)
+{
+    const uint32_t *pixels = NULL;
+    if ((NULL == scene) || (NULL == width) || (NULL == height))
+    {
+        goto SCENE_PIXELS_RET;
+    }
+
+    *width  = scene->width;
+    *height = scene->height;
+    pixels  = scene->pixels;
+
+SCENE_PIXELS_RET:
+    return pixels;
+}
+
+void
+scene_destroy (scene_t **scene)
+{
+    if ((NULL == scene) || (NULL == *scene))
+    {
+        return;
+    }
+
+    scene_t *temp = *scene;
+
+    pthread_mutex_lock(&temp->mutex);
+    temp->b_quit = true;
+    temp->job_gen++;
+    pthread_cond_broadcast(&temp->start);
+    pthread_mutex_unlock(&temp->mutex);
+
+    for (int32_t i = 1; i < temp->threads; ++i)
+    {
+        pthread_join(temp->workers[i], NULL);
+    }
+    pthread_mutex_destroy(&temp->mutex);
+    pthread_cond_destroy(&temp->start);
+    pthread_cond_destroy(&temp->done);
+
+    free(temp->depth);
+    free(temp->norm_x);
+    free(temp->norm_y);
+    free(temp->norm_z);
+    free(temp->base);
+    free(temp->pixels);
+    free(temp->shown);
+    free(temp->dirty);
+    free(temp->todo);
+    free(temp->prims);
+    free(temp);
+    *scene = NULL;
+}
+
+/*** end of file ***/
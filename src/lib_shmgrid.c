@@ -0,0 +1,214 @@
+/** @file lib_shmgrid.c
+ *
+ * @brief Shared Grid Library: publish a grid_t into a memory-mapped file so
+ * other processes can read the cells in place. Frames are guarded by a
+ * seqlock: readers never lock or copy, they re-read if a write overlapped.
+ * On Linux a path under /dev/shm gives a POSIX shm segment.
+ *
+ */
+
+#include "lib_shmgrid.h"
+
+#include <stdbool.h>
+
+#define SHMGRID_WORD_BITS 64
+
+struct shmgrid_t
+{
+    int            fd;
+    char          *path;
+    shmgrid_hdr_t *hdr;
+    size_t         mapped;
+};
+
+/*
+ * Grow the file and our mapping to at least BYTES. Readers notice BYTES in
+ * the header and remap; their old, smaller mapping stays valid meanwhile.
+ */
+static int32_t
+shmgrid_map (shmgrid_t *shm, size_t bytes)
+{
+    int32_t ret_val = RETVAL_SUCCESS;
+    if (bytes <= shm->mapped)
+    {
+        goto SHMGRID_MAP_RET;
+    }
+
+    ret_val = RETVAL_FAILURE;
+    if (0 != ftruncate(shm->fd, (off_t)bytes))
+    {
+        perror("shmgrid ftruncate");
+        errno = 0;
+        goto SHMGRID_MAP_RET;
+    }
+
+    void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd,
+                     0);
+    if (MAP_FAILED == map)
+    {
+        perror("shmgrid mmap");
+        errno = 0;
+        goto SHMGRID_MAP_RET;
+    }
+
+    if (NULL != shm->hdr)
+    {
+        munmap(shm->hdr, shm->mapped);
+    }
+    shm->hdr    = map;
+    shm->mapped = bytes;
+    ret_val     = RETVAL_SUCCESS;
+
+SHMGRID_MAP_RET:
+    return ret_val;
+}
+
+shmgrid_t *
+shmgrid_create (const char *path)
+{
+    shmgrid_t *shm = NULL;
+    if (NULL == path)
+    {
+        goto SHMGRID_CREATE_RET;
+    }
+
+    shm = calloc(1, sizeof(*shm));
+    if (NULL == shm)
+    {
+        perror("shmgrid create");
+        errno = 0;
+        goto SHMGRID_CREATE_RET;
+    }
+
+    shm->path = strdup(path);
+    shm->fd   = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((NULL == shm->path) || (0 > shm->fd))
+    {
+        perror("shmgrid open");
+        errno = 0;
+        goto SHMGRID_CREATE_FAIL;
+    }
+
+    if (RETVAL_SUCCESS != shmgrid_map(shm, sizeof(shmgrid_hdr_t)))
+    {
+        goto SHMGRID_CREATE_FAIL;
+    }
+
+    shm->hdr->magic     = SHMGRID_MAGIC;
+    shm->hdr->version   = SHMGRID_VERSION;
+    shm->hdr->bytes     = sizeof(shmgrid_hdr_t);
+    shm->hdr->cells_off = sizeof(shmgrid_hdr_t);
+    shm->hdr->cell_size = sizeof(cell_t);
+    shm->hdr->b_live    = 1;
+    atomic_store_explicit(&shm->hdr->seq, 0, memory_order_release);
+    goto SHMGRID_CREATE_RET;
+
+SHMGRID_CREATE_FAIL:
+    if (0 <= shm->fd)
+    {
+        close(shm->fd);
+        (void)unlink(path);
+    }
+    free(shm->path);
+    free(shm);
+    shm = NULL;
+
+SHMGRID_CREATE_RET:
+    return shm;
+}
+
+int32_t
+shmgrid_publish (shmgrid_t *shm, grid_t *grid)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    int32_t cols    = 0;
+    int32_t rows    = 0;
+    size_t  words   = 0;
+
+    if ((NULL == shm) || (RETVAL_SUCCESS != grid_size(grid, &cols, &rows)))
+    {
+        goto SHMGRID_PUBLISH_RET;
+    }
+
+    if (rows > SHMGRID_MAX_ROWS)
+    {
+        fprintf(stderr, "shmgrid: more than %d rows\n", SHMGRID_MAX_ROWS);
+        goto SHMGRID_PUBLISH_RET;
+    }
+
+    const uint64_t *dirty = grid_dirty(grid, &words);
+    bool b_all = ((uint32_t)cols != shm->hdr->cols)
+                 || ((uint32_t)rows != shm->hdr->rows);
+
+    if (!b_all && (0 == grid_dirty_rows(grid)))
+    {
+        ret_val = RETVAL_SUCCESS; // nothing changed; no new generation
+        goto SHMGRID_PUBLISH_RET;
+    }
+
+    size_t row_bytes = (size_t)cols * sizeof(cell_t);
+    size_t bytes     = sizeof(shmgrid_hdr_t) + (row_bytes * (size_t)rows);
+
+    // odd SEQ: readers back off until the generation is complete
+    uint64_t seq = atomic_load_explicit(&shm->hdr->seq, memory_order_relaxed);
+    atomic_store_explicit(&shm->hdr->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if (RETVAL_SUCCESS != shmgrid_map(shm, bytes))
+    {
+        // leave the previous generation readable
+        atomic_store_explicit(&shm->hdr->seq, seq, memory_order_release);
+        goto SHMGRID_PUBLISH_RET;
+    }
+
+    shmgrid_hdr_t *hdr = shm->hdr;
+    uint8_t       *out = (uint8_t *)hdr + hdr->cells_off;
+
+    hdr->cols  = (uint32_t)cols;
+    hdr->rows  = (uint32_t)rows;
+    hdr->bytes = (hdr->bytes > bytes) ? hdr->bytes : bytes;
+    memset(hdr->dirty, 0, sizeof(hdr->dirty));
+
+    for (int32_t y = 0; y < rows; ++y)
+    {
+        uint64_t bit = (uint64_t)1 << (y % SHMGRID_WORD_BITS);
+        if (!b_all && !(dirty[y / SHMGRID_WORD_BITS] & bit))
+        {
+            continue;
+        }
+
+        memcpy(out + ((size_t)y * row_bytes), grid_get(grid, 0, y), row_bytes);
+        hdr->dirty[y / SHMGRID_WORD_BITS] |= bit;
+    }
+
+    atomic_store_explicit(&hdr->seq, seq + 2, memory_order_release);
+    ret_val = RETVAL_SUCCESS;
+
+SHMGRID_PUBLISH_RET:
+    return ret_val;
+}
+
+void
+shmgrid_destroy (shmgrid_t **shm)
+{
+    if ((NULL == shm) || (NULL == *shm))
+    {
+        return;
+    }
+
+    shmgrid_hdr_t *hdr = (*shm)->hdr;
+    uint64_t seq = atomic_load_explicit(&hdr->seq, memory_order_relaxed);
+    atomic_store_explicit(&hdr->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    hdr->b_live = 0;
+    atomic_store_explicit(&hdr->seq, seq + 2, memory_order_release);
+
+    munmap(hdr, (*shm)->mapped);
+    close((*shm)->fd);
+    (void)unlink((*shm)->path);
+    free((*shm)->path);
+    free(*shm);
+    *shm = NULL;
+}
+
+/*** end of file ***/
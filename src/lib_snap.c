@@ -0,0 +1,256 @@
+/** @file lib_snap.c
+ *
+ * @brief Snapshot Library: save the grid and the simulation state to a
+ * compact binary file, and restore them by mapping the file and copying the
+ * cells straight in.
+ *
+ */
+
+#include "lib_snap.h"
+
+#define SNAP_SUM_PRIME 0x100000001b3ULL // FNV-1a's, a word at a time
+
+struct snap_t
+{
+    snap_hdr_t *hdr;
+    size_t      mapped;
+};
+
+/*
+ * Checksum of everything after the SUM field: the state, then the cells.
+ * Both are whole words, so this is one multiply per 8 bytes.
+ */
+static uint64_t
+snap_sum (const snap_hdr_t *hdr, const cell_t *cells, size_t n_cells)
+{
+    uint64_t sum = 0xcbf29ce484222325ULL;
+    uint64_t word = 0;
+
+    const uint8_t *state = (const uint8_t *)&hdr->state;
+    for (size_t i = 0; i < sizeof(hdr->state); i += sizeof(word))
+    {
+        memcpy(&word, state + i, sizeof(word));
+        sum = (sum ^ word) * SNAP_SUM_PRIME;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)cells;
+    size_t         len   = n_cells * sizeof(*cells);
+    for (size_t i = 0; i < len; i += sizeof(word))
+    {
+        memcpy(&word, bytes + i, sizeof(word));
+        sum = (sum ^ word) * SNAP_SUM_PRIME;
+    }
+
+    return sum;
+}
+
+/*
+ * Write all of LEN bytes, through short writes and signals.
+ */
+static int32_t
+snap_write (int fd, const void *data, size_t len)
+{
+    const uint8_t *next = data;
+    while (0 < len)
+    {
+        ssize_t sent = write(fd, next, len);
+        if (sent < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return RETVAL_FAILURE;
+        }
+        next += sent;
+        len -= (size_t)sent;
+    }
+
+    return RETVAL_SUCCESS;
+}
+
+int32_t
+snap_save (const char *path, grid_t *grid, const snap_state_t *state)
+{
+    _Static_assert(0 == (sizeof(snap_hdr_t) % 8), "cells start word-aligned");
+    _Static_assert(0 == (sizeof(cell_t) % 8), "cells are whole words");
+
+    int32_t ret_val = RETVAL_FAILURE;
+    int32_t cols    = 0;
+    int32_t rows    = 0;
+    char    tmp[4096];
+    if ((NULL == path) || (NULL == state)
+        || (RETVAL_SUCCESS != grid_size(grid, &cols, &rows))
+        || (sizeof(tmp) <= (size_t)snprintf(tmp, sizeof(tmp), "%s.tmp", path)))
+    {
+        goto SNAP_SAVE_RET;
+    }
+
+    size_t        n_cells = (size_t)cols * (size_t)rows;
+    const cell_t *cells   = grid_get(grid, 0, 0); // row-major, contiguous
+    snap_hdr_t    hdr     = { .magic      = SNAP_MAGIC,
+                              .version    = SNAP_VERSION,
+                              .cell_size  = sizeof(cell_t),
+                              .state_size = sizeof(snap_state_t),
+                              .cols       = (uint32_t)cols,
+                              .rows       = (uint32_t)rows,
+                              .bytes      = sizeof(hdr)
+                                       + (n_cells * sizeof(cell_t)),
+                              .state      = *state };
+    hdr.sum = snap_sum(&hdr, cells, n_cells);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        perror("snapshot open");
+        errno = 0;
+        goto SNAP_SAVE_RET;
+    }
+
+    if ((RETVAL_SUCCESS != snap_write(fd, &hdr, sizeof(hdr)))
+        || (RETVAL_SUCCESS
+            != snap_write(fd, cells, n_cells * sizeof(cell_t)))
+        || (0 != fsync(fd)))
+    {
+        perror("snapshot write");
+        errno = 0;
+        close(fd);
+        unlink(tmp);
+        goto SNAP_SAVE_RET;
+    }
+    close(fd);
+
+    if (0 != rename(tmp, path))
+    {
+        perror("snapshot rename");
+        errno = 0;
+        unlink(tmp);
+        goto SNAP_SAVE_RET;
+    }
+    ret_val = RETVAL_SUCCESS;
+
+SNAP_SAVE_RET:
+    return ret_val;
+}
+
+snap_t *
+snap_open (const char *path)
+{
+    snap_t     *snap   = NULL;
+    const char *reason = NULL;
+    struct stat st     = { 0 };
+
+    int fd = (NULL == path) ? -1 : open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        if ((NULL != path) && (ENOENT != errno))
+        {
+            perror("snapshot open");
+        }
+        errno = 0;
+        goto SNAP_OPEN_RET;
+    }
+
+    if ((0 != fstat(fd, &st)) || ((size_t)st.st_size < sizeof(snap_hdr_t)))
+    {
+        reason = "too short";
+        goto SNAP_OPEN_RET;
+    }
+
+    // faulted in at once: every byte is read by the checksum
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ,
+                     MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    if (MAP_FAILED == map)
+    {
+        reason = "cannot map";
+        goto SNAP_OPEN_RET;
+    }
+
+    const snap_hdr_t *hdr     = map;
+    size_t            n_cells = (size_t)hdr->cols * (size_t)hdr->rows;
+    if ((SNAP_MAGIC != hdr->magic) || (SNAP_VERSION != hdr->version)
+        || (sizeof(cell_t) != hdr->cell_size)
+        || (sizeof(snap_state_t) != hdr->state_size))
+    {
+        reason = "not a snapshot of this version";
+    }
+    else if ((hdr->bytes != (uint64_t)st.st_size)
+             || (hdr->bytes != sizeof(*hdr) + (n_cells * sizeof(cell_t))))
+    {
+        reason = "truncated";
+    }
+    else if (hdr->sum != snap_sum(hdr, (const cell_t *)(hdr + 1), n_cells))
+    {
+        reason = "checksum mismatch";
+    }
+
+    if (NULL != reason)
+    {
+        munmap(map, (size_t)st.st_size);
+        goto SNAP_OPEN_RET;
+    }
+
+    snap = calloc(1, sizeof(*snap));
+    if (NULL == snap)
+    {
+        perror("snapshot create");
+        errno = 0;
+        munmap(map, (size_t)st.st_size);
+        goto SNAP_OPEN_RET;
+    }
+    snap->hdr    = map;
+    snap->mapped = (size_t)st.st_size;
+
+SNAP_OPEN_RET:
+    if (NULL != reason)
+    {
+        fprintf(stderr, "snapshot %s: %s; starting fresh\n", path, reason);
+    }
+    if (0 <= fd)
+    {
+        close(fd); // the mapping stays valid
+    }
+    return snap;
+}
+
+const snap_state_t *
+snap_state (const snap_t *snap)
+{
+    return (NULL == snap) ? NULL : &snap->hdr->state;
+}
+
+int32_t
+snap_restore (snap_t *snap, grid_t *grid, snap_state_t *state)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    int32_t cols    = 0;
+    int32_t rows    = 0;
+    if ((NULL == snap) || (NULL == state)
+        || (RETVAL_SUCCESS != grid_size(grid, &cols, &rows))
+        || ((uint32_t)cols != snap->hdr->cols)
+        || ((uint32_t)rows != snap->hdr->rows))
+    {
+        goto SNAP_RESTORE_RET;
+    }
+
+    ret_val = grid_load(grid, (const cell_t *)(snap->hdr + 1));
+    *state  = snap->hdr->state;
+
+SNAP_RESTORE_RET:
+    return ret_val;
+}
+
+void
+snap_close (snap_t **snap)
+{
+    if ((NULL == snap) || (NULL == *snap))
+    {
+        return;
+    }
+
+    munmap((*snap)->hdr, (*snap)->mapped);
+    free(*snap);
+    *snap = NULL;
+}
+
+/*** end of file ***/
@@ -0,0 +1,373 @@
+/** @file lib_soak.c
+ *
+ * @brief Soak Library: watch RSS, heap in use and the allocation rate over a
+ * long run, and judge whether any of them grows or crosses a ceiling.
+ *
+ */
+
+#include "lib_soak.h"
+
+#include <malloc.h>
+#include <stdbool.h>
+#include <time.h>
+
+typedef struct soak_bucket_t
+{
+    size_t   rss; // peak
+    size_t   heap; // peak
+    uint64_t allocs;
+    uint64_t steps;
+} soak_bucket_t;
+
+struct soak_t
+{
+    uint64_t      start;
+    uint64_t      end;
+    uint64_t      last;
+    size_t        max_bytes;
+    uint64_t      max_rate;
+    uint64_t      steps;
+    uint64_t      allocs;
+    uint64_t      cycles;
+    int32_t       used;
+    const char   *breach;
+    soak_bucket_t buckets[SOAK_BUCKETS];
+};
+
+/*
+ * Peak, start and end of one measure over a span of buckets.
+ */
+typedef struct soak_span_t
+{
+    double first;
+    double last;
+    double peak;
+} soak_span_t;
+
+static _Atomic uint64_t g_soak_allocs; // every allocation since start-up
+static _Atomic uint64_t g_soak_frees;
+
+#ifdef SOAK
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t align, size_t size);
+void  __real_free(void *ptr);
+#endif
+
+static uint64_t
+soak_now (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Resident set from /proc/self/statm; 0 if it can't be read.
+ */
+static size_t
+soak_rss (void)
+{
+    unsigned long pages = 0;
+    FILE         *statm = fopen("/proc/self/statm", "r");
+    if (NULL == statm)
+    {
+        errno = 0;
+        return 0;
+    }
+    if (1 != fscanf(statm, "%*s %lu", &pages))
+    {
+        pages = 0;
+    }
+    fclose(statm);
+
+    return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * Bytes handed out by malloc, from the arenas and from mmap.
+ */
+static size_t
+soak_heap (void)
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+/*
+ * Allocations per 1000 steps over buckets [FROM, TO).
+ */
+static double
+soak_rate (const soak_t *soak, int32_t from, int32_t to)
+{
+    uint64_t allocs = 0;
+    uint64_t steps  = 0;
+    for (int32_t i = from; i < to; ++i)
+    {
+        allocs += soak->buckets[i].allocs;
+        steps += soak->buckets[i].steps;
+    }
+
+    return (0 == steps) ? 0.0 : ((double)allocs * 1000.0 / (double)steps);
+}
+
+/*
+ * Peak RSS (WHICH 0), heap (1) or allocation rate (2) over buckets
+ * [FROM, TO). Empty buckets (a cycle longer than a slice) are skipped.
+ */
+static double
+soak_peak (const soak_t *soak, int32_t which, int32_t from, int32_t to)
+{
+    if (2 == which)
+    {
+        return soak_rate(soak, from, to);
+    }
+
+    size_t peak = 0;
+    for (int32_t i = from; i < to; ++i)
+    {
+        size_t value = (0 == which) ? soak->buckets[i].rss
+                                    : soak->buckets[i].heap;
+        peak         = (value > peak) ? value : peak;
+    }
+
+    return (double)peak;
+}
+
+/*
+ * Rising through every quarter after the first (the warm-up), by more than
+ * SLACK over the warm-up in total.
+ */
+static bool
+soak_rising (const soak_t *soak, int32_t which, double slack,
+             soak_span_t *span)
+{
+    int32_t quarter = soak->used / 4;
+    double  q[4]    = { 0 };
+
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        int32_t to = (3 == i) ? soak->used : (i + 1) * quarter;
+        q[i]       = soak_peak(soak, which, i * quarter, to);
+    }
+
+    // the first and last slices that saw a sample
+    int32_t first = 0;
+    int32_t last  = soak->used - 1;
+    while ((first < last) && (0 == soak->buckets[first].steps))
+    {
+        first++;
+    }
+    while ((last > first) && (0 == soak->buckets[last].steps))
+    {
+        last--;
+    }
+    span->first = soak_peak(soak, which, first, first + 1);
+    span->last  = soak_peak(soak, which, last, last + 1);
+    span->peak  = 0.0;
+    for (int32_t i = first; i <= last; ++i)
+    {
+        double value = soak_peak(soak, which, i, i + 1);
+        span->peak   = (value > span->peak) ? value : span->peak;
+    }
+
+    return (q[1] < q[2]) && (q[2] < q[3]) && ((q[3] - q[0]) > slack);
+}
+
+soak_t *
+soak_create (int64_t secs, size_t max_bytes, uint64_t max_rate)
+{
+    soak_t *soak = calloc(1, sizeof(*soak));
+    if (NULL == soak)
+    {
+        perror("soak create");
+        errno = 0;
+        goto SOAK_CREATE_RET;
+    }
+
+    soak->start     = soak_now();
+    soak->end       = soak->start + ((uint64_t)secs * 1000000000ULL);
+    soak->last      = soak->start;
+    soak->max_bytes = max_bytes;
+    soak->max_rate  = max_rate;
+    soak->allocs    = atomic_load_explicit(&g_soak_allocs,
+                                           memory_order_relaxed);
+
+SOAK_CREATE_RET:
+    return soak;
+}
+
+int32_t
+soak_cycle (soak_t *soak, size_t steps)
+{
+    if (NULL == soak)
+    {
+        return RETVAL_FAILURE;
+    }
+
+    soak->steps += steps;
+    soak->cycles++;
+
+    uint64_t now = soak_now();
+    if ((now - soak->last < SOAK_PERIOD_NS) && (now < soak->end))
+    {
+        return RETVAL_SUCCESS;
+    }
+    soak->last = now;
+
+    uint64_t span   = soak->end - soak->start;
+    uint64_t slice  = (now - soak->start) * SOAK_BUCKETS / (span ? span : 1);
+    int32_t  idx    = (slice < SOAK_BUCKETS) ? (int32_t)slice
+                                             : (SOAK_BUCKETS - 1);
+    uint64_t allocs = atomic_load_explicit(&g_soak_allocs,
+                                           memory_order_relaxed);
+
+    soak_bucket_t *bucket = &soak->buckets[idx];
+    size_t         rss    = soak_rss();
+    size_t         heap   = soak_heap();
+    bucket->rss           = (rss > bucket->rss) ? rss : bucket->rss;
+    bucket->heap          = (heap > bucket->heap) ? heap : bucket->heap;
+    bucket->allocs += allocs - soak->allocs;
+    bucket->steps += soak->steps;
+    soak->used   = idx + 1;
+    soak->allocs = allocs;
+    soak->steps  = 0;
+
+    // the allocation rate is only held to its ceiling after the warm-up
+    if (rss > soak->max_bytes)
+    {
+        soak->breach = "RSS over the ceiling";
+    }
+    else if (heap > soak->max_bytes)
+    {
+        soak->breach = "heap over the ceiling";
+    }
+    else if ((SOAK_BUCKETS / 4 <= idx) && (0 < bucket->steps)
+             && (soak_rate(soak, idx, idx + 1) > (double)soak->max_rate))
+    {
+        soak->breach = "allocation rate over the ceiling";
+    }
+
+    return ((NULL == soak->breach) && (now < soak->end)) ? RETVAL_SUCCESS
+                                                         : RETVAL_FAILURE;
+}
+
+int32_t
+soak_report (soak_t *soak, FILE *file)
+{
+    static const char *const names[] = { "rss MB", "heap MB",
+                                         "allocs/kstep" };
+    static const double      scale[] = { 1.0 / (1024 * 1024),
+                                         1.0 / (1024 * 1024), 1.0 };
+    static const double      slack[] = { SOAK_SLACK, SOAK_SLACK, 1.0 };
+
+    if ((NULL == soak) || (NULL == file))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    uint64_t steps = soak->steps;
+    for (int32_t i = 0; i < soak->used; ++i)
+    {
+        steps += soak->buckets[i].steps;
+    }
+
+    fprintf(file, "soak: %.0f s, %llu cycles, %llu steps, %llu allocs, "
+                  "%llu frees\n",
+            (double)(soak->last - soak->start) / 1e9,
+            (unsigned long long)soak->cycles, (unsigned long long)steps,
+            (unsigned long long)atomic_load(&g_soak_allocs),
+            (unsigned long long)atomic_load(&g_soak_frees));
+    fprintf(file, "%-13s %10s %10s %10s\n", "", "start", "peak", "end");
+
+    const char *trend = NULL;
+    for (int32_t which = 0; which < 3; ++which)
+    {
+        soak_span_t span = { 0 };
+        if (soak_rising(soak, which, slack[which], &span)
+            && (8 <= soak->used) && (NULL == trend))
+        {
+            trend = names[which];
+        }
+        fprintf(file, "%-13s %10.2f %10.2f %10.2f\n", names[which],
+                span.first * scale[which], span.peak * scale[which],
+                span.last * scale[which]);
+    }
+
+    int32_t ret_val = RETVAL_FAILURE;
+    if (NULL != soak->breach)
+    {
+        fprintf(file, "FAIL: %s\n", soak->breach);
+    }
+    else if (NULL != trend)
+    {
+        fprintf(file, "FAIL: %s rose through every quarter\n", trend);
+    }
+    else
+    {
+        fprintf(file, "ok%s\n", (8 <= soak->used) ? ""
+                                                  : " (too short for a trend)");
+        ret_val = RETVAL_SUCCESS;
+    }
+
+    return ret_val;
+}
+
+void
+soak_destroy (soak_t **soak)
+{
+    if ((NULL == soak) || (NULL == *soak))
+    {
+        return;
+    }
+
+    free(*soak);
+    *soak = NULL;
+}
+
+#ifdef SOAK
+// =============================================================================
+//                              ALLOCATION HOOKS
+// =============================================================================
+
+void *
+__wrap_malloc (size_t size)
+{
+    atomic_fetch_add_explicit(&g_soak_allocs, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *
+__wrap_calloc (size_t count, size_t size)
+{
+    atomic_fetch_add_explicit(&g_soak_allocs, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void *
+__wrap_realloc (void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&g_soak_allocs, 1, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+void *
+__wrap_aligned_alloc (size_t align, size_t size)
+{
+    atomic_fetch_add_explicit(&g_soak_allocs, 1, memory_order_relaxed);
+    return __real_aligned_alloc(align, size);
+}
+
+void
+__wrap_free (void *ptr)
+{
+    if (NULL != ptr)
+    {
+        atomic_fetch_add_explicit(&g_soak_frees, 1, memory_order_relaxed);
+    }
+    __real_free(ptr);
+}
+#endif /* SOAK */
+
+/*** end of file ***/
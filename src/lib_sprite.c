@@ -0,0 +1,509 @@
+/** @file lib_sprite.c
+ *
+ * @brief Sprite Library: shaded, tube-like pipe sprites for the graphics
+ * backends, baked once at the cell size, with each one's Sixel encoding.
+ *
+ */
+
+#include "lib_sprite.h"
+
+#include <stdbool.h>
+
+#define SPRITE_GRAY  0xD0D0D0 // the default foreground: border, no -c
+#define SPRITE_RUN   4 // shortest run worth a Sixel repeat ("!N")
+#define SPRITE_REG(c, s) (1 + ((c) * (SPRITE_SHADES - 1)) + ((s) - 1))
+
+// arms of each shape: left, right, up, down
+#define ARM_L 1
+#define ARM_R 2
+#define ARM_U 4
+#define ARM_D 8
+
+struct sprite_t
+{
+    int32_t   cell_w;
+    int32_t   cell_h;
+    uint8_t  *pixels;
+    frame_t  *sixel;
+    size_t    offs[(2 * (SPRITE_COUNT + 1)) + 1];
+    uint32_t  ramp[SPRITE_COLORS];
+};
+
+static const uint8_t g_shape_arms[SPRITE_SHAPES] = {
+    ARM_L | ARM_R,                 // ━
+    ARM_U | ARM_D,                 // ┃
+    ARM_R | ARM_D,                 // ┏
+    ARM_L | ARM_D,                 // ┓
+    ARM_R | ARM_U,                 // ┗
+    ARM_L | ARM_U,                 // ┛
+    ARM_L | ARM_R | ARM_U | ARM_D, // ╋
+};
+
+/*
+ * Shape of a box-drawing glyph (light, heavy and rounded alike); -1 if it is
+ * not a pipe piece.
+ */
+static int32_t
+sprite_shape (uint32_t glyph)
+{
+    switch (glyph)
+    {
+        case 0x2500: case 0x2501:
+            return 0;
+        case 0x2502: case 0x2503:
+            return 1;
+        case 0x250c: case 0x250f: case 0x256d:
+            return 2;
+        case 0x2510: case 0x2513: case 0x256e:
+            return 3;
+        case 0x2514: case 0x2517: case 0x2570:
+            return 4;
+        case 0x2518: case 0x251b: case 0x256f:
+            return 5;
+        case 0x253c: case 0x254b:
+            return 6;
+        default:
+            return -1;
+    }
+}
+
+/*
+ * The pipes' rainbow at step IDX of 1024: red > yellow > green > blue > red.
+ */
+static uint32_t
+sprite_rainbow (int32_t idx)
+{
+    uint32_t up   = (uint32_t)(idx % 256);
+    uint32_t down = 255 - up;
+
+    switch ((idx % 1024) / 256)
+    {
+        case 0:
+            return 0xFF0000 | (up << 8);
+        case 1:
+            return (down << 16) | 0x00FF00;
+        case 2:
+            return (down << 8) | up;
+        default:
+            return (up << 16) | down;
+    }
+}
+
+/*
+ * Lit level of pixel PX, PY of SHAPE: 0 outside the tube, then darkest to
+ * lightest, SPRITE_SHADES - 1 being the highlight. The tube runs along the
+ * arms' center lines, lit from the upper left.
+ */
+static int32_t
+sprite_level (const sprite_t *sprite, int32_t shape, int32_t px, int32_t py)
+{
+    float cx     = (float)sprite->cell_w / 2.0f;
+    float cy     = (float)sprite->cell_h / 2.0f;
+    float radius = 0.3f * (float)((sprite->cell_w < sprite->cell_h)
+                                      ? sprite->cell_w
+                                      : sprite->cell_h);
+    radius       = (radius < 1.5f) ? 1.5f : radius;
+    float x      = (float)px + 0.5f;
+    float y      = (float)py + 0.5f;
+    float best   = radius * radius;
+    float ox     = 0.0f;
+    float oy     = 0.0f;
+    bool  b_in   = false;
+
+    for (int32_t arm = ARM_L; arm <= ARM_D; arm <<= 1)
+    {
+        if (!(g_shape_arms[shape] & arm))
+        {
+            continue;
+        }
+
+        // nearest point of the arm's center line
+        float qx = cx;
+        float qy = cy;
+        if ((ARM_L == arm) || (ARM_R == arm))
+        {
+            qx = (ARM_L == arm) ? ((x < cx) ? x : cx) : ((x > cx) ? x : cx);
+        }
+        else
+        {
+            qy = (ARM_U == arm) ? ((y < cy) ? y : cy) : ((y > cy) ? y : cy);
+        }
+
+        float dx = x - qx;
+        float dy = y - qy;
+        if ((dx * dx) + (dy * dy) < best)
+        {
+            best = (dx * dx) + (dy * dy);
+            ox   = dx;
+            oy   = dy;
+            b_in = true;
+        }
+    }
+
+    if (!b_in)
+    {
+        return 0;
+    }
+
+    // surface normal of the tube, and the light and halfway vectors
+    float nx  = ox / radius;
+    float ny  = oy / radius;
+    float nz  = sqrtf(fmaxf(0.0f, 1.0f - (nx * nx) - (ny * ny)));
+    float lx  = -0.45f;
+    float ly  = -0.60f;
+    float lz  = 0.66f;
+    float dif = fmaxf(0.0f, (nx * lx) + (ny * ly) + (nz * lz));
+    float hz  = lz + 1.0f;
+    float hn  = sqrtf((lx * lx) + (ly * ly) + (hz * hz));
+    float spc = fmaxf(0.0f, ((nx * lx) + (ny * ly) + (nz * hz)) / hn);
+
+    if (powf(spc, 24.0f) > 0.5f)
+    {
+        return SPRITE_SHADES - 1;
+    }
+
+    int32_t level = 1 + (int32_t)((0.15f + (0.85f * dif))
+                                  * (float)(SPRITE_SHADES - 2));
+    return (level > SPRITE_SHADES - 2) ? (SPRITE_SHADES - 2) : level;
+}
+
+/*
+ * Color of LEVEL (1 up) of BASE: darker to full, then halfway to white.
+ */
+static uint32_t
+sprite_shade (uint32_t base, int32_t level)
+{
+    uint32_t out = 0;
+
+    for (int32_t shift = 0; shift <= 16; shift += 8)
+    {
+        uint32_t channel = (base >> shift) & 0xFF;
+        if (SPRITE_SHADES - 1 == level)
+        {
+            channel = (channel + 255) / 2;
+        }
+        else
+        {
+            channel = (channel * (uint32_t)(3 + (7 * (level - 1)
+                                                 / (SPRITE_SHADES - 3))))
+                      / 10;
+        }
+        out |= channel << shift;
+    }
+
+    return out;
+}
+
+/*
+ * Append one sprite's Sixel: its registers, then each band of 6 rows as one
+ * line per register used, run-length coded. Rows from ROWS on are left out.
+ * Register 0 is the background, so the whole cell is painted.
+ */
+static void
+sprite_encode (sprite_t *sprite, const uint8_t *reg, int32_t rows)
+{
+    int32_t  cw          = sprite->cell_w;
+    frame_t *out         = sprite->sixel;
+    bool     used[256]   = { false };
+
+    for (int32_t i = 0; i < cw * rows; ++i)
+    {
+        used[reg[i]] = true;
+    }
+
+    // P2 = 1: pixels no sixel sets are left alone, not painted black
+    frame_printf(out, "\033P0;1;0q\"1;1;%d;%d", (int)cw, (int)rows);
+    for (int32_t r = 0; r < 256; ++r)
+    {
+        if (!used[r])
+        {
+            continue;
+        }
+
+        uint32_t rgb = 0;
+        if (0 < r)
+        {
+            int32_t color = (r - 1) / (SPRITE_SHADES - 1);
+            rgb = sprite_shade(sprite->ramp[color],
+                               ((r - 1) % (SPRITE_SHADES - 1)) + 1);
+        }
+        frame_printf(out, "#%d;2;%u;%u;%u", (int)r,
+                     (((rgb >> 16) & 0xFF) * 100 + 127) / 255,
+                     (((rgb >> 8) & 0xFF) * 100 + 127) / 255,
+                     ((rgb & 0xFF) * 100 + 127) / 255);
+    }
+
+    for (int32_t band = 0; band < rows; band += 6)
+    {
+        bool b_first = true;
+        for (int32_t r = 0; r < 256; ++r)
+        {
+            char    line[SPRITE_MAX_PX];
+            int32_t last = -1;
+            for (int32_t x = 0; x < cw; ++x)
+            {
+                int32_t bits = 0;
+                for (int32_t y = band; (y < band + 6) && (y < rows); ++y)
+                {
+                    bits |= (reg[(y * cw) + x] == r) ? (1 << (y - band)) : 0;
+                }
+                line[x] = (char)(63 + bits);
+                last    = bits ? x : last;
+            }
+            if (0 > last)
+            {
+                continue;
+            }
+
+            frame_printf(out, "%s#%d", b_first ? "" : "$", (int)r);
+            b_first = false;
+            for (int32_t x = 0; x <= last;)
+            {
+                int32_t run = 1;
+                while ((x + run <= last) && (line[x + run] == line[x]))
+                {
+                    run++;
+                }
+                if (SPRITE_RUN <= run)
+                {
+                    frame_printf(out, "!%d%c", (int)run, line[x]);
+                }
+                else
+                {
+                    frame_put(out, line + x, (size_t)run);
+                }
+                x += run;
+            }
+        }
+        frame_put(out, "-", 1);
+    }
+    frame_put(out, "\033\\", 2);
+}
+
+/*
+ * Paint every sprite, and encode each as a Sixel, whole and clipped to
+ * whole bands.
+ */
+static int32_t
+sprite_bake (sprite_t *sprite)
+{
+    int32_t  cw    = sprite->cell_w;
+    int32_t  ch    = sprite->cell_h;
+    uint8_t *level = malloc((size_t)SPRITE_SHAPES * (size_t)cw * (size_t)ch);
+    uint8_t *reg   = malloc((size_t)cw * (size_t)ch);
+    if ((NULL == level) || (NULL == reg))
+    {
+        perror("sprite bake");
+        errno = 0;
+        free(level);
+        free(reg);
+        return RETVAL_FAILURE;
+    }
+
+    for (int32_t shape = 0; shape < SPRITE_SHAPES; ++shape)
+    {
+        for (int32_t y = 0; y < ch; ++y)
+        {
+            for (int32_t x = 0; x < cw; ++x)
+            {
+                level[(((shape * ch) + y) * cw) + x]
+                    = (uint8_t)sprite_level(sprite, shape, x, y);
+            }
+        }
+    }
+
+    size_t  px    = (size_t)cw * (size_t)ch;
+    int32_t whole = ((ch / 6) < 1) ? ch : ((ch / 6) * 6);
+    for (int32_t clip = 0; clip < 2; ++clip)
+    {
+        for (int32_t index = 0; index <= SPRITE_BLANK; ++index)
+        {
+            int32_t  color = index / SPRITE_SHAPES;
+            int32_t  shape = index % SPRITE_SHAPES;
+            uint8_t *rgba  = sprite->pixels + ((size_t)index * px * 4);
+
+            for (size_t i = 0; i < px; ++i)
+            {
+                int32_t lit = (SPRITE_BLANK == index)
+                                  ? 0
+                                  : level[((size_t)shape * px) + i];
+                uint32_t rgb = lit ? sprite_shade(sprite->ramp[color], lit)
+                                   : 0;
+                reg[i]       = lit ? (uint8_t)SPRITE_REG(color, lit) : 0;
+
+                rgba[(i * 4) + 0] = (uint8_t)(rgb >> 16);
+                rgba[(i * 4) + 1] = (uint8_t)(rgb >> 8);
+                rgba[(i * 4) + 2] = (uint8_t)rgb;
+                rgba[(i * 4) + 3] = lit ? 255 : 0;
+            }
+
+            size_t len = 0;
+            frame_data(sprite->sixel, &len);
+            sprite->offs[(clip * (SPRITE_BLANK + 1)) + index] = len;
+            sprite_encode(sprite, reg, clip ? whole : ch);
+        }
+    }
+
+    size_t len = 0;
+    frame_data(sprite->sixel, &len);
+    sprite->offs[2 * (SPRITE_BLANK + 1)] = len;
+
+    free(level);
+    free(reg);
+    return RETVAL_SUCCESS;
+}
+
+// =============================================================================
+//                              LIBRARY FUNCTIONS
+// =============================================================================
+
+sprite_t *
+sprite_create (int32_t cell_w, int32_t cell_h)
+{
+    sprite_t *sprite = NULL;
+    if ((cell_w < 2) || (cell_h < 2) || (cell_w > SPRITE_MAX_PX)
+        || (cell_h > SPRITE_MAX_PX))
+    {
+        goto SPRITE_CREATE_RET;
+    }
+
+    sprite = calloc(1, sizeof(*sprite));
+    if (NULL == sprite)
+    {
+        perror("sprite create");
+        errno = 0;
+        goto SPRITE_CREATE_RET;
+    }
+
+    sprite->cell_w = cell_w;
+    sprite->cell_h = cell_h;
+    sprite->pixels = calloc((size_t)(SPRITE_BLANK + 1),
+                            (size_t)cell_w * (size_t)cell_h * 4);
+    sprite->sixel  = frame_create(0);
+    if ((NULL == sprite->pixels) || (NULL == sprite->sixel))
+    {
+        perror("sprite create");
+        errno = 0;
+        sprite_destroy(&sprite);
+        goto SPRITE_CREATE_RET;
+    }
+
+    for (int32_t i = 0; i < SPRITE_STEPS; ++i)
+    {
+        sprite->ramp[i] = sprite_rainbow(i * (1024 / SPRITE_STEPS));
+    }
+    sprite->ramp[SPRITE_STEPS] = SPRITE_GRAY;
+
+    if (RETVAL_SUCCESS != sprite_bake(sprite))
+    {
+        sprite_destroy(&sprite);
+    }
+
+SPRITE_CREATE_RET:
+    return sprite;
+}
+
+int32_t
+sprite_pick (const sprite_t *sprite, const cell_t *cell)
+{
+    int32_t shape = sprite_shape(cell->glyph);
+    if ((NULL == sprite) || (0 > shape))
+    {
+        return SPRITE_BLANK;
+    }
+
+    if (!(cell->attr & CELL_RGB))
+    {
+        return (SPRITE_STEPS * SPRITE_SHAPES) + shape;
+    }
+
+    int32_t high = cell->r;
+    high         = (cell->g > high) ? cell->g : high;
+    high         = (cell->b > high) ? cell->b : high;
+    if (0 == high)
+    {
+        return SPRITE_BLANK; // faded all the way out
+    }
+
+    // nearest step to the color brought back up to full brightness
+    int32_t red   = (cell->r * 255) / high;
+    int32_t grn   = (cell->g * 255) / high;
+    int32_t blu   = (cell->b * 255) / high;
+    int32_t best  = 0;
+    int32_t least = INT32_MAX;
+    for (int32_t i = 0; i < SPRITE_STEPS; ++i)
+    {
+        int32_t dr   = red - (int32_t)((sprite->ramp[i] >> 16) & 0xFF);
+        int32_t dg   = grn - (int32_t)((sprite->ramp[i] >> 8) & 0xFF);
+        int32_t db   = blu - (int32_t)(sprite->ramp[i] & 0xFF);
+        int32_t dist = (dr * dr) + (dg * dg) + (db * db);
+        if (dist < least)
+        {
+            least = dist;
+            best  = i;
+        }
+    }
+
+    return (best * SPRITE_SHAPES) + shape;
+}
+
+const uint8_t *
+sprite_pixels (const sprite_t *sprite, int32_t index)
+{
+    if ((NULL == sprite) || (0 > index) || (SPRITE_BLANK < index))
+    {
+        return NULL;
+    }
+
+    return sprite->pixels
+           + ((size_t)index * (size_t)sprite->cell_w * (size_t)sprite->cell_h
+              * 4);
+}
+
+const uint8_t *
+sprite_sixel (const sprite_t *sprite, int32_t index, int32_t b_clip,
+              size_t *len)
+{
+    if ((NULL == sprite) || (NULL == len) || (0 > index)
+        || (SPRITE_BLANK < index))
+    {
+        return NULL;
+    }
+
+    size_t         all  = 0;
+    const uint8_t *data = frame_data(sprite->sixel, &all);
+    size_t         slot = ((b_clip ? 1 : 0) * (SPRITE_BLANK + 1))
+                          + (size_t)index;
+
+    *len = sprite->offs[slot + 1] - sprite->offs[slot];
+    return data + sprite->offs[slot];
+}
+
+int32_t
+sprite_size (const sprite_t *sprite, int32_t *cell_w, int32_t *cell_h)
+{
+    if ((NULL == sprite) || (NULL == cell_w) || (NULL == cell_h))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    *cell_w = sprite->cell_w;
+    *cell_h = sprite->cell_h;
+    return RETVAL_SUCCESS;
+}
+
+void
+sprite_destroy (sprite_t **sprite)
+{
+    if ((NULL == sprite) || (NULL == *sprite))
+    {
+        return;
+    }
+
+    free((*sprite)->pixels);
+    frame_unref((*sprite)->sixel);
+    free(*sprite);
+    *sprite = NULL;
+}
+
+/*** end of file ***/
@@ -0,0 +1,190 @@
+/** @file lib_trace.c
+ *
+ * @brief Trace Library: timestamped begin/end events per thread, written out
+ * as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev) to see how
+ * each frame's time splits across phases.
+ *
+ */
+
+#include "lib_trace.h"
+
+#include <stdbool.h>
+#include <time.h>
+
+typedef struct trace_rec_t
+{
+    uint64_t    ns;
+    const char *name;
+    char        phase;
+} trace_rec_t;
+
+/*
+ * One thread's events. Only its owner appends; LEN is published with release
+ * so trace_close sees complete records.
+ */
+typedef struct trace_buf_t
+{
+    struct trace_buf_t *next;
+    int32_t             tid;
+    _Atomic size_t      len;
+    uint64_t            dropped;
+    trace_rec_t         recs[];
+} trace_buf_t;
+
+static _Atomic(trace_buf_t *) g_trace_bufs; // every thread's buffer
+static _Atomic int32_t        g_trace_tids;
+static _Atomic bool           gb_trace_on;
+static const char            *g_trace_path;
+static uint64_t               g_trace_epoch;
+
+static _Thread_local trace_buf_t *g_trace_mine;
+
+static uint64_t
+trace_now (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * First event on this thread: allocate its buffer and push it on the list.
+ */
+static trace_buf_t *
+trace_register (void)
+{
+    trace_buf_t *buf = malloc(sizeof(*buf)
+                              + (TRACE_EVENTS * sizeof(trace_rec_t)));
+    if (NULL == buf)
+    {
+        perror("trace buffer");
+        errno = 0;
+        return NULL;
+    }
+
+    buf->tid     = atomic_fetch_add(&g_trace_tids, 1) + 1;
+    buf->dropped = 0;
+    atomic_init(&buf->len, 0);
+
+    buf->next = atomic_load(&g_trace_bufs);
+    while (!atomic_compare_exchange_weak(&g_trace_bufs, &buf->next, buf))
+    {
+        // BUF->NEXT was reloaded; try again
+    }
+
+    return buf;
+}
+
+int32_t
+trace_open (const char *path)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == path) || atomic_load(&gb_trace_on))
+    {
+        goto TRACE_OPEN_RET;
+    }
+
+    g_trace_path  = path;
+    g_trace_epoch = trace_now();
+    atomic_store(&gb_trace_on, true);
+    ret_val = RETVAL_SUCCESS;
+
+TRACE_OPEN_RET:
+    return ret_val;
+}
+
+void
+trace_event (const char *name, char phase)
+{
+    if (!atomic_load_explicit(&gb_trace_on, memory_order_relaxed))
+    {
+        return;
+    }
+
+    if (NULL == g_trace_mine)
+    {
+        g_trace_mine = trace_register();
+        if (NULL == g_trace_mine)
+        {
+            return;
+        }
+    }
+
+    trace_buf_t *buf = g_trace_mine;
+    size_t       len = atomic_load_explicit(&buf->len, memory_order_relaxed);
+    if (len >= TRACE_EVENTS)
+    {
+        buf->dropped++;
+        return;
+    }
+
+    buf->recs[len] = (trace_rec_t){ .ns    = trace_now() - g_trace_epoch,
+                                    .name  = name,
+                                    .phase = phase };
+    atomic_store_explicit(&buf->len, len + 1, memory_order_release);
+}
+
+int32_t
+trace_close (void)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if (!atomic_exchange(&gb_trace_on, false))
+    {
+        goto TRACE_CLOSE_RET;
+    }
+
+    FILE *file = fopen(g_trace_path, "w");
+    if (NULL == file)
+    {
+        perror("trace open");
+        errno = 0;
+    }
+
+    trace_buf_t *buf     = atomic_exchange(&g_trace_bufs, NULL);
+    const char  *sep     = "";
+    uint64_t     dropped = 0;
+
+    if (NULL != file)
+    {
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    }
+    while (NULL != buf)
+    {
+        size_t len = atomic_load_explicit(&buf->len, memory_order_acquire);
+        for (size_t i = 0; (NULL != file) && (i < len); ++i)
+        {
+            const trace_rec_t *rec = &buf->recs[i];
+            fprintf(file,
+                    "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03llu,"
+                    "\"pid\":1,\"tid\":%d%s}",
+                    sep, rec->name, rec->phase,
+                    (unsigned long long)(rec->ns / 1000),
+                    (unsigned long long)(rec->ns % 1000), buf->tid,
+                    ('i' == rec->phase) ? ",\"s\":\"t\"" : "");
+            sep = ",";
+        }
+        dropped += buf->dropped;
+
+        trace_buf_t *next = buf->next;
+        free(buf);
+        buf = next;
+    }
+    g_trace_mine = NULL;
+
+    if (NULL != file)
+    {
+        fprintf(file, "\n]}\n");
+        ret_val = (0 == fclose(file)) ? RETVAL_SUCCESS : RETVAL_FAILURE;
+    }
+
+    if (0 < dropped)
+    {
+        fprintf(stderr, "trace: %llu events did not fit and were dropped\n",
+                (unsigned long long)dropped);
+    }
+
+TRACE_CLOSE_RET:
+    return ret_val;
+}
+
+/*** end of file ***/
@@ -0,0 +1,408 @@
+/** @file lib_vector.c
+ *
+ * @brief Vector Library for contiguous, append-mostly storage of fixed-size
+ * elements stored inline. Companion to lib_llist; analogous to a C++
+ * std::vector.
+ *
+ */
+
+#include "lib_vector.h"
+
+#include <stddef.h>
+
+#define VEC_MIN_CAPACITY 16
+
+struct vec_t
+{
+    size_t    stride;
+    size_t    count;
+    size_t    capacity;
+    uint8_t  *data;
+    ll_lock_t policy;
+    union
+    {
+        pthread_mutex_t    mutex;
+        pthread_spinlock_t spin;
+    } lock; // must stay last; only the member for POLICY is allocated
+};
+
+static inline void
+vec_lock (vec_t *vec)
+{
+    switch (vec->policy)
+    {
+        case LL_LOCK_MUTEX:
+            pthread_mutex_lock(&vec->lock.mutex);
+            break;
+
+        case LL_LOCK_SPIN:
+            pthread_spin_lock(&vec->lock.spin);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static inline void
+vec_unlock (vec_t *vec)
+{
+    switch (vec->policy)
+    {
+        case LL_LOCK_MUTEX:
+            pthread_mutex_unlock(&vec->lock.mutex);
+            break;
+
+        case LL_LOCK_SPIN:
+            pthread_spin_unlock(&vec->lock.spin);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * Resize the backing store to exactly CAPACITY elements; caller holds the
+ * lock.
+ */
+static int32_t
+vec_realloc (vec_t *vec, size_t capacity)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+
+    if ((0 != capacity) && (capacity > (SIZE_MAX / vec->stride)))
+    {
+        (void)fprintf(stderr, "vec_realloc capacity overflow\n");
+        goto VEC_REALLOC_RET;
+    }
+
+    if (0 == capacity)
+    {
+        free(vec->data);
+        vec->data = NULL;
+    }
+    else
+    {
+        uint8_t *data = realloc(vec->data, capacity * vec->stride);
+        if (NULL == data)
+        {
+            perror("vector allocation");
+            errno = 0;
+            goto VEC_REALLOC_RET;
+        }
+        vec->data = data;
+    }
+
+    vec->capacity = capacity;
+    ret_val       = RETVAL_SUCCESS;
+
+VEC_REALLOC_RET:
+    return ret_val;
+}
+
+/*
+ * Grow geometrically (x2) until COUNT elements fit, short of SIZE_MAX bytes;
+ * caller holds the lock.
+ */
+static int32_t
+vec_grow (vec_t *vec, size_t count)
+{
+    int32_t ret_val = RETVAL_SUCCESS;
+    size_t  limit   = SIZE_MAX / vec->stride;
+
+    if (count <= vec->capacity)
+    {
+        goto VEC_GROW_RET;
+    }
+
+    if (count > limit)
+    {
+        (void)fprintf(stderr, "vec_grow capacity overflow\n");
+        ret_val = RETVAL_FAILURE;
+        goto VEC_GROW_RET;
+    }
+
+    size_t capacity = vec->capacity ? vec->capacity : VEC_MIN_CAPACITY;
+    while (capacity < count)
+    {
+        capacity = (capacity > (limit / 2)) ? limit : (capacity * 2);
+    }
+
+    ret_val = vec_realloc(vec, capacity);
+
+VEC_GROW_RET:
+    return ret_val;
+}
+
+vec_t *
+vec_create (size_t stride, ll_lock_t policy)
+{
+    vec_t  *vec       = NULL;
+    size_t  alloc_sz  = offsetof(vec_t, lock);
+    int32_t init_fail = 0;
+
+    if (0 == stride)
+    {
+        (void)fprintf(stderr, "vec_create invalid stride\n");
+        goto VEC_CREATE_RET;
+    }
+
+    switch (policy)
+    {
+        case LL_LOCK_NONE:
+            break;
+
+        case LL_LOCK_MUTEX:
+            alloc_sz += sizeof(pthread_mutex_t);
+            break;
+
+        case LL_LOCK_SPIN:
+            alloc_sz += sizeof(pthread_spinlock_t);
+            break;
+
+        default:
+            (void)fprintf(stderr, "vec_create invalid policy\n");
+            goto VEC_CREATE_RET;
+    }
+
+    vec = calloc(1, alloc_sz);
+    if (NULL == vec)
+    {
+        perror("vector create");
+        errno = 0;
+        goto VEC_CREATE_RET;
+    }
+    vec->stride = stride;
+    vec->policy = policy;
+
+    if (LL_LOCK_MUTEX == policy)
+    {
+        init_fail = pthread_mutex_init(&vec->lock.mutex, NULL);
+    }
+    else if (LL_LOCK_SPIN == policy)
+    {
+        init_fail = pthread_spin_init(&vec->lock.spin, PTHREAD_PROCESS_PRIVATE);
+    }
+
+    if (0 != init_fail)
+    {
+        perror("vec_create lock init");
+        errno = 0;
+        free(vec);
+        vec = NULL;
+    }
+
+VEC_CREATE_RET:
+    return vec;
+}
+
+int32_t
+vec_reserve (vec_t *vec, size_t count)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if (NULL == vec)
+    {
+        goto VEC_RESERVE_RET;
+    }
+
+    vec_lock(vec);
+    ret_val = (count > vec->capacity) ? vec_realloc(vec, count)
+                                      : RETVAL_SUCCESS;
+    vec_unlock(vec);
+
+VEC_RESERVE_RET:
+    return ret_val;
+}
+
+int32_t
+vec_shrink (vec_t *vec)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if (NULL == vec)
+    {
+        goto VEC_SHRINK_RET;
+    }
+
+    vec_lock(vec);
+    ret_val = (vec->count < vec->capacity) ? vec_realloc(vec, vec->count)
+                                           : RETVAL_SUCCESS;
+    vec_unlock(vec);
+
+VEC_SHRINK_RET:
+    return ret_val;
+}
+
+int32_t
+vec_append (vec_t *vec, const void *elem)
+{
+    return vec_append_n(vec, elem, 1);
+}
+
+int32_t
+vec_append_n (vec_t *vec, const void *elems, size_t count)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == vec) || (NULL == elems))
+    {
+        goto VEC_APPEND_RET;
+    }
+
+    vec_lock(vec);
+
+    if ((count <= (SIZE_MAX - vec->count))
+        && (RETVAL_SUCCESS == vec_grow(vec, vec->count + count)))
+    {
+        memcpy(vec->data + (vec->count * vec->stride), elems,
+               count * vec->stride);
+        vec->count += count;
+        ret_val = RETVAL_SUCCESS;
+    }
+
+    vec_unlock(vec);
+
+VEC_APPEND_RET:
+    return ret_val;
+}
+
+void *
+vec_at (vec_t *vec, size_t idx)
+{
+    void *ret_ptr = NULL;
+    if ((NULL == vec) || (idx >= vec->count))
+    {
+        goto VEC_AT_RET;
+    }
+
+    ret_ptr = vec->data + (idx * vec->stride);
+
+VEC_AT_RET:
+    return ret_ptr;
+}
+
+void *
+vec_tail (vec_t *vec)
+{
+    void *ret_ptr = NULL;
+    if ((NULL == vec) || (0 == vec->count))
+    {
+        goto VEC_TAIL_RET;
+    }
+
+    ret_ptr = vec->data + ((vec->count - 1) * vec->stride);
+
+VEC_TAIL_RET:
+    return ret_ptr;
+}
+
+int64_t
+vec_len (vec_t *vec)
+{
+    int64_t len_retval = RETVAL_FAILURE;
+    if (NULL == vec)
+    {
+        goto VEC_LEN_RET;
+    }
+
+    len_retval = (int64_t)vec->count;
+
+VEC_LEN_RET:
+    return len_retval;
+}
+
+int64_t
+vec_clear (vec_t *vec, lliter_f freeelem)
+{
+    int64_t ret_val = RETVAL_FAILURE;
+    if (NULL == vec)
+    {
+        goto VEC_CLEAR_RET;
+    }
+
+    vec_lock(vec);
+
+    for (size_t idx = 0; (NULL != freeelem) && (idx < vec->count); idx++)
+    {
+        freeelem(vec->data + (idx * vec->stride));
+    }
+    ret_val    = (int64_t)vec->count;
+    vec->count = 0;
+
+    vec_unlock(vec);
+
+VEC_CLEAR_RET:
+    return ret_val;
+}
+
+void
+vec_destroy (vec_t **vec, lliter_f freeelem)
+{
+    if ((NULL == vec) || (NULL == (*vec)))
+    {
+        return;
+    }
+
+    (void)vec_clear(*vec, freeelem);
+    free((*vec)->data);
+
+    if (LL_LOCK_MUTEX == (*vec)->policy)
+    {
+        pthread_mutex_destroy(&(*vec)->lock.mutex);
+    }
+    else if (LL_LOCK_SPIN == (*vec)->policy)
+    {
+        pthread_spin_destroy(&(*vec)->lock.spin);
+    }
+
+    free(*vec);
+    *vec = NULL;
+}
+
+int32_t
+vec_iter_init (vec_t *vec, vec_iter_t *iter)
+{
+    int32_t ret_val = RETVAL_FAILURE;
+    if ((NULL == vec) || (NULL == iter))
+    {
+        goto VEC_ITER_INIT_RET;
+    }
+
+    iter->pos = 0;
+    ret_val   = RETVAL_SUCCESS;
+
+VEC_ITER_INIT_RET:
+    return ret_val;
+}
+
+void *
+vec_iter_span (vec_t *vec, vec_iter_t *iter, size_t max_count, size_t *count)
+{
+    void *span = NULL;
+    if ((NULL == vec) || (NULL == iter) || (NULL == count))
+    {
+        goto VEC_ITER_SPAN_RET;
+    }
+    *count = 0;
+
+    vec_lock(vec);
+
+    if (iter->pos < vec->count)
+    {
+        size_t run = vec->count - iter->pos;
+        if ((0 != max_count) && (run > max_count))
+        {
+            run = max_count;
+        }
+
+        span = vec->data + (iter->pos * vec->stride);
+        iter->pos += run;
+        *count = run;
+    }
+
+    vec_unlock(vec);
+
+VEC_ITER_SPAN_RET:
+    return span;
+}
+
+/*** end of file ***/
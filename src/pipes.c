@@ -1,4 +1,5 @@
 #include <errno.h>
+#include <getopt.h>
 #include <locale.h>
 #include <pthread.h>
 #include <signal.h>
@@ -13,12 +14,31 @@
 #include <unistd.h>
 #include <wchar.h>
 
+#include "../include/lib_alias.h"
+#include "../include/lib_bcast.h"
+#include "../include/lib_bitboard.h"
+#include "../include/lib_density.h"
+#include "../include/lib_fade.h"
+#include "../include/lib_frame.h"
+#include "../include/lib_grid.h"
 #include "../include/lib_llist.h"
+#include "../include/lib_palette.h"
+#include "../include/lib_raster.h"
+#include "../include/lib_render.h"
+#include "../include/lib_scene.h"
+#include "../include/lib_shmgrid.h"
+#include "../include/lib_snap.h"
+#include "../include/lib_soak.h"
+#include "../include/lib_trace.h"
+#include "../include/lib_vector.h"
 
 volatile sig_atomic_t gb_SIGINT_BOOL; // Boolean of whether CTRL+C (SIGINT) has been thrown
+volatile sig_atomic_t gb_SIGWINCH_BOOL; // Boolean of whether the Terminal Window was resized
 volatile sig_atomic_t g_WINSIZE_x = 1; // Horizontal size of the Terminal Window
 volatile sig_atomic_t g_WINSIZE_y = 1; // Vertical size of the Terminal Window
 
+static _Alignas(int32_t) char g_rng[SNAP_RNG_BYTES]; // random()'s state, so a snapshot can hold it
+
 #define HORIZ    0x2501 // '━'; // 0x2500 // '─'
 #define VERTI    0x2503 // '┃'; // 0x2502 // '│'
 #define TOPLEFT  0x250f // '┏'; // 0x256D // '╭'
@@ -29,7 +49,62 @@ volatile sig_atomic_t g_WINSIZE_y = 1; // Vertical size of the Terminal Window
 // {'-': '━', '|': '┃', 'F': '┏', '7': '┓', 'L': '┗', 'J': '┛', '.': ':', 'S': 'S', '+': '╋'}
 
 #define MILLIS_PER_SEC 1000000
+#define MILLIS_PER_TICK 100000 // between viewer services while paused
+#define RENDER_COLS 240 // default render grid: 1920x1072 at 8x16 cells
+#define RENDER_ROWS 67
+#define OPT_CELL    256 // long-only options
+#define OPT_WARM    257
+#define OPT_DUMP    258
+#define OPT_FADE    259
+#define OPT_BACKEND 260
+#define OPT_RECORD  261
+#define OPT_FILL    262
+#define OPT_LOOK    263
+#define OPT_TRACE   264
+#define OPT_STEPS   265
+#define OPT_SEED    266
+#define OPT_SOAK    267
+#define OPT_SOAK_MAX  268
+#define OPT_SOAK_RATE 269
+#define OPT_TURNS   270
+#define OPT_PERSONA 271
+#define OPT_WALLS   272
+#define OPT_SNAP    273
+#define OPT_SNAP_EVERY 274
+#define OPT_CYCLE   275
+#define OPT_GFX_BUDGET 276
+#define OPT_3D      277
+#define DUMP_WARM   1000 // steps simulated by --dump-grid without --warm
+#define DEFAULT_COLS 80 // when there is no terminal to ask
+#define DEFAULT_ROWS 24
+#define SOAK_MAX_MB  64 // --soak ceilings: RSS and heap in use
+#define SOAK_RATE    64 // allocations per 1000 steps
+#define GFX_BUDGET   16384 // kitty/sixel bytes per frame; ~240 KB/s at 15fps
 #define MAX_COLOR_STEPS (128 + 128 + 256 + 256 + 256)
+#define CYCLE_BAND  32 // --cycle: palette indices the rainbow is drawn in
+#define CYCLE_FIRST (PALETTE_SIZE - CYCLE_BAND)
+#define CYCLE_SPEED 8 // color steps the band turns per frame
+#define CYCLE_PROBE_MS 250 // wait for the terminal's palette answer
+#define FRAME_3D    33333 // --3d: microseconds a frame, 30fps
+#define VIEW_YAW    0.30f // --3d: turned at least this far either way,
+#define VIEW_TURN   0.40f // and up to this much more (radians)
+#define VIEW_PITCH  0.20f // looking down at least this much,
+#define VIEW_TILT   0.30f // and up to this much more
+#define TURN_STRAIGHT 0 // alias table outcomes
+#define TURN_LEFT     1
+#define TURN_RIGHT    2
+#define TURN_KINDS    3
+#define WALL_LEVELS   5 // room ahead of a heading: 0, 1, 2-3, 4-7, 8+ cells
+#define PERSONAS      5
+
+/* --personalities: each pipe scales the --turns weights by one of these */
+static const uint32_t g_personas[PERSONAS][TURN_KINDS] = {
+    { 1, 1, 1 }, // as given
+    { 4, 1, 1 }, // cruiser: long straight runs
+    { 1, 2, 2 }, // twister
+    { 1, 2, 1 }, // drifts left
+    { 1, 1, 2 }, // drifts right
+};
 
 /**
  * @brief vertex_t - struct for containing vertex info
@@ -49,19 +124,117 @@ typedef struct vertex_t
     int32_t dir_y; // y direction of NEXT char
 } vertex_t;
 
+/**
+ * @brief screen_t - struct for containing the output state
+ *
+ * @param frame   (frame_t *)    bytes drawn this step; sent to stdout + viewers
+ * @param render  (render_t *)   terminal backend that encodes cells into FRAME
+ * @param grid    (grid_t *)     cells currently on screen, for viewer keyframes
+ * @param bcast   (bcast_t *)    viewer socket; NULL unless serving (-S)
+ * @param shm     (shmgrid_t *)  shared grid export; NULL unless exporting (-M)
+ * @param raster  (raster_t *)   offline renderer; NULL unless rendering (-R)
+ * @param fade    (fade_t *)     ages drawn cells; NULL unless fading (--fade)
+ * @param density (density_t *)  filled space per tile; NULL unless --fill
+ * @param board   (bitboard_t *) taken cells; NULL unless --lookahead
+ * @param soak    (soak_t *)     memory and allocation watch; NULL unless --soak
+ * @param turns   (alias_t *)    weighted turn tables; NULL turns uniformly
+ * @param fmt     (raster_fmt_t) image format written by the renderer
+ * @param frames  (int64_t)      images left to render; -1 for no limit
+ * @param warm    (int64_t)      steps left to simulate before showing anything
+ * @param steps   (int64_t)      steps left to draw unpaced (--steps); -1 paced
+ * @param b_dump  (bool)         print the screen as text after warming, exit
+ * @param b_color (bool)         keep colors in the text dump (-c)
+ * @param fixed_x (int32_t)      fixed columns (-G); 0 follows the terminal
+ * @param fixed_y (int32_t)      fixed rows (-G); 0 follows the terminal
+ * @param look    (int32_t)      lookahead depth in steps (--lookahead)
+ * @param turn_w  (uint32_t[][]) straight/left/right weights per personality
+ * @param persona (int32_t)      personality of the current pipe
+ * @param b_persona (bool)       a new personality for every pipe
+ * @param b_walls (bool)         turn tables by the room ahead (--walls)
+ * @param snap_path  (const char *) snapshot file; NULL unless --snapshot
+ * @param snap_every (int64_t)   seconds between snapshots; 0 only on exit
+ * @param snap_next  (time_t)    when the next periodic snapshot is due
+ * @param palette (palette_t *)  cycled band; NULL unless --cycle and OSC 4
+ * @param phase   (int32_t)      color step the band is turned to
+ * @param lattice (lattice_t *)  the 3D pipes; NULL unless --3d
+ * @param scene   (scene_t *)    their rasterizer; NULL unless --3d
+ */
+typedef struct screen_t
+{
+    frame_t      *frame; // bytes drawn this step; sent to stdout + viewers
+    render_t     *render; // terminal backend that encodes cells into FRAME
+    grid_t       *grid; // cells currently on screen, for viewer keyframes
+    bcast_t      *bcast; // viewer socket; NULL unless serving (-S)
+    shmgrid_t    *shm; // shared grid export; NULL unless exporting (-M)
+    raster_t     *raster; // offline renderer; NULL unless rendering (-R)
+    fade_t       *fade; // ages drawn cells; NULL unless fading (--fade)
+    density_t    *density; // filled space per tile; NULL unless --fill
+    bitboard_t   *board; // taken cells; NULL unless --lookahead
+    soak_t       *soak; // memory and allocation watch; NULL unless --soak
+    alias_t      *turns; // weighted turn tables; NULL turns uniformly
+    raster_fmt_t  fmt; // image format written by the renderer
+    int64_t       frames; // images left to render; -1 for no limit
+    int64_t       warm; // steps left to simulate before showing anything
+    int64_t       steps; // steps left to draw unpaced (--steps); -1 paced
+    bool          b_dump; // print the screen as text after warming, exit
+    bool          b_color; // keep colors in the text dump (-c)
+    int32_t       fixed_x; // fixed columns (-G); 0 follows the terminal
+    int32_t       fixed_y; // fixed rows (-G); 0 follows the terminal
+    int32_t       look; // lookahead depth in steps (--lookahead)
+    uint32_t      turn_w[PERSONAS][TURN_KINDS]; // weights per personality
+    int32_t       persona; // personality of the current pipe
+    bool          b_persona; // a new personality for every pipe
+    bool          b_walls; // turn tables by the room ahead (--walls)
+    const char   *snap_path; // snapshot file; NULL unless --snapshot
+    int64_t       snap_every; // seconds between snapshots; 0 only on exit
+    time_t        snap_next; // when the next periodic snapshot is due
+    palette_t    *palette; // cycled band; NULL unless --cycle and OSC 4
+    int32_t       phase; // color step the band is turned to
+    lattice_t    *lattice; // the 3D pipes; NULL unless --3d
+    scene_t      *scene; // their rasterizer; NULL unless --3d
+} screen_t;
+
+/**
+ * @brief print_char_f - puts one pipe segment on the screen; picked once from
+ * -c, so the step loop does not branch on the color mode.
+ */
+typedef int32_t (*print_char_f)(screen_t *screen, vertex_t *vert, int32_t idx);
+
 static void    sigint_h(int32_t sig);
 static void    sigwinch_h(int sig);
 static void    print_help(void);
-static void    draw_border(void);
-static int32_t print_char_c(vertex_t *vert, int32_t idx);
-static int32_t print_char_w(vertex_t *vert);
+static void    query_size(screen_t *screen);
+static void    resize_screen(screen_t *screen);
+static void    flush_screen(screen_t *screen);
+static int32_t encode_keyframe(frame_t *frame, void *screen);
+static void    draw_border(screen_t *screen);
+static uint32_t rainbow(int32_t idx);
+static void    cycle_palette(screen_t *screen);
+static int32_t print_char_c(screen_t *screen, vertex_t *vert, int32_t idx);
+static int32_t print_char_p(screen_t *screen, vertex_t *vert, int32_t idx);
+static int32_t print_char_w(screen_t *screen, vertex_t *vert, int32_t idx);
+static int32_t put_char(screen_t *screen, vertex_t *vert, const cell_t *cell);
+static int32_t build_turns(screen_t *screen, const uint32_t *weights);
+static int32_t roll_choice(screen_t *screen, const vertex_t *curr,
+                           const vertex_t *prev, const wchar_t *choices);
+static int32_t roll_turn(screen_t *screen, const vertex_t *curr,
+                         const vertex_t *prev, const wchar_t *choices);
+static int32_t wall_level(const vertex_t *vert, int32_t dir_x, int32_t dir_y);
+static void    glyph_exit(wchar_t c, int32_t *dir_x, int32_t *dir_y);
 static int32_t check_bounds(vertex_t *vert);
-static void    debug_path_len(llist_t *path);
+static int32_t resume_snapshot(screen_t *screen, snap_t *snap, vertex_t *head,
+                               int32_t *idx);
+static void    save_snapshot(screen_t *screen, const vertex_t *head,
+                             int32_t idx);
+static void    grow_3d(screen_t *screen);
+static void    show_3d(screen_t *screen, size_t first);
+static void    debug_path_len(screen_t *screen, vec_t *path);
+static int32_t attach_viewer(const char *path);
 
 int
 main (int argc, char **argv)
 {
-    srand(time(NULL));
+    initstate((unsigned int)time(NULL), g_rng, sizeof(g_rng)); // rand() too
 
     int32_t          end_ret = -1;
     struct sigaction saint   = { .sa_handler = sigint_h };
@@ -74,6 +247,14 @@ main (int argc, char **argv)
         goto END_RET;
     }
 
+    // deploys and reboots: stop the same way, so --snapshot is written
+    if (sigaction(SIGTERM, &saint, NULL) == -1)
+    {
+        perror("sigterm sigaction");
+        errno = 0;
+        goto END_RET;
+    }
+
     if (sigaction(SIGWINCH, &sawinch, NULL) == -1)
     {
         perror("sigwinch sigaction");
@@ -83,15 +264,269 @@ main (int argc, char **argv)
     setlocale(LC_ALL, "en_US.UTF-8");
     fwide(stdout, 1); // set stdout to widechar mode
 
-    bool b_colormode = false;
+    const char *serve_path  = NULL;
+    const char *shm_path    = NULL;
+    const char *record_path = NULL;
+    const char *trace_path  = NULL;
+    int64_t     soak_secs   = 0;
+    int64_t     soak_max    = SOAK_MAX_MB;
+    int64_t     soak_rate   = SOAK_RATE;
+    bool        b_render    = false;
+    bool        b_backend   = false;
+    bool        b_fill      = false;
+    bool        b_turns     = false;
+    bool        b_cycle     = false;
+    bool        b_cell      = false;
+    bool        b_3d        = false;
+    int64_t     gfx_budget  = GFX_BUDGET;
+    uint32_t    turns[TURN_KINDS] = { 2, 1, 1 }; // straight is listed twice
+    render_kind_t backend   = render_detect();
+    int32_t     cell_w      = 8;
+    int32_t     cell_h      = 16;
+    int32_t     fade_frames = 0;
+    screen_t    screen      = { .frames = -1, .steps = -1 };
+
+    static const struct option long_opts[] = {
+        { "render", required_argument, NULL, 'R' },
+        { "frames", required_argument, NULL, 'F' },
+        { "cell", required_argument, NULL, OPT_CELL },
+        { "warm", required_argument, NULL, OPT_WARM },
+        { "dump-grid", no_argument, NULL, OPT_DUMP },
+        { "fade", required_argument, NULL, OPT_FADE },
+        { "backend", required_argument, NULL, OPT_BACKEND },
+        { "record", required_argument, NULL, OPT_RECORD },
+        { "fill", no_argument, NULL, OPT_FILL },
+        { "lookahead", required_argument, NULL, OPT_LOOK },
+        { "trace", required_argument, NULL, OPT_TRACE },
+        { "steps", required_argument, NULL, OPT_STEPS },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "soak", required_argument, NULL, OPT_SOAK },
+        { "soak-max", required_argument, NULL, OPT_SOAK_MAX },
+        { "soak-rate", required_argument, NULL, OPT_SOAK_RATE },
+        { "turns", required_argument, NULL, OPT_TURNS },
+        { "personalities", no_argument, NULL, OPT_PERSONA },
+        { "walls", no_argument, NULL, OPT_WALLS },
+        { "snapshot", required_argument, NULL, OPT_SNAP },
+        { "snapshot-every", required_argument, NULL, OPT_SNAP_EVERY },
+        { "cycle", no_argument, NULL, OPT_CYCLE },
+        { "gfx-budget", required_argument, NULL, OPT_GFX_BUDGET },
+        { "3d", no_argument, NULL, OPT_3D },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
 
     int opt = 0;
-    while ((opt = getopt(argc, argv, "ch")) != -1)
+    while ((opt = getopt_long(argc, argv, "chS:A:G:M:R:F:", long_opts, NULL))
+           != -1)
     {
         switch (opt)
         {
             case 'c':
-                b_colormode = true;
+                screen.b_color = true;
+                break;
+
+            case 'S':
+                serve_path = optarg;
+                break;
+
+            case 'M':
+                shm_path = optarg;
+                break;
+
+            case 'A':
+                end_ret = attach_viewer(optarg);
+                goto END_RET;
+
+            case 'G':
+                if ((2 != sscanf(optarg, "%dx%d", &screen.fixed_x,
+                                 &screen.fixed_y))
+                    || (screen.fixed_x < 3) || (screen.fixed_y < 3))
+                {
+                    fprintf(stderr, "Bad grid size: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case 'R':
+                b_render   = true;
+                screen.fmt = (0 == strcmp(optarg, "raw")) ? RASTER_RAW
+                                                          : RASTER_PPM;
+                if ((RASTER_PPM == screen.fmt) && (0 != strcmp(optarg, "ppm")))
+                {
+                    fprintf(stderr, "Unknown image format: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case 'F':
+                screen.frames = strtoll(optarg, NULL, 10);
+                if (screen.frames < 1)
+                {
+                    fprintf(stderr, "Bad frame count: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_CELL:
+                if ((2 != sscanf(optarg, "%dx%d", &cell_w, &cell_h))
+                    || (cell_w < 1) || (cell_h < 1))
+                {
+                    fprintf(stderr, "Bad cell size: %s\n", optarg);
+                    goto END_RET;
+                }
+                b_cell = true;
+                break;
+
+            case OPT_WARM:
+                screen.warm = strtoll(optarg, NULL, 10);
+                if (screen.warm < 1)
+                {
+                    fprintf(stderr, "Bad warm step count: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_DUMP:
+                screen.b_dump = true;
+                break;
+
+            case OPT_FADE:
+                fade_frames = (int32_t)strtol(optarg, NULL, 10);
+                if (fade_frames < 1)
+                {
+                    fprintf(stderr, "Bad fade length: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_BACKEND:
+                if (RETVAL_SUCCESS != render_parse(optarg, &backend))
+                {
+                    fprintf(stderr, "Unknown backend: %s\n", optarg);
+                    goto END_RET;
+                }
+                b_backend = true;
+                break;
+
+            case OPT_RECORD:
+                record_path = optarg;
+                backend     = RENDER_RECORD;
+                b_backend   = true;
+                break;
+
+            case OPT_FILL:
+                b_fill = true;
+                break;
+
+            case OPT_LOOK:
+                screen.look = (int32_t)strtol(optarg, NULL, 10);
+                if ((screen.look < 1) || (screen.look > BITBOARD_MAX_STEPS))
+                {
+                    fprintf(stderr, "Bad lookahead (1 to %d): %s\n",
+                            BITBOARD_MAX_STEPS, optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_TRACE:
+                trace_path = optarg;
+                break;
+
+            case OPT_STEPS:
+                screen.steps = strtoll(optarg, NULL, 10);
+                if (screen.steps < 1)
+                {
+                    fprintf(stderr, "Bad step count: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_SOAK:
+                soak_secs = strtoll(optarg, NULL, 10);
+                if (soak_secs < 1)
+                {
+                    fprintf(stderr, "Bad soak length: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_SOAK_MAX:
+                soak_max = strtoll(optarg, NULL, 10);
+                if (soak_max < 1)
+                {
+                    fprintf(stderr, "Bad soak memory ceiling: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_SOAK_RATE:
+                soak_rate = strtoll(optarg, NULL, 10);
+                if (soak_rate < 0)
+                {
+                    fprintf(stderr, "Bad soak allocation ceiling: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_TURNS:
+                if ((3 != sscanf(optarg, "%u:%u:%u", &turns[TURN_STRAIGHT],
+                                 &turns[TURN_LEFT], &turns[TURN_RIGHT]))
+                    || (turns[TURN_STRAIGHT] > UINT16_MAX)
+                    || (turns[TURN_LEFT] > UINT16_MAX)
+                    || (turns[TURN_RIGHT] > UINT16_MAX)
+                    || (0 == turns[TURN_STRAIGHT] + turns[TURN_LEFT]
+                                 + turns[TURN_RIGHT]))
+                {
+                    fprintf(stderr, "Bad turn weights: %s\n", optarg);
+                    goto END_RET;
+                }
+                b_turns = true;
+                break;
+
+            case OPT_PERSONA:
+                screen.b_persona = true;
+                b_turns          = true;
+                break;
+
+            case OPT_WALLS:
+                screen.b_walls = true;
+                b_turns        = true;
+                break;
+
+            case OPT_SNAP:
+                screen.snap_path = optarg;
+                break;
+
+            case OPT_SNAP_EVERY:
+                screen.snap_every = strtoll(optarg, NULL, 10);
+                if (screen.snap_every < 1)
+                {
+                    fprintf(stderr, "Bad snapshot interval: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_GFX_BUDGET:
+                gfx_budget = strtoll(optarg, NULL, 10);
+                if (gfx_budget < 0)
+                {
+                    fprintf(stderr, "Bad graphics budget: %s\n", optarg);
+                    goto END_RET;
+                }
+                break;
+
+            case OPT_CYCLE:
+                b_cycle        = true;
+                screen.b_color = true; // the fallback
+                break;
+
+            case OPT_3D:
+                b_3d = true;
+                break;
+
+            case OPT_SEED:
+                // same seed, same grid size: the same pipes, step for step
+                srand((unsigned int)strtoul(optarg, NULL, 10));
                 break;
 
             case 'h':
@@ -99,7 +534,7 @@ main (int argc, char **argv)
                 goto END_RET;
 
             case '?':
-                fprintf(stderr, "Unknown option: -%c\n", optopt);
+                // getopt_long has already named the bad option
                 goto END_RET;
             
             default:
@@ -108,41 +543,290 @@ main (int argc, char **argv)
         }
     }
 
-    llist_t *path = ll_create();
+    // append-only, walked in order: vertices stored inline, not one per node
+    vec_t *path = vec_create(sizeof(vertex_t), LL_LOCK_NONE);
+
+    screen.frame = frame_create(0);
+    screen.grid  = grid_create(1, 1);
+    if ((NULL == path) || (NULL == screen.frame) || (NULL == screen.grid))
+    {
+        goto END_FREE;
+    }
+
+#ifndef TRACE
+    if (NULL != trace_path)
+    {
+        fprintf(stderr, "Tracing is compiled out; build with 'make trace'\n");
+        goto END_FREE;
+    }
+#endif
+
+#ifndef SOAK
+    if (0 < soak_secs)
+    {
+        fprintf(stderr, "Soak testing is compiled out; build with 'make soak'\n");
+        goto END_FREE;
+    }
+#endif
+
+    if ((0 < screen.snap_every) && (NULL == screen.snap_path))
+    {
+        fprintf(stderr, "--snapshot-every needs --snapshot FILE\n");
+        goto END_FREE;
+    }
+
+    if (b_cycle && (0 < fade_frames))
+    {
+        fprintf(stderr, "--cycle and --fade both recolor; pick one\n");
+        goto END_FREE;
+    }
+
+    // the 3D pipes are a picture of their own: truecolor half blocks
+    if (b_3d
+        && ((b_backend && (RENDER_TRUECOLOR != backend)) || b_render
+            || (NULL != serve_path) || (NULL != shm_path) || (0 < fade_frames)
+            || b_fill || b_turns || (0 < screen.look) || b_cycle
+            || (0 < screen.warm) || screen.b_dump || (0 < soak_secs)
+            || (NULL != screen.snap_path)))
+    {
+        fprintf(stderr, "--3d goes with -G, --steps, --seed and --trace only\n");
+        goto END_FREE;
+    }
+
+    if (b_3d)
+    {
+        backend        = RENDER_TRUECOLOR;
+        screen.lattice = lattice_create(LATTICE_MIN, LATTICE_MIN, LATTICE_MIN);
+        screen.scene   = scene_create(0);
+        if ((NULL == screen.lattice) || (NULL == screen.scene))
+        {
+            goto END_FREE;
+        }
+    }
+
+    if ((RENDER_RECORD == backend) && (NULL == record_path))
+    {
+        fprintf(stderr, "The record backend needs --record FILE\n");
+        goto END_FREE;
+    }
+
+    // viewers are sent the terminal stream; images uploaded once are not
+    if ((NULL != serve_path)
+        && ((RENDER_NULL == backend) || (RENDER_RECORD == backend)
+            || (RENDER_KITTY == backend) || (RENDER_SIXEL == backend)))
+    {
+        fprintf(stderr, "Cannot serve viewers without a terminal backend\n");
+        goto END_FREE;
+    }
+
+    if (NULL != serve_path)
+    {
+        screen.bcast = bcast_create(serve_path, 0);
+        if (NULL == screen.bcast)
+        {
+            goto END_FREE;
+        }
+    }
+
+    if (NULL != shm_path)
+    {
+        if (screen.fixed_y > SHMGRID_MAX_ROWS)
+        {
+            fprintf(stderr, "-M shares at most %d rows\n", SHMGRID_MAX_ROWS);
+            goto END_FREE;
+        }
+        screen.shm = shmgrid_create(shm_path);
+        if (NULL == screen.shm)
+        {
+            goto END_FREE;
+        }
+    }
+
+    if (0 < fade_frames)
+    {
+        screen.fade = fade_create(1, 1, fade_frames);
+        if (NULL == screen.fade)
+        {
+            goto END_FREE;
+        }
+    }
+
+    if (b_fill)
+    {
+        screen.density = density_create(1, 1);
+        if (NULL == screen.density)
+        {
+            goto END_FREE;
+        }
+    }
+
+    if (b_turns && (RETVAL_SUCCESS != build_turns(&screen, turns)))
+    {
+        goto END_FREE;
+    }
+
+    if (0 < screen.look)
+    {
+        screen.board = bitboard_create(1, 1);
+        if (NULL == screen.board)
+        {
+            goto END_FREE;
+        }
+    }
+
+    if ((0 < soak_secs) && !b_backend)
+    {
+        // headless: a kiosk-sized screen that nothing draws
+        backend = RENDER_NULL;
+        if (0 == screen.fixed_x)
+        {
+            screen.fixed_x = RENDER_COLS;
+            screen.fixed_y = RENDER_ROWS;
+        }
+    }
+
+    if (b_render)
+    {
+        // headless: stdout carries images, not the terminal stream
+        if (0 == screen.fixed_x)
+        {
+            screen.fixed_x = RENDER_COLS;
+            screen.fixed_y = RENDER_ROWS;
+        }
+
+        screen.raster = raster_create(cell_w, cell_h, 0);
+        if (NULL == screen.raster)
+        {
+            goto END_FREE;
+        }
+
+        // nothing reads the terminal stream unless viewers do
+        if (!b_backend && (NULL == serve_path))
+        {
+            backend = RENDER_NULL;
+        }
+    }
+
+    screen.render = render_create(backend, record_path);
+    if (NULL == screen.render)
+    {
+        goto END_FREE;
+    }
+    render_begin_frame(screen.render, screen.frame);
+
+    if ((RENDER_KITTY == backend) || (RENDER_SIXEL == backend))
+    {
+        // sprites the size of the terminal's cells, if it says
+        struct winsize ws = { 0 };
+        if (!b_cell && (0 == ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws))
+            && (0 < ws.ws_col) && (0 < ws.ws_row)
+            && (ws.ws_xpixel >= ws.ws_col) && (ws.ws_ypixel >= ws.ws_row))
+        {
+            cell_w = ws.ws_xpixel / ws.ws_col;
+            cell_h = ws.ws_ypixel / ws.ws_row;
+        }
+        errno = 0;
+
+        if (RETVAL_SUCCESS != render_graphics(screen.render, cell_w, cell_h,
+                                              (size_t)gfx_budget))
+        {
+            fprintf(stderr, "Cannot draw sprites of %dx%d pixels (2 to %d)\n",
+                    cell_w, cell_h, SPRITE_MAX_PX);
+            goto END_FREE;
+        }
+    }
+
+    // only a terminal that reports its palette has it changed (and restored)
+    if (b_cycle && ((RENDER_TRUECOLOR == backend) || (RENDER_256 == backend))
+        && (NULL == screen.raster) && !screen.b_dump
+        && isatty(STDOUT_FILENO))
+    {
+        screen.palette = palette_create(CYCLE_FIRST, CYCLE_BAND);
+        if ((NULL != screen.palette)
+            && (RETVAL_SUCCESS
+                != palette_probe(screen.palette, CYCLE_PROBE_MS)))
+        {
+            palette_destroy(&screen.palette); // the fixed rainbow of -c
+        }
+    }
+
+    if (screen.b_dump && (0 == screen.warm))
+    {
+        screen.warm = DUMP_WARM;
+    }
+
+    if ((NULL != trace_path) && (RETVAL_SUCCESS != trace_open(trace_path)))
+    {
+        goto END_FREE;
+    }
+
+    if (0 < soak_secs)
+    {
+        // last, so set-up allocations are not held against the run
+        screen.soak = soak_create(soak_secs, (size_t)soak_max * 1024 * 1024,
+                                  (uint64_t)soak_rate);
+        if (NULL == screen.soak)
+        {
+            goto END_FREE;
+        }
+    }
 
     gb_SIGINT_BOOL = 1;
-    // hide cursor
-    wprintf(L"\033[?25l");
 
-    wchar_t *choices = calloc(4, sizeof(*choices));
-    int32_t idx = rand() % UINT16_MAX;
+    wchar_t     *choices    = calloc(4, sizeof(*choices));
+    int32_t      idx        = rand() % UINT16_MAX;
+    print_char_f print_char = (NULL != screen.palette) ? print_char_p
+                              : screen.b_color           ? print_char_c
+                                                         : print_char_w;
+    snap_t      *snap       = snap_open(screen.snap_path); // NULL: fresh start
+    screen.snap_next        = time(NULL) + screen.snap_every;
 
-    while (gb_SIGINT_BOOL)
+    if (NULL != screen.scene)
+    {
+        grow_3d(&screen); // the whole run, until Ctrl+C or --steps
+    }
+
+    while (gb_SIGINT_BOOL && (NULL == screen.scene))
     {
-        vertex_t *prev  = NULL;
-        vertex_t *curr  = NULL;
-        vertex_t *start = NULL;
+        vertex_t  verts[2] = { 0 }; // PREV and CURR; PATH keeps its own copy
+        vertex_t *prev     = &verts[0];
+        vertex_t *curr     = &verts[1];
+        vertex_t *start    = &verts[0];
 
-        sigwinch_h(0); // reuse sighandler to do inital window setup
+        TRACE_MARK("cycle");
+        if (screen.b_persona)
+        {
+            screen.persona = rand() % PERSONAS; // a new pipe, a new temper
+        }
+        resize_screen(&screen); // inital window setup
 
-        // start at direct middle with a '-'
-        start        = calloc(1, sizeof(*start));
-        start->c     = HORIZ;
-        start->x     = g_WINSIZE_x / 2;
-        start->y     = g_WINSIZE_y / 2;
-        start->dir_y = 0;
-        start->dir_x = (((rand() % 20) < 10) ? -1 : 1); // flip a coin for right or left
-        ll_enq(path, start);
+        // the step budget below is spent: wrap without a jump in color
+        if (idx >= UINT16_MAX * 2)
+        {
+            idx %= MAX_COLOR_STEPS;
+        }
 
-        if (b_colormode)
+        if ((NULL != snap)
+            && (RETVAL_SUCCESS == resume_snapshot(&screen, snap, start, &idx)))
         {
-            print_char_c(start, idx);
+            // pick up where the last run left off, in one screen emission
+            vec_append(path, start);
+            flush_screen(&screen);
         }
         else
         {
-            print_char_w(start);
+            // start at direct middle with a '-'
+            start->c     = HORIZ;
+            start->x     = g_WINSIZE_x / 2;
+            start->y     = g_WINSIZE_y / 2;
+            start->dir_y = 0;
+            start->dir_x = (((rand() % 20) < 10) ? -1 : 1); // flip a coin for right or left
+            vec_append(path, start);
+
+            print_char(&screen, start, idx);
+            flush_screen(&screen);
         }
-        prev = ll_tail(path);
+        snap_close(&snap); // only the first cycle resumes
 
         time_t t_start = { 0 };
         time_t t_end = { 0 };
@@ -157,13 +841,24 @@ main (int argc, char **argv)
             }
 
             time(&t_start);
-            curr = calloc(1, sizeof(*curr));
+            if ((0 < screen.snap_every) && (t_start >= screen.snap_next))
+            {
+                save_snapshot(&screen, prev, idx);
+            }
+
+            TRACE_BEGIN("simulate");
+            *curr = (vertex_t){ 0 };
+
+            if (gb_SIGWINCH_BOOL)
+            {
+                resize_screen(&screen);
+            }
 
             curr->x = (prev->x + prev->dir_x);
             curr->y = (prev->y + prev->dir_y);
 
 #ifdef DEBUG
-            debug_path_len(path);
+            debug_path_len(&screen, path);
 #endif
 
             // roll to pick the next direction
@@ -176,7 +871,7 @@ main (int argc, char **argv)
                     choices[1] = HORIZ;
                     choices[2] = TOPLEFT;
                     choices[3] = BOTLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == HORIZ)
                     {
                         curr->dir_x = -1;
@@ -199,7 +894,7 @@ main (int argc, char **argv)
                     choices[1] = HORIZ;
                     choices[2] = BOTRIGHT;
                     choices[3] = TOPRIGHT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == HORIZ)
                     {
                         curr->dir_x = 1;
@@ -225,7 +920,7 @@ main (int argc, char **argv)
                     choices[1] = VERTI;
                     choices[2] = TOPRIGHT;
                     choices[3] = TOPLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == VERTI)
                     {
                         curr->dir_x = 0;
@@ -248,7 +943,7 @@ main (int argc, char **argv)
                     choices[1] = VERTI;
                     choices[2] = BOTRIGHT;
                     choices[3] = BOTLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == VERTI)
                     {
                         curr->dir_x = 0;
@@ -274,7 +969,7 @@ main (int argc, char **argv)
                     choices[1] = HORIZ;
                     choices[2] = BOTRIGHT;
                     choices[3] = TOPRIGHT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == HORIZ)
                     {
                         curr->dir_x = 1;
@@ -297,7 +992,7 @@ main (int argc, char **argv)
                     choices[1] = VERTI;
                     choices[2] = BOTRIGHT;
                     choices[3] = BOTLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == VERTI)
                     {
                         curr->dir_x = 0;
@@ -323,7 +1018,7 @@ main (int argc, char **argv)
                     choices[1] = HORIZ;
                     choices[2] = TOPLEFT;
                     choices[3] = BOTLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == HORIZ)
                     {
                         curr->dir_x = -1;
@@ -346,7 +1041,7 @@ main (int argc, char **argv)
                     choices[1] = VERTI;
                     choices[2] = BOTRIGHT;
                     choices[3] = BOTLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == VERTI)
                     {
                         curr->dir_x = 0;
@@ -372,7 +1067,7 @@ main (int argc, char **argv)
                     choices[1] = HORIZ;
                     choices[2] = BOTRIGHT;
                     choices[3] = TOPRIGHT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == HORIZ)
                     {
                         curr->dir_x = 1;
@@ -395,7 +1090,7 @@ main (int argc, char **argv)
                     choices[1] = VERTI;
                     choices[2] = TOPRIGHT;
                     choices[3] = TOPLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == VERTI)
                     {
                         curr->dir_x = 0;
@@ -421,7 +1116,7 @@ main (int argc, char **argv)
                     choices[1] = HORIZ;
                     choices[2] = TOPLEFT;
                     choices[3] = BOTLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == HORIZ)
                     {
                         curr->dir_x = -1;
@@ -444,7 +1139,7 @@ main (int argc, char **argv)
                     choices[1] = VERTI;
                     choices[2] = TOPRIGHT;
                     choices[3] = TOPLEFT;
-                    curr->c    = choices[rand() % 4];
+                    curr->c    = choices[roll_choice(&screen, curr, prev, choices)];
                     if (curr->c == VERTI)
                     {
                         curr->dir_x = 0;
@@ -463,50 +1158,99 @@ main (int argc, char **argv)
                 }
             }
 
-            ll_enq(path, curr);
+            vec_append(path, curr);
 
             // print the char
-            if (b_colormode)
-            {
-                print_char_c(curr, idx);
-            }
-            else
-            {
-                print_char_w(curr);
-            }
+            print_char(&screen, curr, idx);
+            TRACE_END("simulate");
+            flush_screen(&screen);
 
             // check if next breaks map bounds
             if (0 != check_bounds(curr))
             {
+                TRACE_MARK("restart");
                 break;
             }
-            prev = curr;
+            vertex_t *temp = prev;
+            prev           = curr;
+            curr           = temp;
             time(&t_end);
 
+            if ((NULL != screen.raster) || (0 < screen.warm)
+                || (0 <= screen.steps) || (NULL != screen.soak))
+            {
+                continue; // offline, warming or timed: as fast as steps can go
+            }
+
             // usleep(30000 - (t_end - t_start)); // sleep(0.03) / 30fps
+            TRACE_BEGIN("sleep");
             usleep(60000 - (t_end - t_start)); // sleep(0.06) / 15fps
+            TRACE_END("sleep");
             // usleep(90000 - (t_end - t_start)); // sleep(0.09) / ~7fps
         }
 
+        if ((NULL != screen.soak)
+            && (RETVAL_SUCCESS != soak_cycle(screen.soak, vec_len(path))))
+        {
+            gb_SIGINT_BOOL = 0; // the time is up, or a ceiling was crossed
+        }
+
         // only sleep and startover when not Ctrl+C/SIGINT
-        if (gb_SIGINT_BOOL)
+        if (gb_SIGINT_BOOL && (NULL == screen.raster) && (0 == screen.warm)
+            && (0 > screen.steps) && (NULL == screen.soak))
+        {
+            // 5 Seconds; keep serving viewers (new ones need a keyframe)
+            for (int32_t tick = 0; gb_SIGINT_BOOL
+                                   && (tick < (5 * MILLIS_PER_SEC / MILLIS_PER_TICK));
+                 ++tick)
+            {
+                flush_screen(&screen);
+                TRACE_BEGIN("sleep");
+                usleep(MILLIS_PER_TICK);
+                TRACE_END("sleep");
+            }
+        }
+        if (!gb_SIGINT_BOOL && (NULL != screen.snap_path))
         {
-            usleep(5 * MILLIS_PER_SEC); // 5 Seconds
-            ll_destroy(&path, free);
-            path = ll_create();
+            save_snapshot(&screen, prev, idx); // on the way out
         }
+        vec_clear(path, NULL); // keep the capacity for the next cycle
     }
 
-    // clear screen
-    wprintf(L"\033[2J\033[;H");
-    // show cursor
-    wprintf(L"\033[?25h");
-    fflush(stdout);
+    if (!screen.b_dump)
+    {
+        // clear screen, show cursor, give the terminal its colors back
+        render_leave(screen.render, screen.frame);
+        palette_restore(screen.palette, screen.frame);
+        palette_destroy(&screen.palette);
+        flush_screen(&screen);
+    }
 
-    ll_destroy(&path, free);
     free(choices);
 
     end_ret = 0;
+    if ((NULL != screen.soak) && (RETVAL_SUCCESS != soak_report(screen.soak, stderr)))
+    {
+        end_ret = -1;
+    }
+
+END_FREE:
+    bcast_destroy(&screen.bcast);
+    shmgrid_destroy(&screen.shm);
+    raster_destroy(&screen.raster);
+    fade_destroy(&screen.fade);
+    density_destroy(&screen.density);
+    bitboard_destroy(&screen.board);
+    alias_destroy(&screen.turns);
+    palette_destroy(&screen.palette);
+    lattice_destroy(&screen.lattice);
+    scene_destroy(&screen.scene);
+    soak_destroy(&screen.soak);
+    render_destroy(&screen.render);
+    frame_unref(screen.frame);
+    grid_destroy(&screen.grid);
+    vec_destroy(&path, NULL);
+    trace_close(); // the raster workers are joined by now
 
 END_RET:
     return end_ret;
@@ -532,8 +1276,8 @@ sigint_h (int32_t sig)
 }
 
 /**
- * @brief SIGWINCH Handler function. Capture new window sizes, clear the screen,
- *  and redraw the border.
+ * @brief SIGWINCH Handler function. Flags the resize; the main loop does the
+ *  redraw, since none of that is async-signal-safe.
  * 
  * @param   sig     (int32_t)   SIGNAL Caught
  * 
@@ -543,20 +1287,7 @@ static void
 sigwinch_h (int sig)
 {
     (void)sig;
-    struct winsize ws;
-
-    if (ioctl(STDIN_FILENO, TIOCGWINSZ, &ws) != 0
-        && ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0
-        && ioctl(STDERR_FILENO, TIOCGWINSZ, &ws) != 0)
-    {
-        perror("sigwinch ioctl() sig:");
-    }
-
-    g_WINSIZE_x = ws.ws_col;
-    g_WINSIZE_y = ws.ws_row;
-    // clear screen
-    wprintf(L"\033[2J\033[;H");
-    draw_border();
+    gb_SIGWINCH_BOOL = 1;
 }
 
 /**
@@ -571,86 +1302,305 @@ print_help (void)
     wprintf(L"Display some pipes just like ye olden Windows Screensavers!\n");
     wprintf(L"\n OPTIONS:\n");
     wprintf(L"\t-c\n\t\tUse RGB-256 color mode\n");
+    wprintf(L"\t-S SOCKET\n\t\tAlso serve the animation to viewers on Unix socket SOCKET\n");
+    wprintf(L"\t-A SOCKET\n\t\tAttach this terminal as a viewer of SOCKET and Exit\n");
+    wprintf(L"\t-M FILE\n\t\tAlso publish the cell grid to memory-mapped FILE (e.g. /dev/shm/pipes)\n");
+    wprintf(L"\t-G COLSxROWS\n\t\tUse a fixed grid size instead of the window size\n");
+    wprintf(L"\t-R, --render ppm|raw\n\t\tRender headless to a stream of PPM or raw RGB24 images on stdout\n");
+    wprintf(L"\t-F, --frames N\n\t\tStop after rendering N images\n");
+    wprintf(L"\t--cell WxH\n\t\tPixel size of one cell when rendering or drawing sprites (default 8x16; sprites: the terminal's)\n");
+    wprintf(L"\t--fade N\n\t\tDim pipe segments over N steps until they disappear\n");
+    wprintf(L"\t--fill\n\t\tSteer turns toward the emptier parts of the screen\n");
+    wprintf(L"\t--lookahead N\n\t\tAvoid walls and the pipe itself, judging turns by the room N steps ahead (1 to %d)\n", BITBOARD_MAX_STEPS);
+    wprintf(L"\t--turns S:L:R\n\t\tWeigh going straight, turning left and turning right (default 2:1:1)\n");
+    wprintf(L"\t--personalities\n\t\tGive every pipe its own temper: straighter, twistier, or leaning one way\n");
+    wprintf(L"\t--walls\n\t\tTurn away from walls as they get near\n");
+    wprintf(L"\t--warm N\n\t\tSimulate N steps unseen, then start from the resulting screen\n");
+    wprintf(L"\t--dump-grid\n\t\tPrint the screen as text after warming (default %d steps) and Exit\n", DUMP_WARM);
+    wprintf(L"\t--backend truecolor|256|16|mono|null|kitty|sixel\n\t\tTerminal output (default from COLORTERM and TERM); kitty and sixel draw shaded pipe sprites\n");
+    wprintf(L"\t--gfx-budget BYTES\n\t\tMost bytes a kitty or sixel frame may take, the rest waits a frame (default %d; 0 no limit)\n", GFX_BUDGET);
+    wprintf(L"\t--record FILE\n\t\tRecord every cell drawn to FILE instead of the terminal\n");
+    wprintf(L"\t--steps N\n\t\tDraw N steps as fast as the terminal takes them, then Exit\n");
+    wprintf(L"\t--cycle\n\t\tAnimate the colors by turning a band of the palette (OSC 4); plain -c colors if the terminal can't\n");
+    wprintf(L"\t--3d\n\t\tGrow the pipes through 3D space, drawn in truecolor half blocks (only with -G, --steps, --seed)\n");
+    wprintf(L"\t--seed N\n\t\tSeed the random turns (default: the time), to repeat a run\n");
+    wprintf(L"\t--snapshot FILE\n\t\tResume from FILE if it holds a snapshot of this grid size, and save to it on exit\n");
+    wprintf(L"\t--snapshot-every SECS\n\t\tAlso save the snapshot every SECS seconds\n");
+    wprintf(L"\t--soak SECS\n\t\tRun headless and unpaced for SECS, then report memory use and allocations; fails if they grow ('make soak' builds only)\n");
+    wprintf(L"\t--soak-max MB\n\t\tFail the soak if RSS or heap in use passes MB (default %d)\n", SOAK_MAX_MB);
+    wprintf(L"\t--soak-rate N\n\t\tFail the soak past N allocations per 1000 steps (default %d)\n", SOAK_RATE);
+    wprintf(L"\t--trace FILE\n\t\tWrite a Chrome trace of each frame's phases to FILE on exit ('make trace' builds only)\n");
     wprintf(L"\t-h\n\t\tPrint this Help Menu and Exit\n");
     wprintf(L"\n");
 }
 
-/** 
- * @brief Draw the border around the Terminal Window.
+/**
+ * @brief Capture new window sizes (or the fixed -G size) into g_WINSIZE_x and
+ * g_WINSIZE_y.
+ * 
+ * @param   screen  (screen_t *) Output state with the fixed size
  * 
  * @returns N/A     (void)
  */
 static void
-draw_border (void)
+query_size (screen_t *screen)
 {
-    int i = 0;
-    int x = 0;
-
-    wprintf(L"\033[1m"); // bold
+    struct winsize ws = { .ws_col = g_WINSIZE_x, .ws_row = g_WINSIZE_y };
 
-    // top
-    wprintf(L"%lc", TOPLEFT);
-    for (i = 1; i < g_WINSIZE_x - 1; ++i)
+    gb_SIGWINCH_BOOL = 0;
+    if (screen->fixed_x > 0)
     {
-        wprintf(L"%lc", HORIZ);
+        ws.ws_col = screen->fixed_x;
+        ws.ws_row = screen->fixed_y;
     }
-    wprintf(L"%lc", TOPRIGHT);
-
-    // mid
-    for (i = 1; i < g_WINSIZE_y - 1; ++i) // for row
+    else if (ioctl(STDIN_FILENO, TIOCGWINSZ, &ws) != 0
+             && ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0
+             && ioctl(STDERR_FILENO, TIOCGWINSZ, &ws) != 0)
     {
-        for (x = 0; x < g_WINSIZE_x; ++x) // for column
+        perror("sigwinch ioctl() sig:");
+        errno = 0;
+        if (ws.ws_col < 3)
         {
-            if ((x == 0) || (x == g_WINSIZE_x - 1))
-            {
-                wprintf(L"%lc", VERTI);
-            }
-            else
-            {
-                putwchar(' ');
-            }
+            ws.ws_col = DEFAULT_COLS;
+            ws.ws_row = DEFAULT_ROWS;
         }
-        putwchar('\n');
     }
 
-    // bottom
-    wprintf(L"%lc", BOTLEFT);
-    for (i = 1; i < g_WINSIZE_x - 1; ++i)
+    g_WINSIZE_x = ws.ws_col;
+    g_WINSIZE_y = ws.ws_row;
+}
+
+/**
+ * @brief Capture new window sizes, clear the screen, and redraw the border.
+ * 
+ * @param   screen  (screen_t *) Output state to reset
+ * 
+ * @returns N/A     (void)
+ */
+static void
+resize_screen (screen_t *screen)
+{
+    TRACE_BEGIN("resize");
+    query_size(screen);
+
+    if (RETVAL_SUCCESS == grid_resize(screen->grid, g_WINSIZE_x, g_WINSIZE_y))
+    {
+        draw_border(screen);
+    }
+
+    // a fade left at the old size would age the wrong cells: drop it
+    if ((NULL != screen->fade)
+        && (RETVAL_SUCCESS
+            != fade_resize(screen->fade, g_WINSIZE_x, g_WINSIZE_y)))
+    {
+        fprintf(stderr, "Out of memory resizing the fade; --fade is off\n");
+        fade_destroy(&screen->fade);
+    }
+
+    if (NULL != screen->density)
+    {
+        density_resize(screen->density, g_WINSIZE_x, g_WINSIZE_y);
+    }
+
+    if ((NULL != screen->board)
+        && (RETVAL_SUCCESS
+            == bitboard_resize(screen->board, g_WINSIZE_x, g_WINSIZE_y)))
     {
-        wprintf(L"%lc", HORIZ);
+        // the border, and the row above it that check_bounds also keeps off
+        for (int32_t x = 0; x < g_WINSIZE_x; ++x)
+        {
+            bitboard_set(screen->board, x, 0);
+            bitboard_set(screen->board, x, g_WINSIZE_y - 2);
+            bitboard_set(screen->board, x, g_WINSIZE_y - 1);
+        }
+        for (int32_t y = 0; y < g_WINSIZE_y; ++y)
+        {
+            bitboard_set(screen->board, 0, y);
+            bitboard_set(screen->board, g_WINSIZE_x - 1, y);
+        }
     }
-    wprintf(L"%lc", BOTRIGHT);
-    fflush(stdout);
 
-    wprintf(L"\033[0m"); // reset
+    // clear screen and redraw; also what a new viewer is sent
+    if (0 == screen->warm)
+    {
+        render_keyframe(screen->render, screen->grid, screen->frame);
+    }
+    TRACE_END("resize");
 }
 
 /**
- * @brief Print the associated character in 256 - RGB Color mode.
- *
- * @param   vert        (vertex_t *) Vertex PTR of the associated vertex to
- * print.
- * @param   idx         (int32_t)    Index INT for correct iterative stepping
- * through RGB Values. 
+ * @brief Send this step's bytes to the terminal (or, rendering, an image of
+ * the screen to stdout if anything changed) and to any viewers, publish the
+ * changed rows to the shared grid, then start a fresh frame. Viewers still
+ * queueing the old one keep their reference.
  * 
- * @note    Only 1024 possible RGB values; any given index will be 
- * modulo'd down to with the acceptable range of values. Have the calling 
- * function iterate/loop through values sequentually for the proper 
- * RGB-rainbow effect.
+ * @param   screen  (screen_t *) Output state to flush
  * 
- * @returns retval      (int32_t)    0 if Success; -1 if Failed.
+ * @returns N/A     (void)
+ */
+static void
+flush_screen (screen_t *screen)
+{
+    if (NULL != screen->fade)
+    {
+        // age what is on screen; emitted only once warm-up is over
+        TRACE_BEGIN("fade");
+        fade_step(screen->fade, screen->grid,
+                  (0 < screen->warm) ? NULL : screen->render);
+        TRACE_END("fade");
+    }
+
+    if (0 < screen->warm)
+    {
+        if (0 < --screen->warm)
+        {
+            return; // nothing is shown until warm-up is over
+        }
+
+        // the accumulated screen, in one emission
+        frame_reset(screen->frame);
+        if (screen->b_dump)
+        {
+            grid_encode_lines(screen->grid, screen->frame, screen->b_color);
+            frame_write(screen->frame, STDOUT_FILENO);
+            frame_reset(screen->frame);
+            gb_SIGINT_BOOL = 0;
+            return;
+        }
+        TRACE_BEGIN("encode");
+        render_keyframe(screen->render, screen->grid, screen->frame);
+        TRACE_END("encode");
+    }
+    else
+    {
+        TRACE_BEGIN("encode");
+        render_end_frame(screen->render);
+        TRACE_END("encode");
+    }
+
+    if (NULL != screen->palette)
+    {
+        cycle_palette(screen);
+    }
+
+    TRACE_BEGIN("write");
+    if (NULL == screen->raster)
+    {
+        frame_write(screen->frame, STDOUT_FILENO);
+        if ((0 < screen->steps) && (0 == --screen->steps))
+        {
+            gb_SIGINT_BOOL = 0; // as many steps as --warm N --dump-grid shows
+        }
+    }
+    else if ((0 != screen->frames) && (0 < grid_dirty_rows(screen->grid)))
+    {
+        raster_draw(screen->raster, screen->grid);
+        if ((RETVAL_SUCCESS != raster_write(screen->raster, STDOUT_FILENO,
+                                            screen->fmt))
+            || (0 == --screen->frames))
+        {
+            gb_SIGINT_BOOL = 0; // reader went away, or the last frame is out
+        }
+    }
+    TRACE_END("write");
+
+    TRACE_BEGIN("publish");
+    if (NULL != screen->bcast)
+    {
+        bcast_publish(screen->bcast, screen->frame, encode_keyframe, screen);
+    }
+
+    // a terminal grown too tall, or out of memory: stop sharing, once
+    if ((NULL != screen->shm)
+        && (RETVAL_SUCCESS != shmgrid_publish(screen->shm, screen->grid)))
+    {
+        fprintf(stderr, "Shared grid stopped; -M is off\n");
+        shmgrid_destroy(&screen->shm);
+    }
+    TRACE_END("publish");
+    grid_dirty_reset(screen->grid);
+
+    if (frame_shared(screen->frame))
+    {
+        frame_t *fresh = frame_create(0);
+        if (NULL != fresh)
+        {
+            frame_unref(screen->frame);
+            screen->frame = fresh;
+        }
+    }
+    else
+    {
+        frame_reset(screen->frame);
+    }
+
+    // also re-binds the render after a keyframe went elsewhere
+    render_begin_frame(screen->render, screen->frame);
+}
+
+/**
+ * @brief bcast_key_f for the viewer socket: the whole screen as one keyframe.
+ * Only called from flush_screen between frames, which re-binds the render
+ * to the screen's frame afterwards.
+ *
+ * @param   frame   (frame_t *)  Frame to append to
+ * @param   screen  (void *)     screen_t PTR of the output state
+ *
+ * @returns retval  (int32_t)    0 if Success; -1 if Failed.
  */
 static int32_t
-print_char_c (vertex_t *vert, int32_t idx)
+encode_keyframe (frame_t *frame, void *screen)
 {
-    if (NULL == vert)
+    return render_keyframe(((screen_t *)screen)->render,
+                           ((screen_t *)screen)->grid, frame);
+}
+
+/** 
+ * @brief Draw the border around the Terminal Window.
+ * 
+ * @param   screen  (screen_t *) Output state whose grid gets the border
+ * 
+ * @returns N/A     (void)
+ */
+static void
+draw_border (screen_t *screen)
+{
+    int    i    = 0;
+    cell_t cell = { .attr = CELL_BOLD }; // bold
+
+    // top and bottom
+    for (i = 0; i < g_WINSIZE_x; ++i)
     {
-        return -1;
+        cell.glyph = (i == 0) ? TOPLEFT : (i == g_WINSIZE_x - 1) ? TOPRIGHT : HORIZ;
+        grid_set(screen->grid, i, 0, &cell);
+
+        cell.glyph = (i == 0) ? BOTLEFT : (i == g_WINSIZE_x - 1) ? BOTRIGHT : HORIZ;
+        grid_set(screen->grid, i, g_WINSIZE_y - 1, &cell);
     }
 
-    // move cursor to vertex row and col
-    wprintf(L"\033[%d;%dH", vert->y, vert->x);
+    // mid
+    cell.glyph = VERTI;
+    for (i = 1; i < g_WINSIZE_y - 1; ++i) // for row
+    {
+        grid_set(screen->grid, 0, i, &cell);
+        grid_set(screen->grid, g_WINSIZE_x - 1, i, &cell);
+    }
+}
 
+/**
+ * @brief Color of rainbow step IDX.
+ *
+ * @param   idx         (int32_t)    Index INT for correct iterative stepping
+ * through RGB Values.
+ *
+ * @note    Only 1024 possible RGB values; any given index will be
+ * modulo'd down to with the acceptable range of values.
+ *
+ * @returns rgb         (uint32_t)   0xRRGGBB
+ */
+static uint32_t
+rainbow (int32_t idx)
+{
     int32_t red = 0;
     int32_t grn = 0;
     int32_t blu = 0;
@@ -696,51 +1646,654 @@ print_char_c (vertex_t *vert, int32_t idx)
         grn = 255;
     }
 
-    wprintf(L"\033[1m"); // bold
-    wprintf(L"\033[38;2;%d;%d;%dm", red, grn, blu);
-    wprintf(L"%lc", vert->c);
+    return ((uint32_t)red << 16) | ((uint32_t)grn << 8) | (uint32_t)blu;
+}
 
-    wprintf(L"\033[1D"); // move 1 left
-    wprintf(L"\033[0m"); // reset
-    fflush(stdout);
+/**
+ * @brief Turn the --cycle band one frame on: entry I shows the rainbow step
+ * it was drawn at, moved on by the phase. Costs the band's worth of bytes
+ * whatever is on screen.
+ *
+ * @param   screen      (screen_t *) Output state with the palette
+ *
+ * @returns N/A         (void)
+ */
+static void
+cycle_palette (screen_t *screen)
+{
+    uint32_t rgb[CYCLE_BAND];
 
-    return 0;
+    for (int32_t i = 0; i < CYCLE_BAND; ++i)
+    {
+        rgb[i] = rainbow((i * (MAX_COLOR_STEPS / CYCLE_BAND)) + screen->phase);
+    }
+    palette_set(screen->palette, screen->frame, rgb);
+    screen->phase = (screen->phase + CYCLE_SPEED) % MAX_COLOR_STEPS;
 }
 
 /**
- * @brief Print the associated character in non-color mode.
+ * @brief Print the associated character in 256 - RGB Color mode.
  *
+ * @param   screen      (screen_t *) Output state to draw into.
  * @param   vert        (vertex_t *) Vertex PTR of the associated vertex to
  * print.
+ * @param   idx         (int32_t)    Index INT for correct iterative stepping
+ * through RGB Values. 
+ * 
+ * @note    Only 1024 possible RGB values; any given index will be 
+ * modulo'd down to with the acceptable range of values. Have the calling 
+ * function iterate/loop through values sequentually for the proper 
+ * RGB-rainbow effect.
  * 
  * @returns retval      (int32_t)    0 if Success; -1 if Failed.
  */
 static int32_t
-print_char_w (vertex_t *vert)
+print_char_c (screen_t *screen, vertex_t *vert, int32_t idx)
+{
+    if (NULL == vert)
+    {
+        return -1;
+    }
+
+    uint32_t rgb  = rainbow(idx);
+    cell_t   cell = { .glyph = vert->c, .r = (uint8_t)(rgb >> 16),
+                      .g = (uint8_t)(rgb >> 8), .b = (uint8_t)rgb,
+                      .attr = CELL_BOLD | CELL_RGB };
+
+    return put_char(screen, vert, &cell);
+}
+
+/**
+ * @brief Print the associated character in palette-cycling mode: in the
+ * --cycle band entry for its rainbow step, so its color moves with the band.
+ *
+ * @param   screen      (screen_t *) Output state to draw into.
+ * @param   vert        (vertex_t *) Vertex PTR of the associated vertex to
+ * print.
+ * @param   idx         (int32_t)    Rainbow step, as for print_char_c.
+ *
+ * @returns retval      (int32_t)    0 if Success; -1 if Failed.
+ */
+static int32_t
+print_char_p (screen_t *screen, vertex_t *vert, int32_t idx)
+{
+    if (NULL == vert)
+    {
+        return -1;
+    }
+
+    int32_t entry = (idx % MAX_COLOR_STEPS) / (MAX_COLOR_STEPS / CYCLE_BAND);
+    cell_t  cell  = { .glyph = vert->c, .r = (uint8_t)(CYCLE_FIRST + entry),
+                      .attr = CELL_BOLD | CELL_PAL };
+
+    return put_char(screen, vert, &cell);
+}
+
+/**
+ * @brief Print the associated character in non-color mode (bold, in the
+ * terminal's own foreground color).
+ *
+ * @param   screen      (screen_t *) Output state to draw into.
+ * @param   vert        (vertex_t *) Vertex PTR of the associated vertex to
+ * print.
+ * @param   idx         (int32_t)    Unused; matches print_char_f.
+ *
+ * @returns retval      (int32_t)    0 if Success; -1 if Failed.
+ */
+static int32_t
+print_char_w (screen_t *screen, vertex_t *vert, int32_t idx)
 {
+    (void)idx;
     if (NULL == vert)
     {
         return -1;
     }
 
-    // move cursor to vertex row and col
-    wprintf(L"\033[%d;%dH", vert->y, vert->x);
+    cell_t cell = { .glyph = vert->c, .attr = CELL_BOLD };
 
-    int32_t red = 255;
-    int32_t blu = 255;
-    int32_t grn = 255;
+    return put_char(screen, vert, &cell);
+}
+
+/**
+ * @brief Store CELL at the vertex (1-based) in the grid and draw it, unless
+ * warming up.
+ *
+ * @param   screen      (screen_t *)     Output state to draw into.
+ * @param   vert        (vertex_t *)     Vertex PTR of the associated vertex.
+ * @param   cell        (const cell_t *) Glyph and style to draw.
+ *
+ * @returns retval      (int32_t)        0 if Success; -1 if Failed.
+ */
+static int32_t
+put_char (screen_t *screen, vertex_t *vert, const cell_t *cell)
+{
+    int32_t       x    = vert->x - 1;
+    int32_t       y    = vert->y - 1;
+    const cell_t *prev = grid_get(screen->grid, x, y);
+
+    if (NULL == prev)
+    {
+        return -1;
+    }
 
-    wprintf(L"\033[1m"); // bold
-    wprintf(L"\033[38;2;%d;%d;%dm", red, grn, blu);
-    wprintf(L"%lc", vert->c);
+    // only newly covered cells add to the density; crossings don't
+    if (0 == prev->glyph)
+    {
+        density_add(screen->density, x, y);
+    }
+    grid_set(screen->grid, x, y, cell);
+    fade_touch(screen->fade, screen->grid, x, y);
+    bitboard_set(screen->board, x, y);
 
-    wprintf(L"\033[1D"); // move 1 left
-    wprintf(L"\033[0m"); // reset
-    fflush(stdout);
+    if (0 < screen->warm)
+    {
+        return 0; // warming up: the grid is all that is kept
+    }
+    TRACE_BEGIN("encode");
+    render_put_cell(screen->render, x, y, cell);
+    TRACE_END("encode");
 
     return 0;
 }
 
+/**
+ * @brief Pick one of the 4 CHOICES for the segment at CURR, entered heading
+ * the way PREV points. Uniform unless steering: filling (--fill) weights
+ * each choice by the free space it heads into, and looking ahead
+ * (--lookahead) by the square of the open cells reachable past it, so walls,
+ * the pipe itself and pockets it would seal are avoided. Turn weights
+ * (--turns, --personalities, --walls) scale either; alone, they are drawn
+ * from the alias tables.
+ *
+ * @param   screen      (screen_t *)      Output state with the maps.
+ * @param   curr        (const vertex_t *) Vertex PTR of the new segment.
+ * @param   prev        (const vertex_t *) Vertex PTR of the one before it.
+ * @param   choices     (const wchar_t *)  Candidate glyphs (4).
+ *
+ * @returns index       (int32_t)         Index into CHOICES.
+ */
+static int32_t
+roll_choice (screen_t *screen, const vertex_t *curr, const vertex_t *prev,
+             const wchar_t *choices)
+{
+    if ((NULL == screen->density) && (NULL == screen->board))
+    {
+        return (NULL == screen->turns) ? (rand() % 4)
+                                       : roll_turn(screen, curr, prev, choices);
+    }
+
+    const uint32_t *turn_w = screen->turn_w[screen->persona];
+
+    int32_t  x         = curr->x - 1;
+    int32_t  y         = curr->y - 1;
+    uint64_t weight[4] = { 0 };
+    uint64_t total     = 0;
+
+    // CURR is about to be drawn; don't count it as room
+    bitboard_set(screen->board, x, y);
+
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        if ((0 < i) && (choices[i] == choices[i - 1]))
+        {
+            weight[i] = weight[i - 1]; // straight is listed twice
+            total    += weight[i];
+            continue;
+        }
+
+        int32_t dir_x = prev->dir_x;
+        int32_t dir_y = prev->dir_y;
+        glyph_exit(choices[i], &dir_x, &dir_y);
+
+        weight[i] = 1;
+        if (NULL != screen->density)
+        {
+            // nearby room dominates; the far side breaks ties once it's full
+            uint64_t room = (uint64_t)density_free(screen->density, x, y,
+                                                   dir_x, dir_y)
+                            + 1;
+            uint64_t side = (uint64_t)density_side(screen->density, x, y,
+                                                   dir_x, dir_y);
+            weight[i]     = (room * room) + side;
+        }
+
+        if (NULL != screen->board)
+        {
+            uint64_t reach = (uint64_t)bitboard_reach(screen->board,
+                                                      x + dir_x, y + dir_y,
+                                                      screen->look);
+            weight[i] *= reach * reach;
+        }
+
+        if (NULL != screen->turns)
+        {
+            // straight is listed twice, so the turns count double
+            bool b_left = (dir_x == prev->dir_y) && (dir_y == -prev->dir_x);
+            weight[i] *= (i < 2) ? turn_w[TURN_STRAIGHT]
+                                 : (2 * turn_w[b_left ? TURN_LEFT : TURN_RIGHT]);
+            if (screen->b_walls)
+            {
+                // as the tables weigh it: 1 at the wall, doubling per level
+                weight[i] <<= wall_level(curr, dir_x, dir_y);
+            }
+        }
+        total += weight[i];
+    }
+
+    if (0 == total)
+    {
+        return rand() % 4; // boxed in: every way is taken
+    }
+
+    uint64_t roll = ((((uint64_t)rand() << 31) | (uint64_t)rand()) % total);
+    int32_t  idx  = 0;
+    while ((idx < 3) && (roll >= weight[idx]))
+    {
+        roll -= weight[idx++];
+    }
+
+    return idx;
+}
+
+/**
+ * @brief Set up the turn tables: per personality (--personalities) the
+ * WEIGHTS scaled by its temper, and with --walls one table for every mix of
+ * room ahead, to the left and to the right, each heading weighed down the
+ * nearer its wall. Built once, so a turn is one draw and one lookup.
+ *
+ * @param   screen      (screen_t *)      Output state to hold the tables.
+ * @param   weights     (const uint32_t *) Straight, left, right (TURN_KINDS).
+ *
+ * @returns retval      (int32_t)         0 if Success; -1 if Failed.
+ */
+static int32_t
+build_turns (screen_t *screen, const uint32_t *weights)
+{
+    int32_t personas = screen->b_persona ? PERSONAS : 1;
+    int32_t levels   = screen->b_walls ? WALL_LEVELS : 1;
+    int32_t per      = levels * levels * levels;
+
+    screen->turns = alias_create(personas * per, TURN_KINDS);
+    if (NULL == screen->turns)
+    {
+        return RETVAL_FAILURE;
+    }
+
+    for (int32_t p = 0; p < personas; ++p)
+    {
+        for (int32_t k = 0; k < TURN_KINDS; ++k)
+        {
+            screen->turn_w[p][k] = weights[k] * g_personas[p][k];
+        }
+
+        // table (P * LEVELS^3) + (AHEAD * LEVELS^2) + (LEFT * LEVELS) + RIGHT
+        for (int32_t t = 0; t < per; ++t)
+        {
+            int32_t level[TURN_KINDS] = { t / (levels * levels),
+                                          (t / levels) % levels,
+                                          t % levels };
+            double  w[TURN_KINDS]     = { 0 };
+            for (int32_t k = 0; k < TURN_KINDS; ++k)
+            {
+                // 1 at the wall, doubling per level out to 16
+                w[k] = (double)screen->turn_w[p][k]
+                       * (double)(1 << (level[k] + WALL_LEVELS - levels));
+            }
+
+            if (RETVAL_SUCCESS
+                != alias_build(screen->turns, (p * per) + t, w))
+            {
+                return RETVAL_FAILURE;
+            }
+        }
+    }
+
+    return RETVAL_SUCCESS;
+}
+
+/**
+ * @brief Pick one of the 4 CHOICES for the segment at CURR from the turn
+ * tables: straight, left or right, then whichever of the two turn glyphs
+ * leads that way.
+ *
+ * @param   screen      (screen_t *)      Output state with the tables.
+ * @param   curr        (const vertex_t *) Vertex PTR of the new segment.
+ * @param   prev        (const vertex_t *) Vertex PTR of the one before it.
+ * @param   choices     (const wchar_t *)  Candidate glyphs (4); the first two
+ *                                        go straight on.
+ *
+ * @returns index       (int32_t)         Index into CHOICES.
+ */
+static int32_t
+roll_turn (screen_t *screen, const vertex_t *curr, const vertex_t *prev,
+           const wchar_t *choices)
+{
+    // left of a heading is (DIR_Y, -DIR_X): y grows down the screen
+    int32_t dir_x = prev->dir_x;
+    int32_t dir_y = prev->dir_y;
+    int32_t table = screen->persona;
+
+    if (screen->b_walls)
+    {
+        table = (table * WALL_LEVELS) + wall_level(curr, dir_x, dir_y);
+        table = (table * WALL_LEVELS) + wall_level(curr, dir_y, -dir_x);
+        table = (table * WALL_LEVELS) + wall_level(curr, -dir_y, dir_x);
+    }
+
+    int32_t kind = alias_draw(screen->turns, table, (uint32_t)rand());
+    if (TURN_STRAIGHT == kind)
+    {
+        return 0;
+    }
+
+    glyph_exit(choices[2], &dir_x, &dir_y);
+    bool b_left = (dir_x == prev->dir_y) && (dir_y == -prev->dir_x);
+
+    return ((TURN_LEFT == kind) == b_left) ? 2 : 3;
+}
+
+/**
+ * @brief How much room VERT has heading DIR_X, DIR_Y before check_bounds
+ * stops it, as a level: 0, 1, 2-3, 4-7 or 8+ cells.
+ *
+ * @param   vert        (const vertex_t *) Vertex PTR to measure from.
+ * @param   dir_x       (int32_t)         Heading, -1 to 1.
+ * @param   dir_y       (int32_t)         Heading, -1 to 1.
+ *
+ * @returns level       (int32_t)         0 to WALL_LEVELS - 1.
+ */
+static int32_t
+wall_level (const vertex_t *vert, int32_t dir_x, int32_t dir_y)
+{
+    int32_t room = (1 == dir_x)    ? (g_WINSIZE_x - 1) - vert->x
+                   : (-1 == dir_x) ? vert->x - 2
+                   : (1 == dir_y)  ? (g_WINSIZE_y - 2) - vert->y
+                                   : vert->y - 2;
+    int32_t level = 0;
+
+    while ((0 < room) && (level < WALL_LEVELS - 1))
+    {
+        room >>= 1;
+        level++;
+    }
+
+    return level;
+}
+
+/**
+ * @brief Turn DIR_X, DIR_Y (the heading into glyph C) into the heading out
+ * of it, from the two sides the glyph connects.
+ *
+ * @param   c           (wchar_t)    Pipe glyph.
+ * @param   dir_x       (int32_t *)  IN/OUT: x direction.
+ * @param   dir_y       (int32_t *)  IN/OUT: y direction.
+ *
+ * @returns N/A         (void)
+ */
+static void
+glyph_exit (wchar_t c, int32_t *dir_x, int32_t *dir_y)
+{
+    enum { LEFT = 1, RIGHT = 2, UP = 4, DOWN = 8 };
+
+    int32_t arms = 0;
+    switch (c)
+    {
+        case HORIZ:
+            arms = LEFT | RIGHT;
+            break;
+
+        case VERTI:
+            arms = UP | DOWN;
+            break;
+
+        case TOPLEFT:
+            arms = RIGHT | DOWN;
+            break;
+
+        case TOPRIGHT:
+            arms = LEFT | DOWN;
+            break;
+
+        case BOTLEFT:
+            arms = RIGHT | UP;
+            break;
+
+        case BOTRIGHT:
+            arms = LEFT | UP;
+            break;
+
+        default:
+            return;
+    }
+
+    // entered from the side opposite the heading
+    int32_t entry = (1 == *dir_x)    ? LEFT
+                    : (-1 == *dir_x) ? RIGHT
+                    : (1 == *dir_y)  ? UP
+                                     : DOWN;
+    int32_t out   = arms & ~entry;
+
+    *dir_x = (out & LEFT) ? -1 : (out & RIGHT) ? 1 : 0;
+    *dir_y = (out & UP) ? -1 : (out & DOWN) ? 1 : 0;
+}
+
+/**
+ * @brief Restore the screen and the pipe from SNAP, if it was taken at this
+ * grid size with a pipe that can still move: cells, head, color step,
+ * personality and random() state. The fill and lookahead maps are rebuilt
+ * from the cells, and fading starts over for them. The blank keyframe
+ * resize_screen queued is replaced by one of the restored screen.
+ *
+ * @param   screen      (screen_t *)    Output state to restore into.
+ * @param   snap        (snap_t *)      Snapshot opened at start-up.
+ * @param   head        (vertex_t *)    OUT: the last segment drawn.
+ * @param   idx         (int32_t *)     OUT: color step of the next segment.
+ *
+ * @returns retval      (int32_t)       0 if Success; -1 if Failed (nothing
+ *                                      was changed).
+ */
+static int32_t
+resume_snapshot (screen_t *screen, snap_t *snap, vertex_t *head, int32_t *idx)
+{
+    static _Alignas(int32_t) char scratch[SNAP_RNG_BYTES]; // random() runs here while G_RNG is replaced
+
+    const snap_state_t *saved = snap_state(snap);
+    vertex_t            vert  = { .c     = (wchar_t)saved->head[0],
+                                  .x     = saved->head[1],
+                                  .y     = saved->head[2],
+                                  .dir_x = saved->head[3],
+                                  .dir_y = saved->head[4] };
+    snap_state_t        state = { 0 };
+
+    // a pipe at a wall was about to start over on a cleared screen anyway
+    if ((0 != check_bounds(&vert)) || (saved->idx >= UINT16_MAX * 2)
+        || (RETVAL_SUCCESS != snap_restore(snap, screen->grid, &state)))
+    {
+        return RETVAL_FAILURE;
+    }
+
+    *head           = vert;
+    *idx            = (int32_t)state.idx;
+    screen->persona = (screen->b_persona && (0 <= state.persona)
+                       && (state.persona < PERSONAS))
+                          ? state.persona
+                          : 0;
+
+    // setstate() first saves the live position into the live buffer
+    initstate(1, scratch, sizeof(scratch));
+    memcpy(g_rng, state.rng, sizeof(g_rng));
+    setstate(g_rng);
+
+    for (int32_t y = 1; y < g_WINSIZE_y - 1; ++y)
+    {
+        for (int32_t x = 1; x < g_WINSIZE_x - 1; ++x)
+        {
+            if (0 == grid_get(screen->grid, x, y)->glyph)
+            {
+                continue;
+            }
+            if (NULL != screen->density)
+            {
+                density_add(screen->density, x, y);
+            }
+            if (NULL != screen->board)
+            {
+                bitboard_set(screen->board, x, y);
+            }
+            if (NULL != screen->fade)
+            {
+                fade_touch(screen->fade, screen->grid, x, y);
+            }
+        }
+    }
+
+    if (0 == screen->warm)
+    {
+        frame_reset(screen->frame);
+        render_begin_frame(screen->render, screen->frame);
+        render_keyframe(screen->render, screen->grid, screen->frame);
+    }
+
+    return RETVAL_SUCCESS;
+}
+
+/**
+ * @brief Save the screen and the pipe to --snapshot FILE: cells, HEAD (the
+ * last segment drawn), IDX (the color step of the next one), personality
+ * and random() state. Schedules the next periodic snapshot.
+ *
+ * @param   screen      (screen_t *)       Output state to save.
+ * @param   head        (const vertex_t *) Vertex PTR of the last segment.
+ * @param   idx         (int32_t)          Color step of the next segment.
+ *
+ * @returns N/A         (void)
+ */
+static void
+save_snapshot (screen_t *screen, const vertex_t *head, int32_t idx)
+{
+    snap_state_t state = { .idx     = (uint32_t)idx,
+                           .persona = screen->persona,
+                           .head    = { (int32_t)head->c, head->x, head->y,
+                                        head->dir_x, head->dir_y } };
+
+    setstate(g_rng); // writes the live position into G_RNG
+    memcpy(state.rng, g_rng, sizeof(state.rng));
+
+    snap_save(screen->snap_path, screen->grid, &state);
+    screen->snap_next = time(NULL) + screen->snap_every;
+}
+
+/**
+ * @brief Run --3d: grow cycles of pipes through a lattice the shape of the
+ * window, each seen from a new angle, a step a frame at 30fps (unpaced with
+ * --steps). A finished cycle stays up for 5 seconds, as in 2D.
+ *
+ * @param   screen  (screen_t *) Output state with the lattice and scene
+ *
+ * @returns N/A     (void)
+ */
+static void
+grow_3d (screen_t *screen)
+{
+    query_size(screen);
+    scene_resize(screen->scene, g_WINSIZE_x, g_WINSIZE_y);
+
+    while (gb_SIGINT_BOOL)
+    {
+        float  lo[3];
+        float  hi[3];
+        size_t first = 0;
+
+        TRACE_MARK("cycle");
+        lattice_fit(screen->lattice, g_WINSIZE_x, g_WINSIZE_y * 2);
+        lattice_bounds(screen->lattice, lo, hi);
+
+        // turned either way, never flat on; looking down a little
+        float yaw   = VIEW_YAW + (VIEW_TURN * (float)(rand() % 101) / 100.0f);
+        float pitch = VIEW_PITCH + (VIEW_TILT * (float)(rand() % 101) / 100.0f);
+        yaw         = (rand() % 2) ? yaw : -yaw;
+        scene_camera(screen->scene, yaw, pitch, lo, hi);
+
+        while (gb_SIGINT_BOOL)
+        {
+            struct timespec t_start;
+            struct timespec t_end;
+            clock_gettime(CLOCK_MONOTONIC, &t_start);
+
+            TRACE_BEGIN("simulate");
+            int32_t grown = lattice_step(screen->lattice, &first);
+            TRACE_END("simulate");
+            if (RETVAL_SUCCESS != grown)
+            {
+                TRACE_MARK("restart");
+                break; // enough pipes, or no room for more
+            }
+            show_3d(screen, first);
+
+            if (0 <= screen->steps)
+            {
+                continue; // timed: as fast as steps can go
+            }
+
+            clock_gettime(CLOCK_MONOTONIC, &t_end);
+            int64_t spent = ((int64_t)(t_end.tv_sec - t_start.tv_sec)
+                             * MILLIS_PER_SEC)
+                            + ((t_end.tv_nsec - t_start.tv_nsec) / 1000);
+            TRACE_BEGIN("sleep");
+            if (spent < FRAME_3D)
+            {
+                usleep((useconds_t)(FRAME_3D - spent));
+            }
+            TRACE_END("sleep");
+        }
+
+        // 5 Seconds; still redrawn if the window changes size
+        for (int32_t tick = 0;
+             gb_SIGINT_BOOL && (0 > screen->steps)
+             && (tick < (5 * MILLIS_PER_SEC / MILLIS_PER_TICK));
+             ++tick)
+        {
+            size_t count = 0;
+            (void)lattice_pieces(screen->lattice, &count);
+            show_3d(screen, count);
+            TRACE_BEGIN("sleep");
+            usleep(MILLIS_PER_TICK);
+            TRACE_END("sleep");
+        }
+    }
+}
+
+/**
+ * @brief Bring the 3D picture up to date (pieces from FIRST on are new or
+ * changed; all of them after a resize, which keeps the pipes) and send the
+ * cells that changed.
+ *
+ * @param   screen  (screen_t *) Output state with the lattice and scene
+ * @param   first   (size_t)     First piece new or changed
+ *
+ * @returns N/A     (void)
+ */
+static void
+show_3d (screen_t *screen, size_t first)
+{
+    size_t                 count  = 0;
+    const lattice_piece_t *pieces = lattice_pieces(screen->lattice, &count);
+
+    if (gb_SIGWINCH_BOOL)
+    {
+        TRACE_BEGIN("resize");
+        query_size(screen);
+        scene_resize(screen->scene, g_WINSIZE_x, g_WINSIZE_y);
+        TRACE_END("resize");
+    }
+
+    scene_draw(screen->scene, pieces, count, first);
+    TRACE_BEGIN("encode");
+    scene_encode(screen->scene, screen->frame);
+    TRACE_END("encode");
+    flush_screen(screen);
+}
+
 /**
  * @brief Checkes whether the associated character vertex is within the bounds of
  * the Terminal Window.
@@ -779,20 +2332,40 @@ CHECK_BNDS_RET:
 /**
  * Print the current length of the pipe in a Debug string in the top left corner.
  * 
- * @param   path        (llist_t *)  LinkedList PTR of the associated pipe.
+ * @param   screen      (screen_t *) Output state to draw into.
+ * @param   path        (vec_t *)    Vector PTR of the associated pipe.
  * 
  * @retuns  N/A         (void)
  */
 static void
-debug_path_len (llist_t *path)
+debug_path_len (screen_t *screen, vec_t *path)
 {
     if (NULL == path) 
     {
         return;
     }
 
-    wprintf(L"\033[2;0H");
-    wprintf(L"%lc %5d", VERTI, ll_len(path));
+    frame_printf(screen->frame, "\033[2;0H");
+    frame_putwc(screen->frame, VERTI);
+    frame_printf(screen->frame, " %5d", (int32_t)vec_len(path));
+}
+
+/**
+ * @brief Attach this terminal as a viewer of a pipes server (-S) until either
+ * side quits, then restore the cursor.
+ * 
+ * @param   path        (const char *) Socket path of the server.
+ * 
+ * @retuns  retval      (int32_t)      0 if Success; -1 if Failed.
+ */
+static int32_t
+attach_viewer (const char *path)
+{
+    gb_SIGINT_BOOL  = 1;
+    int32_t ret_val = bcast_attach(path, &gb_SIGINT_BOOL);
+
+    // reset, show cursor
+    write(STDOUT_FILENO, "\033[0m\033[?25h", 10);
 
-    fflush(stdout);
+    return ret_val;
 }
\ No newline at end of file